@@ -86,4 +86,35 @@ public:
     void Clear();
 };
 
+/**
+ * RollingBloomFilter is a probabilistic "keep track of most recently inserted" set.
+ * Construct it with the number of items to keep track of, and a false-positive rate.
+ *
+ * contains(item) will always return true if item was one of the last N to 1.5*N
+ * insert()'ed ... but may also return true for items that were not inserted.
+ *
+ * Every entry takes a 2 bit generation number out of the bits of its hash functions,
+ * so the oldest third of the entries can be forgotten in one pass over the data
+ * instead of keeping them in a set and a queue.
+ */
+class CRollingBloomFilter {
+public:
+    CRollingBloomFilter(uint32_t nElements, double nFPRate);
+
+    void insert(const vector<uint8_t>& vKey);
+    void insert(const uint256& hash);
+    bool contains(const vector<uint8_t>& vKey) const;
+    bool contains(const uint256& hash) const;
+
+    void reset();
+
+private:
+    int32_t nEntriesPerGeneration;
+    int32_t nEntriesThisGeneration;
+    int32_t nGeneration;
+    vector<uint64_t> data;
+    uint32_t nTweak;
+    int32_t nHashFuncs;
+};
+
 #endif /* COIN_BLOOM_H */
@@ -0,0 +1,112 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COIN_LRUCACHE_H
+#define COIN_LRUCACHE_H
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <list>
+#include <map>
+
+/**
+ * STL-like map container that keeps the most recently used elements as long as
+ * their total cost stays within a budget. The cost of an element defaults to 1,
+ * so the budget is an element count unless the caller accounts e.g. bytes.
+ * Not thread safe.
+ */
+template <typename K, typename V>
+class lrucache {
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef size_t size_type;
+
+protected:
+    struct item_type {
+        K key;
+        V value;
+        size_type cost;
+    };
+    typedef typename std::list<item_type>::iterator iterator;
+
+    std::list<item_type> items;  // most recently used first
+    std::map<K, iterator> index;
+    size_type nCost;
+    size_type nMaxCost;
+
+public:
+    explicit lrucache(size_type nMaxCostIn) : nCost(0), nMaxCost(nMaxCostIn) { assert(nMaxCostIn > 0); }
+
+    size_type size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+    size_type cost() const { return nCost; }
+    size_type max_cost() const { return nMaxCost; }
+
+    /** Look up an element and mark it as most recently used, nullptr when absent. */
+    V* find(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return nullptr;
+        items.splice(items.begin(), items, it->second);
+        return &it->second->value;
+    }
+
+    bool count(const K& key) const { return index.count(key) > 0; }
+
+    /** Insert or replace an element, evicting least recently used ones beyond the budget.
+     *  An element costlier than the whole budget is not kept. */
+    void insert(const K& key, const V& value, size_type cost = 1) {
+        erase(key);
+        if (cost > nMaxCost)
+            return;
+
+        items.push_front(item_type{key, value, cost});
+        index.emplace(key, items.begin());
+        nCost += cost;
+        shrink(nMaxCost);
+    }
+
+    bool erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return false;
+        nCost -= it->second->cost;
+        items.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+
+    void clear() {
+        items.clear();
+        index.clear();
+        nCost = 0;
+    }
+
+    void max_cost(size_type nMaxCostIn) {
+        assert(nMaxCostIn > 0);
+        nMaxCost = nMaxCostIn;
+        shrink(nMaxCost);
+    }
+
+    /** Visit elements from most to least recently used without touching their order. */
+    template <typename Visitor>
+    void for_each(Visitor visitor) const {
+        for (const auto& item : items)
+            visitor(item.key, item.value);
+    }
+
+protected:
+    void shrink(size_type nTargetCost) {
+        while (nCost > nTargetCost && !items.empty()) {
+            const item_type& last = items.back();
+            nCost -= last.cost;
+            index.erase(last.key);
+            items.pop_back();
+        }
+    }
+};
+
+#endif  // COIN_LRUCACHE_H
@@ -1214,9 +1214,20 @@ public:
     }
 
     void GetAndClear(CSerializeData &data) {
-        data.insert(data.end(), begin(), end());
+        if (data.empty() && nReadPos == 0) {
+            // hand the buffer over instead of copying it
+            data.swap(vch);
+        } else {
+            data.insert(data.end(), begin(), end());
+        }
         clear();
     }
+
+    // Exchange the whole buffer, read part included, with data and start reading from the front
+    void Swap(CSerializeData &data) {
+        vch.swap(data);
+        nReadPos = 0;
+    }
 };
 
 
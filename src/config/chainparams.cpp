@@ -48,6 +48,7 @@ public:
         nFeatureForkHeight                 = IniCfg().GetFeatureForkHeight(MAIN_NET);
         nStableCoinGenesisHeight           = IniCfg().GetStableCoinGenesisHeight(MAIN_NET);
         nVer3ForkHeight                    = IniCfg().GetVer3ForkHeight(MAIN_NET);
+        nLuaBytecodeForkHeight             = IniCfg().GetLuaBytecodeForkHeight(MAIN_NET);
         assert(CreateGenesisBlockRewardTx(genesis.vptx, MAIN_NET));
         assert(CreateGenesisDelegateTx(genesis.vptx, MAIN_NET));
         genesis.SetPrevBlockHash(uint256());
@@ -120,6 +121,7 @@ public:
         nFeatureForkHeight       = IniCfg().GetFeatureForkHeight(TEST_NET);
         nStableCoinGenesisHeight = IniCfg().GetStableCoinGenesisHeight(TEST_NET);
         nVer3ForkHeight          = IniCfg().GetVer3ForkHeight(TEST_NET);
+        nLuaBytecodeForkHeight   = IniCfg().GetLuaBytecodeForkHeight(TEST_NET);
         // Modify the testnet genesis block so the timestamp is valid for a later start.
         genesis.SetTime(IniCfg().GetStartTimeInit(TEST_NET));
         genesis.SetNonce(IniCfg().GetGenesisBlockNonce(TEST_NET));
@@ -156,6 +158,8 @@ public:
 
         nVer3ForkHeight          = std::max<uint32_t>(nFeatureForkHeight + 1,
                                                 GetArg("-ver3forkheight", IniCfg().GetVer3ForkHeight(TEST_NET)));
+        nLuaBytecodeForkHeight   = std::max<uint32_t>(nVer3ForkHeight,
+                                                GetArg("-luabytecodeforkheight", IniCfg().GetLuaBytecodeForkHeight(TEST_NET)));
 
         fServer = true;
 
@@ -177,6 +181,7 @@ public:
         nFeatureForkHeight       = IniCfg().GetFeatureForkHeight(REGTEST_NET);
         nStableCoinGenesisHeight = IniCfg().GetStableCoinGenesisHeight(REGTEST_NET);
         nVer3ForkHeight          = IniCfg().GetVer3ForkHeight(REGTEST_NET);
+        nLuaBytecodeForkHeight   = IniCfg().GetLuaBytecodeForkHeight(REGTEST_NET);
         genesis.SetTime(IniCfg().GetStartTimeInit(REGTEST_NET));
         genesis.SetNonce(IniCfg().GetGenesisBlockNonce(REGTEST_NET));
         genesis.vptx.clear();
@@ -206,6 +211,8 @@ public:
 
         nVer3ForkHeight          = std::max<uint32_t>(nFeatureForkHeight + 1,
                                                 GetArg("-ver3forkheight", IniCfg().GetVer3ForkHeight(REGTEST_NET)));
+        nLuaBytecodeForkHeight   = std::max<uint32_t>(nVer3ForkHeight,
+                                                GetArg("-luabytecodeforkheight", IniCfg().GetLuaBytecodeForkHeight(REGTEST_NET)));
         fServer = true;
 
         return true;
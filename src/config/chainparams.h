@@ -174,6 +174,7 @@ public:
     uint32_t GetFeatureForkHeight() const { return nFeatureForkHeight; }
     uint32_t GetStableCoinGenesisHeight() const { return nStableCoinGenesisHeight; }
     uint32_t GetVer3ForkHeight() const { return nVer3ForkHeight; }
+    uint32_t GetLuaBytecodeForkHeight() const { return nLuaBytecodeForkHeight; }
     uint32_t GetContinuousCountBeforeFork() const { return nContinuousCountBeforeFork; }
     uint32_t GetContinuousCountAfterFork() const { return nContinuousCountAfterFork; }
     CRegID GetFcoinGenesisRegId() const { return CRegID(nStableCoinGenesisHeight, 1); }
@@ -227,6 +228,7 @@ protected:
     uint32_t nStableCoinGenesisHeight;
     uint32_t nFeatureForkHeight;
     uint32_t nVer3ForkHeight;
+    uint32_t nLuaBytecodeForkHeight;
     uint32_t nBlockIntervalPreStableCoinRelease;
     uint32_t nBlockIntervalStableCoinRelease;
     uint32_t nContinuousProduceForkHeight ;
@@ -90,6 +90,11 @@ uint32_t G_CONFIG_TABLE::GetVer3ForkHeight(const NET_TYPE type) const {
     return nVer3ForkHeight[type];
 }
 
+uint32_t G_CONFIG_TABLE::GetLuaBytecodeForkHeight(const NET_TYPE type) const {
+    assert(type >= 0 && type < 3);
+    return nLuaBytecodeForkHeight[type];
+}
+
 vector<uint32_t> G_CONFIG_TABLE::GetSeedNodeIP() const { return pnSeed; }
 
 uint8_t* G_CONFIG_TABLE::GetMagicNumber(const NET_TYPE type) const {
@@ -283,3 +288,9 @@ uint32_t G_CONFIG_TABLE::nVer3ForkHeight[3] {
     8000000,    // mainnet:
     2000000,    // testnet
     500};       // regtest
+
+// Block height to load lua contracts from cached bytecode, not scheduled on mainnet and testnet yet
+uint32_t G_CONFIG_TABLE::nLuaBytecodeForkHeight[3] {
+    0xFFFFFFFF, // mainnet
+    0xFFFFFFFF, // testnet
+    600};       // regtest
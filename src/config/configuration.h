@@ -51,6 +51,7 @@ public:
 	uint32_t GetFeatureForkHeight(const NET_TYPE type) const;
     uint32_t GetStableCoinGenesisHeight(const NET_TYPE type) const;
     uint32_t GetVer3ForkHeight(const NET_TYPE type) const;
+    uint32_t GetLuaBytecodeForkHeight(const NET_TYPE type) const;
     const vector<string> GetStableCoinGenesisTxid(const NET_TYPE type) const;
 
 private:
@@ -124,6 +125,9 @@ private:
     /* soft fork height for MAJOR_VER_R3 */
     static uint32_t nVer3ForkHeight[3];
 
+    /* soft fork height for lua burner version BURN_VER_R4 */
+    static uint32_t nLuaBytecodeForkHeight[3];
+
 };
 
 inline FeatureForkVersionEnum GetFeatureForkVersion(const int32_t currBlockHeight) {
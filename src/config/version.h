@@ -28,7 +28,7 @@ extern const std::string CLIENT_DATE;
 // network protocol versioning
 //
 
-static const int PROTOCOL_VERSION = 10001;
+static const int PROTOCOL_VERSION = 10003;
 
 // initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 10001;
@@ -36,6 +36,12 @@ static const int INIT_PROTO_VERSION = 10001;
 // disconnect from peers older than this proto version
 static const int MIN_PEER_PROTO_VERSION = 10001;
 
+// peers take compact blocks ("cmpctblock", "getblocktxn" and "blocktxn") starting with this version
+static const int COMPACT_BLOCKS_VERSION = 10002;
+
+// peers take batches of pbft messages ("confirmblks" and "finblocks") starting with this version
+static const int PBFT_BATCH_VERSION = 10003;
+
 // nTime field added to CAddress, starting with this version;
 // if possible, avoid requesting addresses nodes older than this
 //static const int CADDR_TIME_VERSION = 31402;
@@ -10,14 +10,62 @@
 #include <openssl/rand.h>
 #include "commons/base58.h"
 #include "commons/common.h"
+#include "commons/lrucache.h"
 #include "commons/random.h"
 #include "crypto/hash.h"
 #include "lax_der_parsing.h"
 #include "lax_der_privatekey_parsing.h"
 
+#include <mutex>
+
 static secp256k1_context *secp256k1_context_verify = nullptr;
 static secp256k1_context *secp256k1_context_sign   = nullptr;
 
+/** Max number of parsed public keys kept for signature verification */
+static const size_t MAX_PARSED_PUBKEY_CACHE_SIZE = 16384;
+static const size_t PARSED_PUBKEY_CACHE_SHARDS   = 16;
+
+/**
+ * LRU of public keys already parsed (i.e. decompressed) by secp256k1, keyed by the
+ * serialized key. Block producers, dex operators and price feeders sign over and
+ * over again, so their keys skip the parsing step on every verification. Sharded
+ * to keep parallel verifiers from contending on one lock.
+ */
+class CParsedPubKeyCache {
+private:
+    struct Shard {
+        std::mutex mtx;
+        lrucache<CPubKey, secp256k1_pubkey> cache;
+
+        Shard() : cache(MAX_PARSED_PUBKEY_CACHE_SIZE / PARSED_PUBKEY_CACHE_SHARDS) {}
+    };
+
+    Shard shards[PARSED_PUBKEY_CACHE_SHARDS];
+
+public:
+    bool Parse(const CPubKey &pubKey, secp256k1_pubkey &parsed) {
+        // the x coordinate is spread evenly enough to pick a shard
+        Shard &shard = shards[pubKey[1] % PARSED_PUBKEY_CACHE_SHARDS];
+        {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            const secp256k1_pubkey *pCached = shard.cache.find(pubKey);
+            if (pCached != nullptr) {
+                parsed = *pCached;
+                return true;
+            }
+        }
+
+        if (!secp256k1_ec_pubkey_parse(secp256k1_context_verify, &parsed, pubKey.begin(), pubKey.size()))
+            return false;
+
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.cache.insert(pubKey, parsed);
+        return true;
+    }
+};
+
+static CParsedPubKeyCache parsedPubKeyCache;
+
 // Check that the sig has a low R value and will be less than 71 bytes
 bool SigHasLowR(const secp256k1_ecdsa_signature *sig) {
     uint8_t compact_sig[64];
@@ -197,7 +245,7 @@ bool CPubKey::Verify(const uint256 &hash, const vector<uint8_t> &vchSig) const {
 
     secp256k1_pubkey pubkey;
     secp256k1_ecdsa_signature sig;
-    if (!secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkey, vch, size())) {
+    if (!parsedPubKeyCache.Parse(*this, pubkey)) {
         return false;
     }
     if (!ecdsa_signature_parse_der_lax(secp256k1_context_verify, &sig, vchSig.data(), vchSig.size())) {
@@ -233,8 +281,9 @@ bool CPubKey::RecoverCompact(const uint256 &hash, const vector<uint8_t> &vchSig)
 bool CPubKey::IsFullyValid() const {
     if (!IsValid()) return false;
 
+    // owner/miner keys validated on account lookups are the ones verified next
     secp256k1_pubkey pubkey;
-    return secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkey, vch, size());
+    return parsedPubKeyCache.Parse(*this, pubkey);
 }
 
 bool CPubKey::Decompress() {
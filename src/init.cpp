@@ -20,11 +20,13 @@
 #include "main.h"
 #include "miner/miner.h"
 #include "net.h"
+#include "p2p/socketevents.h"
 #include "persistence/blockdb.h"
 #include "persistence/accountdb.h"
 #include "persistence/txdb.h"
 #include "persistence/contractdb.h"
 #include "tx/tx.h"
+#include "tx/wasmcontracttx.h"
 #include "commons/util/util.h"
 #include "commons/util/time.h"
 #ifdef USE_UPNP
@@ -75,6 +77,9 @@ static std::unique_ptr<ECCVerifyHandle> globalVerifyHandle;
 #define MIN_CORE_FILEDESCRIPTORS 150
 #endif
 
+// Seconds between two periodic dumps of the memory pool into mempool.dat
+#define DUMP_MEMPOOL_INTERVAL 900
+
 // Used to pass flags to the Bind() function
 enum BindFlags {
     BF_NONE         = 0,
@@ -138,6 +143,9 @@ void Shutdown() {
     StopNode();
     UnregisterNodeSignals(GetNodeSignals());
 
+    if (SysCfg().GetBoolArg("-persistmempool", true))
+        DumpMempool();
+
     {
         LOCK(cs_main);
 
@@ -147,6 +155,7 @@ void Shutdown() {
         }
 
         if (pCdMan != nullptr) {
+            PublishChainSnapshot(nullptr);
             pCdMan->Flush();
             delete pCdMan;
             pCdMan = nullptr;
@@ -209,6 +218,7 @@ string HelpMessage() {
     strUsage += "  -datadir=<dir>         " + _("Specify data directory") + "\n";
     strUsage += "  -dbcache=<n>           " + strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), MIN_DB_CACHE, MAX_DB_CACHE, DEFAULT_DB_CACHE) + "\n";
     strUsage += "  -loadblock=<file>      " + _("Imports blocks from external blk000??.dat file") + " " + _("on startup") + "\n";
+    strUsage += "  -persistmempool        " + _("Whether to save the mempool on shutdown and load on restart (default: 1)") + "\n";
     strUsage += "  -pid=<file>            " + _("Specify pid file (default: coin.pid)") + "\n";
     strUsage += "  -reindex               " + _("Rebuild block chain index from current blk000??.dat files") + " " + _("on startup") + "\n";
     strUsage += "  -txindex               " + _("Maintain a full transaction index (default: 0)") + "\n";
@@ -230,6 +240,7 @@ string HelpMessage() {
     strUsage += "  -maxconnections=<n>    " + _("Maintain at most <n> connections to peers (default: 125)") + "\n";
     strUsage += "  -maxreceivebuffer=<n>  " + _("Maximum per-connection receive buffer, <n>*1000 bytes (default: 5000)") + "\n";
     strUsage += "  -maxsendbuffer=<n>     " + _("Maximum per-connection send buffer, <n>*1000 bytes (default: 1000)") + "\n";
+    strUsage += "  -msghandlerthreads=<n> " + strprintf(_("Number of threads to handle peer messages (default: %d, max: %d)"), DEFAULT_MESSAGE_HANDLER_THREADS, MAX_MESSAGE_HANDLER_THREADS) + "\n";
     strUsage += "  -onion=<ip:port>       " + _("Use separate SOCKS5 proxy to reach peers via Tor hidden services (default: -proxy)") + "\n";
     strUsage += "  -onlynet=<net>         " + _("Only connect to nodes in network <net> (IPv4, IPv6 or Tor)") + "\n";
     strUsage += "  -port=<port>           " + _("Listen for connections on <port> (default: 8333 or testnet: 18333)") + "\n";
@@ -279,7 +290,11 @@ string HelpMessage() {
     strUsage += "  -logtimestamps         " + _("Prepend debug output with timestamp (default: 1)") + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
         strUsage += "  -limitfreerelay=<n>    " + _("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default:15)") + "\n";
-        strUsage += "  -maxsigcachesize=<n>   " + _("Limit size of signature cache to <n> entries (default: 50000)") + "\n";
+        strUsage += "  -maxsigcachesize=<n>   " + strprintf(_("Limit size of signature cache to <n> megabytes (0 to %d, default: %d)"), MAX_MAX_SIG_CACHE_SIZE, DEFAULT_MAX_SIG_CACHE_SIZE) + "\n";
+        strUsage += "  -wasmmodulecachesize=<n> " + _("Limit memory of instantiated wasm contract modules to <n> megabytes (default: 64)") + "\n";
+        strUsage += "  -luabytecodecachesize=<n> " + _("Limit memory of compiled lua contract chunks to <n> megabytes (default: 16)") + "\n";
+        strUsage += "  -contractdatacachesize=<n> " + _("Keep up to <n> megabytes of frequently read contract data in memory, 0 to disable (default: 32)") + "\n";
+        strUsage += "  -blockservecachesize=<n> " + strprintf(_("Keep up to <n> megabytes of recently served blocks in their serialized form (default: %d)"), DEFAULT_BLOCK_SERVE_CACHE_SIZE) + "\n";
     }
     strUsage += "  -logprinttoconsole     " + _("Send trace/debug info to console instead of debug.log file") + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
@@ -304,6 +319,7 @@ string HelpMessage() {
     strUsage += "  -rpcport=<port>        " + _("Listen for JSON-RPC connections on <port> (default: 8332 or testnet: 18332)") + "\n";
     strUsage += "  -rpcallowip=<ip>       " + _("Allow JSON-RPC connections from specified IP address") + "\n";
     strUsage += "  -rpcthreads=<n>        " + _("Set the number of threads to service RPC calls (default: 4)") + "\n";
+    strUsage += "  -rpccachesize=<n>      " + strprintf(_("Limit memory of cached RPC responses to <n> megabytes, 0 to disable (default: %d)"), DEFAULT_RPC_CACHE_SIZE) + "\n";
 
     strUsage += "\n" + _("RPC SSL options: (see the Coin Wiki for SSL setup instructions)") + "\n";
     strUsage += "  -rpcssl                                  " + _("Use OpenSSL (https) for JSON-RPC connections") + "\n";
@@ -487,9 +503,17 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
 
     // Make sure enough file descriptors are available
-    int32_t nBind   = max((int32_t)SysCfg().IsArgCount("-bind"), 1);
     nMaxConnections = SysCfg().GetArg("-maxconnections", 125);
+#ifdef USE_EPOLL
+    // peer sockets are polled through epoll, so only the process fd limit applies
+    if (!GetSocketEvents().IsValid())
+        return InitError(strprintf(_("Unable to create the epoll set for the p2p sockets: %s"),
+                                   GetSocketEvents().GetError()));
+    nMaxConnections = max(nMaxConnections, 0);
+#else
+    int32_t nBind   = max((int32_t)SysCfg().IsArgCount("-bind"), 1);
     nMaxConnections = max(min(nMaxConnections, (int32_t)(FD_SETSIZE - nBind - MIN_CORE_FILEDESCRIPTORS)), 0);
+#endif
     int32_t nFD     = RaiseFileDescriptorLimit(nMaxConnections + MIN_CORE_FILEDESCRIPTORS);
     if (nFD < MIN_CORE_FILEDESCRIPTORS)
         return InitError(_("Not enough file descriptors available."));
@@ -500,6 +524,11 @@ bool AppInit(boost::thread_group &threadGroup) {
     SysCfg().SetBenchMark(SysCfg().GetBoolArg("-benchmark", false));
     mempool.SetSanityCheck(SysCfg().GetBoolArg("-checkmempool", RegTest()));
 
+    int64_t nSigCacheSize = SysCfg().GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE);
+    nSigCacheSize         = max(min(nSigCacheSize, MAX_MAX_SIG_CACHE_SIZE), (int64_t)0);
+    size_t nSigCacheBytes = signatureCache.Setup(nSigCacheSize << 20);
+    LogPrint(BCLog::INFO, "Using %.1fMiB for the signature cache\n", nSigCacheBytes * (1.0 / 1024 / 1024));
+
     setvbuf(stdout, nullptr, _IOLBF, 0);
 
     string strDataDir = GetDataDir().string();
@@ -823,6 +852,14 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
     LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
 
+    {
+        // let the rpc queries read the loaded chain without cs_main
+        LOCK(cs_main);
+        pCdMan->Flush();
+        PublishChainSnapshot(chainActive.Tip());
+        SetRPCCacheTip(chainActive.Tip());
+    }
+
     vector<boost::filesystem::path> vImportFiles;
     if (SysCfg().IsArgCount("-loadblock")) {
         vector<string> tmp = SysCfg().GetMultiArgs("-loadblock");
@@ -833,6 +870,13 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
     threadGroup.create_thread(boost::bind(&ThreadImport, vImportFiles));
 
+    if (SysCfg().GetBoolArg("-persistmempool", true)) {
+        threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "loadmempool", &ThreadLoadMempool));
+        threadGroup.create_thread(boost::bind(&LoopForever<void (*)()>, "dumpmempool", &DumpMempool, DUMP_MEMPOOL_INTERVAL * 1000));
+    }
+
+    threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "wasmcompile", &ThreadCompileWasmContracts));
+
 
     nStart = GetTimeMillis();
     {
@@ -849,6 +893,9 @@ bool AppInit(boost::thread_group &threadGroup) {
 
     RandAddSeedPerfmon();
 
+    rawBlockCache.SetMaxSize(
+        max<int64_t>(SysCfg().GetArg("-blockservecachesize", DEFAULT_BLOCK_SERVE_CACHE_SIZE), 1) << 20);
+
     StartNode(threadGroup);
 
     if (SysCfg().IsServer()) {
@@ -27,6 +27,7 @@
 #include "p2p/sendmessage.hpp"
 #include "chain/blockdelegates.h"
 #include "persistence/blockundo.h"
+#include "rpc/core/rpccache.h"
 #include "tx/txserializer.h"
 
 #include <sstream>
@@ -34,7 +35,11 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 using namespace json_spirit;
 using namespace std;
@@ -250,8 +255,117 @@ bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signatu
     return true;
 }
 
+/** Smaller batches are verified by the calling thread alone, waking the workers costs more */
+static const size_t VERIFY_SIGNATURES_INLINE_MAX = 16;
+
+/**
+ * Worker threads for VerifySignatures, started on first use and kept until shutdown. One batch
+ * is verified at a time: its checks are claimed through an atomic index by the workers and the
+ * calling thread, which waits for the workers before it returns.
+ */
+class CSignatureCheckQueue {
+public:
+    explicit CSignatureCheckQueue(size_t nWorkers) {
+        for (size_t i = 0; i < nWorkers; i++)
+            workers.emplace_back(&CSignatureCheckQueue::Loop, this);
+    }
+
+    ~CSignatureCheckQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fShutdown = true;
+        }
+        condWork.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // one byte per result, the threads can't share the words of a vector<bool>
+    void Verify(const vector<SignatureCheck> &checks, vector<uint8_t> &verified) {
+        std::lock_guard<std::mutex> control(csControl);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pChecks   = &checks;
+            pVerified = &verified;
+            nNext     = 0;
+            nBatchId++;
+        }
+        condWork.notify_all();
+
+        // the calling thread takes its share as well
+        Drain(checks, verified);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condDone.wait(lock, [this]() { return nActive == 0; });
+        pChecks   = nullptr;
+        pVerified = nullptr;
+    }
+
+private:
+    std::mutex csControl;  // held through a batch
+    std::mutex mutex;
+    std::condition_variable condWork;
+    std::condition_variable condDone;
+    vector<std::thread> workers;
+
+    const vector<SignatureCheck> *pChecks = nullptr;
+    vector<uint8_t> *pVerified            = nullptr;
+    std::atomic<size_t> nNext{0};
+    uint64_t nBatchId = 0;
+    size_t nActive    = 0;  // workers on the current batch
+    bool fShutdown    = false;
+
+    void Drain(const vector<SignatureCheck> &checks, vector<uint8_t> &verified) {
+        for (size_t k = nNext++; k < checks.size(); k = nNext++)
+            verified[k] = VerifySignature(std::get<0>(checks[k]), *std::get<1>(checks[k]), std::get<2>(checks[k]));
+    }
+
+    void Loop() {
+        uint64_t nSeenBatchId = 0;
+        while (true) {
+            const vector<SignatureCheck> *pBatchChecks;
+            vector<uint8_t> *pBatchVerified;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condWork.wait(lock, [&]() { return fShutdown || nBatchId != nSeenBatchId; });
+                if (fShutdown)
+                    return;
+
+                // a batch that is over already leaves nothing to do
+                nSeenBatchId   = nBatchId;
+                pBatchChecks   = pChecks;
+                pBatchVerified = pVerified;
+                if (pBatchChecks == nullptr)
+                    continue;
+                nActive++;
+            }
+
+            Drain(*pBatchChecks, *pBatchVerified);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--nActive == 0)
+                condDone.notify_all();
+        }
+    }
+};
+
+void VerifySignatures(const vector<SignatureCheck> &checks, vector<bool> &results) {
+    size_t nWorkers = std::max<size_t>(1, std::thread::hardware_concurrency()) - 1;
+    if (checks.size() <= VERIFY_SIGNATURES_INLINE_MAX || nWorkers == 0) {
+        results.resize(checks.size());
+        for (size_t k = 0; k < checks.size(); k++)
+            results[k] = VerifySignature(std::get<0>(checks[k]), *std::get<1>(checks[k]), std::get<2>(checks[k]));
+        return;
+    }
+
+    static CSignatureCheckQueue signatureCheckQueue(nWorkers);
+    vector<uint8_t> verified(checks.size(), false);
+    signatureCheckQueue.Verify(checks, verified);
+    results.assign(verified.begin(), verified.end());
+}
+
 bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee) {
+                        bool fLimitFree, bool fRejectInsaneFee, int64_t entryTime, uint32_t entryHeight) {
     AssertLockHeld(cs_main);
 
     // is it already in the memory pool?
@@ -283,7 +397,8 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
     if (!pBaseTx->CheckTx(context))
         return ERRORMSG("AcceptToMemoryPool() : CheckTx failed, txid: %s", hash.GetHex());
 
-    CTxMemPoolEntry entry(pBaseTx, GetTime(), chainActive.Height());
+    CTxMemPoolEntry entry(pBaseTx, entryTime > 0 ? entryTime : GetTime(),
+                          entryHeight > 0 ? entryHeight : chainActive.Height());
     auto nFees = std::get<1>(entry.GetFees());
     auto nSize = entry.GetTxSize();
     // Continuously rate-limit free transactions
@@ -1296,8 +1411,61 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
     return true;
 }
 
-// Update the on-disk chain state.
-bool static WriteChainState(CValidationState &state) {
+static CCriticalSection cs_chainSnapshot;
+static std::shared_ptr<const CChainSnapshot> spChainSnapshot;
+// the tip the chain state has been written at since spChainSnapshot was taken, if any
+static const CBlockIndex *pPendingSnapshotTip = nullptr;
+
+std::shared_ptr<CCacheWrapper> CChainSnapshot::NewCacheWrapper() const {
+    return CCacheWrapper::NewReadOnlyCopyFrom(&cdMan);
+}
+
+std::shared_ptr<const CChainSnapshot> GetChainSnapshot() {
+    {
+        LOCK(cs_chainSnapshot);
+        if (pPendingSnapshotTip == nullptr)
+            return spChainSnapshot;
+    }
+
+    // The first reader after a write takes the snapshot. While cs_main is busy the previous
+    // one is served, and so it is when blocks were connected without writing the state since,
+    // the price point memory cache has moved on then.
+    {
+        TRY_LOCK(cs_main, lockMain);
+        if (lockMain) {
+            const CBlockIndex *pTip;
+            {
+                LOCK(cs_chainSnapshot);
+                pTip = pPendingSnapshotTip;
+            }
+            if (pTip != nullptr && pTip == chainActive.Tip())
+                PublishChainSnapshot(pTip);
+        }
+    }
+
+    LOCK(cs_chainSnapshot);
+    return spChainSnapshot;
+}
+
+void PublishChainSnapshot(const CBlockIndex *pTip) {
+    AssertLockHeld(cs_main);
+    std::shared_ptr<const CChainSnapshot> spSnapshot;
+    if (pTip != nullptr)
+        spSnapshot = std::make_shared<CChainSnapshot>(pTip, pCdMan);
+
+    LOCK(cs_chainSnapshot);
+    spChainSnapshot     = spSnapshot;
+    pPendingSnapshotTip = nullptr;
+}
+
+static void SetChainSnapshotPending(const CBlockIndex *pTip) {
+    AssertLockHeld(cs_main);
+    LOCK(cs_chainSnapshot);
+    pPendingSnapshotTip = pTip;
+}
+
+// Update the on-disk chain state, pNewTip is the tip it is the state of.
+bool static WriteChainState(CValidationState &state, const CBlockIndex *pNewTip) {
     static int64_t nLastWrite = 0;
     uint32_t cacheSize        =
         pCdMan->pSysParamCache->GetCacheSize() +
@@ -1327,6 +1495,7 @@ bool static WriteChainState(CValidationState &state) {
         pCdMan->Flush();
         mapForkCache.clear();
         nLastWrite = GetTimeMicros();
+        SetChainSnapshotPending(pNewTip);
     }
     return true;
 }
@@ -1334,6 +1503,7 @@ bool static WriteChainState(CValidationState &state) {
 // Update chainActive and related internal data structures.
 void static UpdateTip(CBlockIndex *pIndexNew, const CBlock &block) {
     chainActive.SetTip(pIndexNew);
+    SetRPCCacheTip(pIndexNew);
 
     SyncTransaction(uint256(), nullptr, &block);
 
@@ -1399,7 +1569,7 @@ bool static DisconnectTip(CValidationState &state) {
     if (SysCfg().IsBenchmark())
         LogPrint(BCLog::INFO, "- Disconnect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexDelete->pprev))
         return false;
     // Update chainActive and related variables.
     UpdateTip(pIndexDelete->pprev, block);
@@ -1453,7 +1623,7 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
         LogPrint(BCLog::INFO, "- Connect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
 
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexNew))
         return false;
 
     // Update chainActive & related variables.
@@ -2047,9 +2217,20 @@ bool AcceptBlock(CBlock &block, CValidationState &state, CDiskBlockPos *dbp, boo
     // Relay inventory, but don't relay old inventory during initial block download
     CBlockIndex* pTip = chainActive.Tip() ;
     if (pTip->GetBlockHash() == blockHash) {
+        netStats.BlockConnected(blockHash);
+
         {
+            CInv inv(MSG_BLOCK, blockHash);
+            std::unique_ptr<CBlockHeaderAndShortTxIDs> pCmpctBlock;
             LOCK(cs_vNodes);
             for (auto pNode : vNodes) {
+                // peers which rebuild it from their mempool get the block right away as a compact block
+                if (pNode->fCompactBlocks && (mining || chainActive.Height() > pNode->nStartingHeight - 2000)) {
+                    if (!pCmpctBlock)
+                        pCmpctBlock.reset(new CBlockHeaderAndShortTxIDs(block));
+                    pNode->PushInventoryData(inv, NetMsgType::CMPCTBLOCK, *pCmpctBlock);
+                    continue;
+                }
                 //p2p_xiaoyu_20191116
                 if (mining) {
                     pNode->PushMessage(NetMsgType::BLOCK, block);
@@ -17,6 +17,7 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <tuple>
 #include <vector>
 
 #include "commons/arith_uint256.h"
@@ -114,10 +115,16 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
 void Misbehaving(NodeId nodeid, int32_t howmuch);
 
 bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signature, const CPubKey &pubKey);
+/** A signature to check: the signed hash, the signature and the key it should verify with */
+typedef std::tuple<uint256, const std::vector<uint8_t> *, CPubKey> SignatureCheck;
+/** Verify a batch of signatures on a pool of threads kept for it, small batches on the calling thread;
+ *  results[i] is the result of checks[i] */
+void VerifySignatures(const std::vector<SignatureCheck> &checks, std::vector<bool> &results);
 
-/** (try to) add transaction to memory pool **/
+/** (try to) add transaction to memory pool, entryTime/entryHeight restore a reloaded entry (0 = now) **/
 bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee = false);
+                        bool fLimitFree, bool fRejectInsaneFee = false, int64_t entryTime = 0,
+                        uint32_t entryHeight = 0);
 
 struct CNodeStateStats {
     int32_t nMisbehavior;
@@ -198,6 +205,38 @@ extern string externalIp;
 
 bool EraseBlockIndexFromSet(CBlockIndex *pIndex);
 
+/**
+ * Immutable chain state as of a tip, for readers that don't take cs_main, e.g. the rpc
+ * queries. The dbs are read through leveldb snapshots of the state of the tip written to
+ * them. A new one is taken on the first read after the chain state is written, so it lags
+ * behind chainActive while those writes are batched in the initial download. The price
+ * points are copied once per snapshot and shared by its readers.
+ */
+class CChainSnapshot {
+public:
+    CChainSnapshot(const CBlockIndex *pTipIn, CCacheDBManager *pCdManIn) : pTip(pTipIn), cdMan(pCdManIn) {}
+
+    const CBlockIndex *Tip() const { return pTip; }
+    int32_t Height() const { return pTip ? pTip->height : -1; }
+    /** The block of the snapshot chain at that height, or nullptr */
+    const CBlockIndex *operator[](int32_t height) const {
+        return (pTip != nullptr && height >= 0 && height <= pTip->height) ? pTip->GetAncestor(height) : nullptr;
+    }
+    bool Contains(const CBlockIndex *pIndex) const { return pIndex != nullptr && (*this)[pIndex->height] == pIndex; }
+
+    /** Private caches on top of the snapshot, each reader needs its own since reads fill them */
+    std::shared_ptr<CCacheWrapper> NewCacheWrapper() const;
+
+private:
+    const CBlockIndex *pTip;
+    mutable CCacheDBManager cdMan;
+};
+
+/** The latest written chain state, nullptr before the chain is loaded */
+std::shared_ptr<const CChainSnapshot> GetChainSnapshot();
+/** Publish the chain state of pCdMan, which must be flushed, as of pTip; nullptr drops it */
+void PublishChainSnapshot(const CBlockIndex *pTip);
+
 class CWalletInterface {
 protected:
     virtual void SyncTransaction(const uint256 &hash, CBaseTx *pBaseTx, const CBlock *pBlock) = 0;
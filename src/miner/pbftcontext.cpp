@@ -7,22 +7,85 @@
 #include "pbftcontext.h"
 #include "p2p/protocol.h"
 
+#include <algorithm>
+
 CPBFTContext pbftContext ;
 
+bool CPBFTVotes::IndexBy(const PBFTDelegates& pDelegatesIn) {
+
+    if(pDelegatesIn == nullptr || pDelegatesIn == pDelegates)
+        return pDelegates != nullptr ;
+    if(pDelegates != nullptr && *pDelegates == *pDelegatesIn)
+        return true ;
+
+    // first list of delegates we get, or one that differs, count the votes anew
+    set<CRegID> voters ;
+    voters.swap(parked) ;
+    if(pDelegates != nullptr) {
+        for(size_t slot = 0; slot < voted.size(); slot++) {
+            if(voted[slot])
+                voters.insert((*pDelegates)[slot]);
+        }
+    }
+
+    pDelegates = pDelegatesIn ;
+    voted.assign(pDelegates->size(), false) ;
+    count = 0 ;
+    for(const auto& voter: voters)
+        Add(voter, pDelegates) ;
+    return true ;
+}
+
+uint32_t CPBFTVotes::Add(const CRegID& miner, const PBFTDelegates& pDelegatesIn) {
+
+    if(!IndexBy(pDelegatesIn)) {
+        parked.insert(miner) ;
+        return 0 ;
+    }
+
+    // votes of non-delegates don't count
+    auto it = std::lower_bound(pDelegates->begin(), pDelegates->end(), miner) ;
+    if(it == pDelegates->end() || *it != miner)
+        return count ;
+
+    size_t slot = it - pDelegates->begin() ;
+    if(!voted[slot]) {
+        voted[slot] = true ;
+        count++ ;
+    }
+    return count ;
+}
+
+uint32_t CPBFTVotes::Count(const PBFTDelegates& pDelegatesIn) {
+    return IndexBy(pDelegatesIn) ? count : 0 ;
+}
+
+PBFTDelegates CPBFTContext::GetDelegates(const uint256& blockHash) {
+
+    LOCK(cs_delegates);
+    PBFTDelegates* ppDelegates = blockDelegates.find(blockHash) ;
+    return ppDelegates == nullptr ? nullptr : *ppDelegates ;
+}
+
 bool CPBFTContext::GetMinerListByBlockHash(const uint256 blockHash, set<CRegID>& miners) {
 
-    auto it = blockMinerListMap.find(blockHash) ;
-    if(it == blockMinerListMap.end())
+    PBFTDelegates pDelegates = GetDelegates(blockHash) ;
+    if(pDelegates == nullptr)
         return false;
-    miners = it->second ;
+    miners = set<CRegID>(pDelegates->begin(), pDelegates->end()) ;
     return true ;
 }
 
 bool CPBFTContext::SaveMinersByHash(uint256 blockhash, VoteDelegateVector delegates) {
-    set<CRegID> miners ;
+    auto pMiners = std::make_shared<vector<CRegID>>() ;
+    pMiners->reserve(delegates.size());
     for(auto delegate: delegates){
-        miners.insert(delegate.regid);
+        pMiners->push_back(delegate.regid);
     }
-    blockMinerListMap.insert(std::make_pair(blockhash, miners));
+    std::sort(pMiners->begin(), pMiners->end());
+    pMiners->erase(std::unique(pMiners->begin(), pMiners->end()), pMiners->end());
+
+    LOCK(cs_delegates);
+    blockDelegates.insert(blockhash, pMiners);
     return true ;
-}
\ No newline at end of file
+}
@@ -8,10 +8,12 @@
 #define MINER_PBFTCONTEXT_H
 
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 #include "sync.h"
 #include "commons/uint256.h"
-#include "commons/limitedmap.h"
+#include "commons/lrucache.h"
 #include "commons/mruset.h"
 #include "entities/vote.h"
 
@@ -19,25 +21,46 @@ class CRegID ;
 class CBlockConfirmMessage ;
 class CBlockFinalityMessage;
 
+// the delegates active after a block, sorted so that a delegate's slot is its index
+typedef std::shared_ptr<const std::vector<CRegID>> PBFTDelegates;
+
+/**
+ * The votes of the delegates on one block, one bit per slot of the delegates active at the
+ * previous block, so recording a vote and checking the quorum take constant time. Votes which
+ * come in before the delegates are known are parked and counted once they are.
+ */
+class CPBFTVotes {
+
+private:
+    PBFTDelegates pDelegates ;
+    std::vector<bool> voted ;
+    uint32_t count = 0 ;
+    std::set<CRegID> parked ;
+
+    bool IndexBy(const PBFTDelegates& pDelegatesIn) ;
+
+public:
+    // returns the number of votes by delegates
+    uint32_t Add(const CRegID& miner, const PBFTDelegates& pDelegatesIn) ;
+    uint32_t Count(const PBFTDelegates& pDelegatesIn) ;
+};
 
 template <typename MsgType>
 class CPBFTMessageMan {
 
 private:
     CCriticalSection cs_pbftmessage;
-    limitedmap<uint256, set<MsgType>> blockMessagesMap ;
+    lrucache<uint256, CPBFTVotes> blockVotes ;
     mruset<uint256> broadcastedBlockHashSet ;
     mruset<MsgType> messageKnown ;
 
 public:
-    CPBFTMessageMan(){
-            blockMessagesMap.max_size(500) ;
+    CPBFTMessageMan(): blockVotes(500) {
             broadcastedBlockHashSet.max_size(500) ;
             messageKnown.max_size(500) ;
     }
 
-    CPBFTMessageMan(const int maxSize) {
-        blockMessagesMap.max_size(maxSize) ;
+    CPBFTMessageMan(const int maxSize): blockVotes(maxSize) {
         broadcastedBlockHashSet.max_size(maxSize) ;
         messageKnown.max_size(maxSize) ;
     }
@@ -45,63 +68,60 @@ public:
 public:
 
     bool IsBroadcastedBlock(uint256 blockHash) {
+        LOCK(cs_pbftmessage);
         return broadcastedBlockHashSet.count(blockHash) > 0;
     }
 
     bool SaveBroadcastedBlock(uint256 blockHash) {
+        LOCK(cs_pbftmessage);
         broadcastedBlockHashSet.insert(blockHash) ;
         return true ;
     }
-    bool IsKnown(const MsgType msg) {
+    bool IsKnown(const MsgType& msg) {
+        LOCK(cs_pbftmessage);
         return messageKnown.count(msg) != 0 ;
     }
 
-    bool AddMessageKnown(const MsgType msg) {
+    bool AddMessageKnown(const MsgType& msg) {
             LOCK(cs_pbftmessage);
             messageKnown.insert(msg) ;
             return true;
     }
 
-    int  SaveMessageByBlock(const uint256 blockHash,const MsgType& msg) {
-
+    // record the vote of msg.miner on msg.blockHash, returns the number of votes on the block
+    uint32_t SaveMessageByBlock(const MsgType& msg, const PBFTDelegates& pDelegates) {
             LOCK(cs_pbftmessage);
-            auto it = blockMessagesMap.find(blockHash) ;
-            if(it == blockMessagesMap.end()) {
-                    set<MsgType> messages ;
-                    messages.insert(msg) ;
-                    blockMessagesMap.insert(std::make_pair(blockHash, messages)) ;
-                    return  1 ;
-            } else {
-                    set<MsgType> v = blockMessagesMap[blockHash] ;
-                    v.insert(msg);
-                    blockMessagesMap.update(it, v);
-                    return v.size();
+            CPBFTVotes* pVotes = blockVotes.find(msg.blockHash) ;
+            if(pVotes == nullptr) {
+                blockVotes.insert(msg.blockHash, CPBFTVotes()) ;
+                pVotes = blockVotes.find(msg.blockHash) ;
             }
+            return pVotes->Add(msg.miner, pDelegates) ;
     }
 
-    bool GetMessagesByBlockHash(const uint256 hash, set<MsgType>& msgs) {
-            auto it = blockMessagesMap.find(hash) ;
-            if(it == blockMessagesMap.end())
-                return false;
-            msgs = it->second ;
-            return true ;
+    uint32_t GetVoteCount(const uint256& blockHash, const PBFTDelegates& pDelegates) {
+            LOCK(cs_pbftmessage);
+            CPBFTVotes* pVotes = blockVotes.find(blockHash) ;
+            return pVotes == nullptr ? 0 : pVotes->Count(pDelegates) ;
     }
 
 };
 
 class CPBFTContext {
 
+private:
+    CCriticalSection cs_delegates ;
+    lrucache<uint256, PBFTDelegates> blockDelegates ;
 
 public:
 
     CPBFTMessageMan<CBlockConfirmMessage> confirmMessageMan ;
     CPBFTMessageMan<CBlockFinalityMessage> finalityMessageMan ;
-    limitedmap<uint256, set<CRegID>> blockMinerListMap ;
 
-    CPBFTContext(){
-        blockMinerListMap.max_size(500) ;
+    CPBFTContext(): blockDelegates(500) {}
 
-    }
+    // the delegates active after the block, nullptr if not known
+    PBFTDelegates GetDelegates(const uint256& blockHash) ;
 
     bool GetMinerListByBlockHash(const uint256 blockHash, set<CRegID>& delegates) ;
 
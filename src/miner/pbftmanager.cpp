@@ -11,6 +11,8 @@
 #include "miner/miner.h"
 #include "wallet/wallet.h"
 
+#include <algorithm>
+
 CPBFTMan pbftMan;
 extern CPBFTContext pbftContext;
 extern CWallet *pWalletMain;
@@ -114,24 +116,9 @@ bool CPBFTMan::UpdateLocalFinBlock(const CBlockIndex* pIndex){
 
         CBlockIndex* pTemp = chainActive[height] ;
 
-        set<CBlockConfirmMessage> messageSet ;
-        set<CRegID> miners;
-
-        if(pbftContext.confirmMessageMan.GetMessagesByBlockHash(pTemp->GetBlockHash(), messageSet)
-           && pbftContext.GetMinerListByBlockHash(pTemp->pprev->GetBlockHash(),miners)){
-
-            if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                int count =0;
-                for(auto msg: messageSet){
-                    if(miners.count(msg.miner))
-                        count++ ;
-                    if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                        return UpdateLocalFinBlock( height) ;
-                    }
-                }
-            }
-
-        }
+        PBFTDelegates pDelegates = pbftContext.GetDelegates(pTemp->pprev->GetBlockHash()) ;
+        if(pbftContext.confirmMessageMan.GetVoteCount(pTemp->GetBlockHash(), pDelegates) >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+            return UpdateLocalFinBlock(height) ;
 
         height--;
 
@@ -153,23 +140,9 @@ bool CPBFTMan::UpdateLocalFinBlock(const CBlockConfirmMessage& msg){
     if(pIndex->GetBlockHash() != msg.blockHash)
         return false;
 
-    set<CBlockConfirmMessage> messageSet ;
-    set<CRegID> miners;
-
-    if(pbftContext.confirmMessageMan.GetMessagesByBlockHash(pIndex->GetBlockHash(), messageSet)
-       && pbftContext.GetMinerListByBlockHash(pIndex->pprev->GetBlockHash(),miners)) {
-        if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-            int count =0;
-            for(auto msg: messageSet){
-                if(miners.count(msg.miner))
-                    count++ ;
-                if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                    return UpdateLocalFinBlock(pIndex->height) ;
-                }
-            }
-        }
-
-    }
+    PBFTDelegates pDelegates = pbftContext.GetDelegates(pIndex->pprev->GetBlockHash()) ;
+    if(pbftContext.confirmMessageMan.GetVoteCount(pIndex->GetBlockHash(), pDelegates) >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+        return UpdateLocalFinBlock(pIndex->height) ;
     return false;
 }
 
@@ -183,24 +156,9 @@ bool CPBFTMan::UpdateGlobalFinBlock(const CBlockIndex* pIndex){
 
         CBlockIndex* pTemp = chainActive[height] ;
 
-        set<CBlockFinalityMessage> messageSet ;
-        set<CRegID> miners;
-
-        if(pbftContext.finalityMessageMan.GetMessagesByBlockHash(pTemp->GetBlockHash(), messageSet)
-           && pbftContext.GetMinerListByBlockHash(pTemp->pprev->GetBlockHash(),miners)){
-
-            if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                int count =0;
-                for(auto msg: messageSet){
-                    if(miners.count(msg.miner))
-                        count++ ;
-                    if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                        return UpdateGlobalFinBlock( height) ;
-                    }
-                }
-            }
-
-        }
+        PBFTDelegates pDelegates = pbftContext.GetDelegates(pTemp->pprev->GetBlockHash()) ;
+        if(pbftContext.finalityMessageMan.GetVoteCount(pTemp->GetBlockHash(), pDelegates) >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+            return UpdateGlobalFinBlock(height) ;
 
         height--;
 
@@ -227,23 +185,9 @@ bool CPBFTMan::UpdateGlobalFinBlock(const CBlockFinalityMessage& msg){
     if(pIndex->GetBlockHash() != msg.blockHash)
         return false;
 
-    set<CBlockFinalityMessage> messageSet ;
-    set<CRegID> miners;
-
-    if(pbftContext.finalityMessageMan.GetMessagesByBlockHash(pIndex->GetBlockHash(), messageSet)
-       && pbftContext.GetMinerListByBlockHash(pIndex->pprev->GetBlockHash(),miners)) {
-        if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-            int count =0;
-            for(auto msg: messageSet){
-                if(miners.count(msg.miner))
-                    count++ ;
-                if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                    return UpdateGlobalFinBlock(pIndex->height) ;
-                }
-            }
-        }
-
-    }
+    PBFTDelegates pDelegates = pbftContext.GetDelegates(pIndex->pprev->GetBlockHash()) ;
+    if(pbftContext.finalityMessageMan.GetVoteCount(pIndex->GetBlockHash(), pDelegates) >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+        return UpdateGlobalFinBlock(pIndex->height) ;
     return false;
 }
 
@@ -284,43 +228,36 @@ bool BroadcastBlockFinality(const CBlockIndex* block){
         return true ;
 
     //查找上一个区块执行过后的矿工列表
-    set<CRegID> delegates;
-
     if(block->pprev == nullptr)
         return false ;
-    pbftContext.GetMinerListByBlockHash(block->pprev->GetBlockHash(), delegates);
+    PBFTDelegates pDelegates = pbftContext.GetDelegates(block->pprev->GetBlockHash());
+    if(pDelegates == nullptr)
+        return false ;
 
-    uint256 preHash = block->pprev == nullptr? uint256(): block->pprev->GetBlockHash();
+    uint256 preHash = block->pprev->GetBlockHash();
 
 
     CBlockFinalityMessage msg(block->height, block->GetBlockHash(), preHash);
+    vector<CBlockFinalityMessage> msgs ;
 
-    {
-
-        for(auto delegate: delegates){
+    for(auto delegate: *pDelegates){
 
-            Miner miner ;
-            if(!PbftFindMiner(delegate, miner))
-                continue ;
-            msg.miner = miner.account.regid ;
-            vector<unsigned char > vSign ;
-            uint256 messageHash = msg.GetHash();
-
-            miner.key.Sign(messageHash, vSign);
-            msg.SetSignature(vSign);
-
-            {
-                LOCK(cs_vNodes);
-                for (auto pNode : vNodes) {
-                    pNode->PushBlockFinalityMessage(msg) ;
-                }
-            }
+        Miner miner ;
+        if(!PbftFindMiner(delegate, miner))
+            continue ;
+        msg.miner = miner.account.regid ;
+        vector<unsigned char > vSign ;
+        uint256 messageHash = msg.GetHash();
 
-            msgMan.SaveMessageByBlock(msg.blockHash, msg);
+        miner.key.Sign(messageHash, vSign);
+        msg.SetSignature(vSign);
 
-        }
+        msgMan.SaveMessageByBlock(msg, pDelegates);
+        msgs.push_back(msg);
     }
 
+    RelayBlockFinalityMessages(msgs);
+
     msgMan.SaveBroadcastedBlock(block->GetBlockHash());
     return true ;
 
@@ -343,39 +280,33 @@ bool BroadcastBlockConfirm(const CBlockIndex* block) {
         return true ;
 
     //查找上一个区块执行过后的矿工列表
-    set<CRegID> delegates;
-
     if(block->pprev == nullptr)
         return false ;
-    pbftContext.GetMinerListByBlockHash(block->pprev->GetBlockHash(), delegates);
+    PBFTDelegates pDelegates = pbftContext.GetDelegates(block->pprev->GetBlockHash());
+    if(pDelegates == nullptr)
+        return false ;
 
-    uint256 preHash = block->pprev == nullptr? uint256(): block->pprev->GetBlockHash();
+    uint256 preHash = block->pprev->GetBlockHash();
     CBlockConfirmMessage msg(block->height, block->GetBlockHash(), preHash);
+    vector<CBlockConfirmMessage> msgs ;
 
-    {
+    for(auto delegate: *pDelegates){
+        Miner miner ;
+        if(!PbftFindMiner(delegate, miner))
+            continue ;
+        msg.miner = miner.account.regid ;
+        vector<unsigned char > vSign ;
+        uint256 messageHash = msg.GetHash() ;
 
-        for(auto delegate: delegates){
-            Miner miner ;
-            if(!PbftFindMiner(delegate, miner))
-                continue ;
-            msg.miner = miner.account.regid ;
-            vector<unsigned char > vSign ;
-            uint256 messageHash = msg.GetHash() ;
-
-            miner.key.Sign(messageHash, vSign);
-            msg.SetSignature(vSign);
-
-            {
-                LOCK(cs_vNodes);
-                for (auto pNode : vNodes) {
-                    pNode->PushBlockConfirmMessage(msg) ;
-                }
-            }
-            msgMan.SaveMessageByBlock(msg.blockHash,msg);
+        miner.key.Sign(messageHash, vSign);
+        msg.SetSignature(vSign);
 
-        }
+        msgMan.SaveMessageByBlock(msg, pDelegates);
+        msgs.push_back(msg);
     }
 
+    RelayBlockConfirmMessages(msgs);
+
     msgMan.SaveBroadcastedBlock(block->GetBlockHash());
     return true ;
 }
@@ -383,19 +314,15 @@ bool BroadcastBlockConfirm(const CBlockIndex* block) {
 bool CheckPBFTMessageSignaturer(const CPBFTMessage& msg) {
 
     //查找上一个区块执行过后的矿工列表
-    set<CRegID> delegates;
-
-    if(pbftContext.GetMinerListByBlockHash(msg.preBlockHash, delegates)) {
-        if(delegates.count(msg.miner) > 0)
-            return true ;
-    }
-    return false ;
+    PBFTDelegates pDelegates = pbftContext.GetDelegates(msg.preBlockHash);
+    return pDelegates != nullptr && std::binary_search(pDelegates->begin(), pDelegates->end(), msg.miner) ;
 }
 
-bool CheckPBFTMessage(const int32_t msgType ,const CPBFTMessage& msg){
+static bool CheckPBFTMessageHeader(const int32_t msgType, const CPBFTMessage& msg) {
 
-    //check height
+    AssertLockHeld(cs_main);
 
+    //check height
     CBlockIndex* localFinBlock = pbftMan.GetLocalFinIndex() ;
     if(msg.height - chainActive.Height()>500 || (localFinBlock && msg.height < (uint32_t)localFinBlock->height) ) {
         return ERRORMSG("checkPBftMessage():: messagesHeight is out range");
@@ -410,41 +337,96 @@ bool CheckPBFTMessage(const int32_t msgType ,const CPBFTMessage& msg){
     if(pIndex != nullptr &&pIndex->GetBlockHash() != msg.blockHash){
         return ERRORMSG("checkPbftMessage(): block not on chainActive") ;
     }
+    if(pIndex != nullptr && pIndex->pprev != nullptr && pIndex->pprev->GetBlockHash() != msg.preBlockHash){
+        return ERRORMSG("checkPbftMessage(): previous block mismatch") ;
+    }
+
+    return true ;
+}
+
+void CheckPBFTMessages(const int32_t msgType, const vector<const CPBFTMessage*>& msgs, vector<bool>& results) {
+
+    results.assign(msgs.size(), false);
 
-    //check signature
-    CAccount account ;
+    // the delegates sign with their miner key if they have one, else with the owner key, so the
+    // miner key is tried first and the other one only for the signatures that failed
+    vector<SignatureCheck> checks ;
+    vector<size_t> checkIndexes ;
+    vector<CPubKey> otherPubKeys ;
     {
         LOCK(cs_main) ;
-        if(!pCdMan->pAccountCache->GetAccount(msg.miner, account)) {
-            return ERRORMSG("checkPBftMessage() : the signature creator is not found!");
+        for(size_t i = 0; i < msgs.size(); i++) {
+            const CPBFTMessage& msg = *msgs[i];
+            if(!CheckPBFTMessageHeader(msgType, msg))
+                continue ;
+
+            CAccount account ;
+            if(!pCdMan->pAccountCache->GetAccount(msg.miner, account)) {
+                ERRORMSG("checkPBftMessage() : the signature creator is not found!");
+                continue ;
+            }
+
+            bool fMinerKey = account.miner_pubkey.IsValid();
+            checks.emplace_back(msg.GetHash(), &msg.vSignature, fMinerKey ? account.miner_pubkey : account.owner_pubkey);
+            checkIndexes.push_back(i);
+            otherPubKeys.push_back(fMinerKey ? account.owner_pubkey : CPubKey());
         }
     }
-    uint256 messageHash = msg.GetHash();
-    if (!VerifySignature(messageHash, msg.vSignature, account.owner_pubkey)) {
-        if (!VerifySignature(messageHash, msg.vSignature, account.miner_pubkey))
-            return ERRORMSG("checkPBftMessage() : verify signature error");
+
+    vector<bool> verified ;
+    VerifySignatures(checks, verified);
+
+    for(size_t k = 0; k < checks.size(); k++) {
+        if(verified[k] || (otherPubKeys[k].IsValid() &&
+                           VerifySignature(std::get<0>(checks[k]), *std::get<1>(checks[k]), otherPubKeys[k])))
+            results[checkIndexes[k]] = true ;
+        else
+            ERRORMSG("checkPBftMessage() : verify signature error");
     }
+}
 
-    return true ;
+bool CheckPBFTMessage(const int32_t msgType ,const CPBFTMessage& msg){
 
+    vector<bool> results ;
+    CheckPBFTMessages(msgType, vector<const CPBFTMessage*>(1, &msg), results);
+    return results[0] ;
 }
 
 bool RelayBlockConfirmMessage(const CBlockConfirmMessage& msg){
 
+    return RelayBlockConfirmMessages(vector<CBlockConfirmMessage>(1, msg));
+}
+
+bool RelayBlockFinalityMessage(const CBlockFinalityMessage& msg){
+
+    return RelayBlockFinalityMessages(vector<CBlockFinalityMessage>(1, msg));
+}
+
+// queue the messages for all peers and have them sent right away, they go out in one batch per peer
+bool RelayBlockConfirmMessages(const vector<CBlockConfirmMessage>& msgs){
+
+    if(msgs.empty())
+        return false ;
+
     LOCK(cs_vNodes) ;
     for(auto node:vNodes){
-        node->PushBlockConfirmMessage(msg);
+        for(const auto& msg: msgs)
+            node->PushBlockConfirmMessage(msg);
+        WakeMessageHandler(node);
     }
     return true ;
 }
 
-bool RelayBlockFinalityMessage(const CBlockFinalityMessage& msg){
+bool RelayBlockFinalityMessages(const vector<CBlockFinalityMessage>& msgs){
+
+    if(msgs.empty())
+        return false ;
 
     LOCK(cs_vNodes);
     for(auto node:vNodes){
-        node->PushBlockFinalityMessage(msg);
+        for(const auto& msg: msgs)
+            node->PushBlockFinalityMessage(msg);
+        WakeMessageHandler(node);
     }
     return true ;
 }
-
-
@@ -44,8 +44,16 @@ bool BroadcastBlockFinality(const CBlockIndex* block) ;
 
 bool CheckPBFTMessage(const int32_t msgType ,const CPBFTMessage& msg) ;
 
+// check a batch of messages, their signatures are verified in parallel; results[i] is set
+// if msgs[i] is valid
+void CheckPBFTMessages(const int32_t msgType, const std::vector<const CPBFTMessage*>& msgs, std::vector<bool>& results) ;
+
 bool CheckPBFTMessageSignaturer(const CPBFTMessage& msg) ;
 bool RelayBlockConfirmMessage(const CBlockConfirmMessage& msg) ;
 
 bool RelayBlockFinalityMessage(const CBlockFinalityMessage& msg) ;
+
+bool RelayBlockConfirmMessages(const std::vector<CBlockConfirmMessage>& msgs) ;
+
+bool RelayBlockFinalityMessages(const std::vector<CBlockFinalityMessage>& msgs) ;
 #endif //MINER_PBFTMANAGER_H
@@ -15,6 +15,7 @@
 #include "tx/tx.h"
 #include "commons/util/time.h"
 #include "p2p/node.h"
+#include "p2p/socketevents.h"
 
 #ifdef WIN32
 #include <string.h>
@@ -33,7 +34,10 @@
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -476,68 +480,383 @@ CNode* ConnectNode(CAddress addrConnect, const char* pszDest) {
 }
 
 
+/**
+ * Peers with messages waiting for one message handler thread. Every peer is pinned to one
+ * thread by its id, so its messages are still handled one at a time and in order, while
+ * different peers are served in parallel.
+ */
+class CMessageHandlerQueue {
+public:
+    void Push(NodeId id) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!setReady.insert(id).second)
+                return;
+        }
+        cond.notify_one();
+    }
+
+    // wait until a peer is queued or nDeadline (GetTimeMillis) passed, and take the queued peers
+    void Wait(set<NodeId>& setReadyOut, int64_t nDeadline) {
+        std::unique_lock<std::mutex> lock(mutex);
+        int64_t nWait = nDeadline - GetTimeMillis();
+        if (setReady.empty() && nWait > 0)
+            cond.wait_for(lock, std::chrono::milliseconds(nWait));
+        setReadyOut.clear();
+        setReadyOut.swap(setReady);
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    set<NodeId> setReady;
+};
+
+static vector<std::unique_ptr<CMessageHandlerQueue>> vMessageHandlerQueues;
+
+static size_t GetMessageHandler(const CNode* pNode) { return pNode->GetId() % vMessageHandlerQueues.size(); }
+
+void WakeMessageHandler(CNode* pNode) {
+    if (!vMessageHandlerQueues.empty())
+        vMessageHandlerQueues[GetMessageHandler(pNode)]->Push(pNode->GetId());
+}
+
 static list<CNode*> vNodesDisconnected;
 
+static void DisconnectNodes(uint32_t& nPrevNodeCount) {
+    {
+        LOCK(cs_vNodes);
+        // Disconnect unused nodes
+        vector<CNode*> vNodesCopy = vNodes;
+        for (auto pNode : vNodesCopy) {
+            if (pNode->fDisconnect || (pNode->GetRefCount() <= 0 && pNode->vRecvMsg.empty() &&
+                                       pNode->nSendSize == 0 && pNode->ssSend.empty())) {
+                // remove from vNodes
+                vNodes.erase(remove(vNodes.begin(), vNodes.end(), pNode), vNodes.end());
+
+                // release outbound grant (if any)
+                pNode->grantOutbound.Release();
+
+                // close socket and cleanup
+                pNode->CloseSocketDisconnect();
+                pNode->Cleanup();
+
+                // hold in disconnected pool until all refs are released
+                if (pNode->fNetworkNode || pNode->fInbound)
+                    pNode->Release();
+                vNodesDisconnected.push_back(pNode);
+            }
+        }
+    }
+    {
+        // Delete disconnected nodes
+        list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
+        for (auto pNode : vNodesDisconnectedCopy) {
+            // wait until threads are done using it
+            if (pNode->GetRefCount() <= 0) {
+                bool fDelete = false;
+                {
+                    TRY_LOCK(pNode->cs_vSend, lockSend);
+                    if (lockSend) {
+                        TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
+                        if (lockRecv) {
+                            TRY_LOCK(pNode->cs_inventory, lockInv);
+                            if (lockInv)
+                                fDelete = true;
+                        }
+                    }
+                }
+                if (fDelete) {
+                    vNodesDisconnected.remove(pNode);
+                    delete pNode;
+                }
+            }
+        }
+    }
+    if (vNodes.size() != nPrevNodeCount) {
+        nPrevNodeCount = vNodes.size();
+
+        LogPrint(BCLog::INFO, "Connections number changed, %d -> %d\n", nPrevNodeCount, vNodes.size());
+    }
+}
+
+static void AcceptConnection(SOCKET hListenSocket) {
+    struct sockaddr_storage sockaddr;
+    socklen_t len  = sizeof(sockaddr);
+    SOCKET hSocket = accept(hListenSocket, (struct sockaddr*)&sockaddr, &len);
+    CAddress addr;
+    int32_t nInbound = 0;
+
+    if (hSocket != INVALID_SOCKET)
+        if (!addr.SetSockAddr((const struct sockaddr*)&sockaddr))
+            LogPrint(BCLog::INFO, "Warning: Unknown socket family\n");
+
+    {
+        LOCK(cs_vNodes);
+        for (auto pNode : vNodes)
+            if (pNode->fInbound)
+                nInbound++;
+    }
+
+    if (hSocket == INVALID_SOCKET) {
+        int32_t nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK)
+            LogPrint(BCLog::INFO, "socket[%s] error accept failed: %s\n", addr.ToString(), NetworkErrorString(nErr));
+    } else if (nInbound >= nMaxConnections - MAX_OUTBOUND_CONNECTIONS) {
+        closesocket(hSocket);
+    } else if (CNode::IsBanned(addr)) {
+        LogPrint(BCLog::INFO, "connection from %s dropped (banned)\n", addr.ToString());
+        closesocket(hSocket);
+    } else {
+        LogPrint(BCLog::NET, "accepted connection %s\n", addr.ToString());
+        CNode* pNode = new CNode(hSocket, addr, "", true);
+        pNode->AddRef();
+        {
+            LOCK(cs_vNodes);
+            vNodes.push_back(pNode);
+        }
+    }
+}
+
+// Receive once into the node's message buffer. Returns false when the socket
+// buffer is known to be drained (or the socket got closed).
+static bool SocketRecvData(CNode* pNode) {
+    bool fMoreData = false;
+    bool fMessage  = false;
+    {
+        TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
+        if (!lockRecv)
+            return true;
+
+        // typical socket buffer is 8K-64K
+        char pchBuf[0x10000];
+        char* pch      = pchBuf;
+        uint32_t nSize = sizeof(pchBuf);
+
+        // the rest of a large message goes straight into its buffer instead of through pchBuf
+        CNetMessage* pMsg = pNode->vRecvMsg.empty() ? nullptr : &pNode->vRecvMsg.back();
+        if (pMsg && pMsg->DataRemaining() >= sizeof(pchBuf)) {
+            pch   = pMsg->DataEnd();
+            nSize = pMsg->DataRemaining();
+        } else {
+            pMsg = nullptr;
+        }
+
+        int32_t nBytes = recv(pNode->hSocket, pch, nSize, MSG_DONTWAIT);
+        if (nBytes > 0) {
+            if (pMsg)
+                pMsg->DataReceived(nBytes);
+            else if (!pNode->ReceiveMsgBytes(pchBuf, nBytes))
+                pNode->CloseSocketDisconnect();
+            pNode->nLastRecv = GetTime();
+            pNode->nRecvBytes += nBytes;
+            pNode->RecordBytesRecv(nBytes);
+            fMessage  = !pNode->vRecvMsg.empty() && pNode->vRecvMsg.front().complete();
+            fMoreData = (uint32_t)nBytes == nSize;
+        } else if (nBytes == 0) {
+            // socket closed gracefully
+            if (!pNode->fDisconnect)
+                LogPrint(BCLog::NET, "socket[%s] closed\n", pNode->addr.ToString());
+            pNode->CloseSocketDisconnect();
+        } else if (nBytes < 0) {
+            // error
+            int32_t nErr = WSAGetLastError();
+            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
+                if (!pNode->fDisconnect)
+                    LogPrint(BCLog::INFO, "socket[%s] recv error %s\n", pNode->addr.ToString(), NetworkErrorString(nErr));
+                pNode->CloseSocketDisconnect();
+            }
+        }
+    }
+
+    if (fMessage)
+        WakeMessageHandler(pNode);
+    return fMoreData;
+}
+
+static void InactivityCheck(CNode* pNode) {
+    if (pNode->vSendMsg.empty())
+        pNode->nLastSendEmpty = GetTime();
+    // p2p_xiaoyu_20191126
+    // if (GetTime() - pNode->nTimeConnected > 60) {
+    //     if (pNode->nLastRecv == 0 || pNode->nLastSend == 0) {
+    //         LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d\n", pNode->nLastRecv != 0,
+    //                  pNode->nLastSend != 0);
+    //         pNode->fDisconnect = true;
+    //     } else if (GetTime() - pNode->nLastSend > 90 * 60 && GetTime() - pNode->nLastSendEmpty > 90 * 60) {
+    //         LogPrint(BCLog::INFO, "socket not sending\n");
+    //         pNode->fDisconnect = true;
+    //     } else if (GetTime() - pNode->nLastRecv > 90 * 60) {
+    //         LogPrint(BCLog::INFO, "socket inactivity timeout\n");
+    //         pNode->fDisconnect = true;
+    //     }
+    // }
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime - pNode->nTimeConnected > DEFAULT_PEER_CONNECT_TIMEOUT)
+    {
+        if (pNode->nLastRecv == 0 || pNode->nLastSend == 0)
+        {
+            LogPrint(BCLog::NET, "socket no message in first %i seconds, %d %d from %d\n", DEFAULT_PEER_CONNECT_TIMEOUT, pNode->nLastRecv != 0, pNode->nLastSend != 0, pNode->GetId());
+            pNode->fDisconnect = true;
+        }
+        else if (nTime - pNode->nLastSend > TIMEOUT_INTERVAL)
+        {
+            LogPrint(BCLog::NET, "socket sending timeout: %is\n", nTime - pNode->nLastSend);
+            pNode->fDisconnect = true;
+        }
+        else if (nTime - pNode->nLastRecv > TIMEOUT_INTERVAL )
+        {
+            LogPrint(BCLog::NET, "socket receive timeout: %is\n", nTime - pNode->nLastRecv);
+            pNode->fDisconnect = true;
+        }
+        else if (pNode->nPingNonceSent && pNode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
+        {
+            LogPrint(BCLog::NET, "ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pNode->nPingUsecStart));
+            pNode->fDisconnect = true;
+        }
+        else if (!pNode->fSuccessfullyConnected)
+        {
+            LogPrint(BCLog::NET, "version handshake timeout from %d\n", pNode->GetId());
+            pNode->fDisconnect = true;
+        }
+    }
+}
+
+// Whether to read from the node now. If there is data to send, that happens only when
+// the optimistic write failed, and the write buffer is drained before receiving more.
+// This avoids needlessly queueing received data, if the remote peer is not themselves
+// receiving data. This means properly utilizing TCP flow control signalling.
+// Otherwise read unless there's a complete message waiting and the buffer is full.
+// Together, that means that at least one of the following is always possible,
+// so we don't deadlock:
+// * We send some data.
+// * We wait for data to be received (and disconnect after timeout).
+// * We process a message in the buffer (message handler thread).
+static bool WantRecv(CNode* pNode) {
+    {
+        TRY_LOCK(pNode->cs_vSend, lockSend);
+        if (lockSend && !pNode->vSendMsg.empty())
+            return false;
+    }
+    TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
+    return lockRecv && (pNode->vRecvMsg.empty() || !pNode->vRecvMsg.front().complete() ||
+                        pNode->GetTotalRecvSize() <= ReceiveFloodSize());
+}
+
+#ifdef USE_EPOLL
+
+// Sockets report readiness through an edge triggered epoll set, so each loop only touches
+// the nodes which have something to do. A node stays in setRecvReady (holding a ref) until
+// a recv() comes back short, since the socket won't be reported again before that.
 void ThreadSocketHandler() {
-    uint32_t nPrevNodeCount = 0;
+    CSocketEvents& socketEvents = GetSocketEvents();
+    for (auto hListenSocket : vhListenSocket)
+        if (hListenSocket != INVALID_SOCKET)
+            socketEvents.AddListenSocket(hListenSocket);
+
+    uint32_t nPrevNodeCount      = 0;
+    int64_t nLastInactivityCheck = 0;
+    bool fMoreData               = false;
+    set<CNode*> setRecvReady;
+    set<CNode*> setSendReady;
+    vector<CSocketEvents::Event> vEvents;
     while (true) {
-        //
-        // Disconnect nodes
-        //
+        DisconnectNodes(nPrevNodeCount);
+
+        // don't wait while a socket still has data that was left for the next round
+        if (!socketEvents.Wait(vEvents, fMoreData ? 0 : 50))
+            MilliSleep(50);
+        boost::this_thread::interruption_point();
+
         {
             LOCK(cs_vNodes);
-            // Disconnect unused nodes
-            vector<CNode*> vNodesCopy = vNodes;
-            for (auto pNode : vNodesCopy) {
-                if (pNode->fDisconnect || (pNode->GetRefCount() <= 0 && pNode->vRecvMsg.empty() &&
-                                           pNode->nSendSize == 0 && pNode->ssSend.empty())) {
-                    // remove from vNodes
-                    vNodes.erase(remove(vNodes.begin(), vNodes.end(), pNode), vNodes.end());
-
-                    // release outbound grant (if any)
-                    pNode->grantOutbound.Release();
-
-                    // close socket and cleanup
-                    pNode->CloseSocketDisconnect();
-                    pNode->Cleanup();
+            for (const auto& event : vEvents) {
+                if (event.pNode == nullptr)
+                    continue;
+                if (event.fRecv && setRecvReady.insert(event.pNode).second)
+                    event.pNode->AddRef();
+                if (event.fSend && setSendReady.insert(event.pNode).second)
+                    event.pNode->AddRef();
+            }
+        }
 
-                    // hold in disconnected pool until all refs are released
-                    if (pNode->fNetworkNode || pNode->fInbound)
-                        pNode->Release();
-                    vNodesDisconnected.push_back(pNode);
+        //
+        // Accept new connections
+        //
+        for (const auto& event : vEvents)
+            if (event.pNode == nullptr) {
+                for (auto hListenSocket : vhListenSocket)
+                    if (hListenSocket != INVALID_SOCKET)
+                        AcceptConnection(hListenSocket);
+                break;
+            }
+
+        //
+        // Service the ready sockets
+        //
+        vector<CNode*> vNodesDone;
+        for (auto it = setSendReady.begin(); it != setSendReady.end();) {
+            boost::this_thread::interruption_point();
+
+            CNode* pNode = *it;
+            if (pNode->hSocket != INVALID_SOCKET) {
+                TRY_LOCK(pNode->cs_vSend, lockSend);
+                if (!lockSend) {
+                    ++it;
+                    continue;
                 }
+                pNode->SocketSendData();
             }
+            vNodesDone.push_back(pNode);
+            it = setSendReady.erase(it);
         }
-        {
-            // Delete disconnected nodes
-            list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
-            for (auto pNode : vNodesDisconnectedCopy) {
-                // wait until threads are done using it
-                if (pNode->GetRefCount() <= 0) {
-                    bool fDelete = false;
-                    {
-                        TRY_LOCK(pNode->cs_vSend, lockSend);
-                        if (lockSend) {
-                            TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                            if (lockRecv) {
-                                TRY_LOCK(pNode->cs_inventory, lockInv);
-                                if (lockInv)
-                                    fDelete = true;
-                            }
-                        }
-                    }
-                    if (fDelete) {
-                        vNodesDisconnected.remove(pNode);
-                        delete pNode;
-                    }
+
+        fMoreData = false;
+        for (auto it = setRecvReady.begin(); it != setRecvReady.end();) {
+            boost::this_thread::interruption_point();
+
+            CNode* pNode = *it;
+            if (pNode->hSocket != INVALID_SOCKET) {
+                if (!WantRecv(pNode)) {
+                    ++it;
+                    continue;
+                }
+                if (SocketRecvData(pNode) && pNode->hSocket != INVALID_SOCKET) {
+                    fMoreData = true;
+                    ++it;
+                    continue;
                 }
             }
+            vNodesDone.push_back(pNode);
+            it = setRecvReady.erase(it);
+        }
+
+        //
+        // Inactivity checking
+        //
+        int64_t nNow = GetTime();
+        if (nNow != nLastInactivityCheck) {
+            nLastInactivityCheck = nNow;
+            LOCK(cs_vNodes);
+            for (auto pNode : vNodes)
+                if (pNode->hSocket != INVALID_SOCKET)
+                    InactivityCheck(pNode);
         }
-        if (vNodes.size() != nPrevNodeCount) {
-            nPrevNodeCount = vNodes.size();
 
-            LogPrint(BCLog::INFO, "Connections number changed, %d -> %d\n", nPrevNodeCount, vNodes.size());
+        {
+            LOCK(cs_vNodes);
+            for (auto pNode : vNodesDone)
+                pNode->Release();
         }
+    }
+}
+
+#else
+
+void ThreadSocketHandler() {
+    uint32_t nPrevNodeCount = 0;
+    while (true) {
+        DisconnectNodes(nPrevNodeCount);
 
         //
         // Find which sockets have data to receive
@@ -571,21 +890,6 @@ void ThreadSocketHandler() {
                 hSocketMax = max(hSocketMax, pNode->hSocket);
                 have_fds   = true;
 
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is no (complete) message in the receive buffer,
-                //   or there is space left in the buffer, select() for receiving data.
-                // * (if neither of the above applies, there is certainly one message
-                //   in the receiver buffer ready to be processed).
-                // Together, that means that at least one of the following is always possible,
-                // so we don't deadlock:
-                // * We send some data.
-                // * We wait for data to be received (and disconnect after timeout).
-                // * We process a message in the buffer (message handler thread).
                 {
                     TRY_LOCK(pNode->cs_vSend, lockSend);
                     if (lockSend && !pNode->vSendMsg.empty()) {
@@ -593,12 +897,8 @@ void ThreadSocketHandler() {
                         continue;
                     }
                 }
-                {
-                    TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                    if (lockRecv && (pNode->vRecvMsg.empty() || !pNode->vRecvMsg.front().complete() ||
-                                     pNode->GetTotalRecvSize() <= ReceiveFloodSize()))
-                        FD_SET(pNode->hSocket, &fdsetRecv);
-                }
+                if (WantRecv(pNode))
+                    FD_SET(pNode->hSocket, &fdsetRecv);
             }
         }
 
@@ -621,43 +921,8 @@ void ThreadSocketHandler() {
         // Accept new connections
         //
         for (auto hListenSocket : vhListenSocket)
-            if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv)) {
-                struct sockaddr_storage sockaddr;
-                socklen_t len  = sizeof(sockaddr);
-                SOCKET hSocket = accept(hListenSocket, (struct sockaddr*)&sockaddr, &len);
-                CAddress addr;
-                int32_t nInbound = 0;
-
-                if (hSocket != INVALID_SOCKET)
-                    if (!addr.SetSockAddr((const struct sockaddr*)&sockaddr))
-                        LogPrint(BCLog::INFO, "Warning: Unknown socket family\n");
-
-                {
-                    LOCK(cs_vNodes);
-                    for (auto pNode : vNodes)
-                        if (pNode->fInbound)
-                            nInbound++;
-                }
-
-                if (hSocket == INVALID_SOCKET) {
-                    int32_t nErr = WSAGetLastError();
-                    if (nErr != WSAEWOULDBLOCK)
-                        LogPrint(BCLog::INFO, "socket[%s] error accept failed: %s\n", addr.ToString(), NetworkErrorString(nErr));
-                } else if (nInbound >= nMaxConnections - MAX_OUTBOUND_CONNECTIONS) {
-                    closesocket(hSocket);
-                } else if (CNode::IsBanned(addr)) {
-                    LogPrint(BCLog::INFO, "connection from %s dropped (banned)\n", addr.ToString());
-                    closesocket(hSocket);
-                } else {
-                    LogPrint(BCLog::NET, "accepted connection %s\n", addr.ToString());
-                    CNode* pNode = new CNode(hSocket, addr, "", true);
-                    pNode->AddRef();
-                    {
-                        LOCK(cs_vNodes);
-                        vNodes.push_back(pNode);
-                    }
-                }
-            }
+            if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv))
+                AcceptConnection(hListenSocket);
 
         //
         // Service each socket
@@ -677,37 +942,8 @@ void ThreadSocketHandler() {
             //
             if (pNode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pNode->hSocket, &fdsetRecv) || FD_ISSET(pNode->hSocket, &fdsetError)) {
-                TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                if (lockRecv) {
-                    {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int32_t nBytes = recv(pNode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                        if (nBytes > 0) {
-                            if (!pNode->ReceiveMsgBytes(pchBuf, nBytes))
-                                pNode->CloseSocketDisconnect();
-                            pNode->nLastRecv = GetTime();
-                            pNode->nRecvBytes += nBytes;
-                            pNode->RecordBytesRecv(nBytes);
-                        } else if (nBytes == 0) {
-                            // socket closed gracefully
-                            if (!pNode->fDisconnect)
-                                LogPrint(BCLog::NET, "socket[%s] closed\n", pNode->addr.ToString());
-                            pNode->CloseSocketDisconnect();
-                        } else if (nBytes < 0) {
-                            // error
-                            int32_t nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR &&
-                                nErr != WSAEINPROGRESS) {
-                                if (!pNode->fDisconnect)
-                                    LogPrint(BCLog::INFO, "socket[%s] recv error %s\n", pNode->addr.ToString(), NetworkErrorString(nErr));
-                                pNode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
-            }
+            if (FD_ISSET(pNode->hSocket, &fdsetRecv) || FD_ISSET(pNode->hSocket, &fdsetError))
+                SocketRecvData(pNode);
 
             //
             // Send
@@ -723,53 +959,7 @@ void ThreadSocketHandler() {
             //
             // Inactivity checking
             //
-            if (pNode->vSendMsg.empty())
-                pNode->nLastSendEmpty = GetTime();
-            // p2p_xiaoyu_20191126
-            // if (GetTime() - pNode->nTimeConnected > 60) {
-            //     if (pNode->nLastRecv == 0 || pNode->nLastSend == 0) {
-            //         LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d\n", pNode->nLastRecv != 0,
-            //                  pNode->nLastSend != 0);
-            //         pNode->fDisconnect = true;
-            //     } else if (GetTime() - pNode->nLastSend > 90 * 60 && GetTime() - pNode->nLastSendEmpty > 90 * 60) {
-            //         LogPrint(BCLog::INFO, "socket not sending\n");
-            //         pNode->fDisconnect = true;
-            //     } else if (GetTime() - pNode->nLastRecv > 90 * 60) {
-            //         LogPrint(BCLog::INFO, "socket inactivity timeout\n");
-            //         pNode->fDisconnect = true;
-            //     }
-            // }
-            int64_t nTime = GetSystemTimeInSeconds();
-            if (nTime - pNode->nTimeConnected > DEFAULT_PEER_CONNECT_TIMEOUT)
-            {
-                if (pNode->nLastRecv == 0 || pNode->nLastSend == 0)
-                {
-                    LogPrint(BCLog::NET, "socket no message in first %i seconds, %d %d from %d\n", DEFAULT_PEER_CONNECT_TIMEOUT, pNode->nLastRecv != 0, pNode->nLastSend != 0, pNode->GetId());
-                    pNode->fDisconnect = true;
-                }
-                else if (nTime - pNode->nLastSend > TIMEOUT_INTERVAL)
-                {
-                    LogPrint(BCLog::NET, "socket sending timeout: %is\n", nTime - pNode->nLastSend);
-                    pNode->fDisconnect = true;
-                }
-                else if (nTime - pNode->nLastRecv > TIMEOUT_INTERVAL )
-                {
-                    LogPrint(BCLog::NET, "socket receive timeout: %is\n", nTime - pNode->nLastRecv);
-                    pNode->fDisconnect = true;
-                }
-                else if (pNode->nPingNonceSent && pNode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
-                {
-                    LogPrint(BCLog::NET, "ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pNode->nPingUsecStart));
-                    pNode->fDisconnect = true;
-                }
-                else if (!pNode->fSuccessfullyConnected)
-                {
-                    LogPrint(BCLog::NET, "version handshake timeout from %d\n", pNode->GetId());
-                    pNode->fDisconnect = true;
-                }
-            }
-
-
+            InactivityCheck(pNode);
         }
 
         {
@@ -780,6 +970,8 @@ void ThreadSocketHandler() {
     }
 }
 
+#endif  // USE_EPOLL
+
 #ifdef USE_UPNP
 void ThreadMapPort() {
     string port               = strprintf("%u", GetListenPort());
@@ -1142,12 +1334,10 @@ bool OpenNetworkConnection(const CAddress& addrConnect, CSemaphoreGrant* grantOu
     return true;
 }
 
-void static StartSync(const vector<CNode*>& vNodes) {
+void static StartSync(const vector<CNode*>& vNodes, int32_t nBestHeight) {
     CNode* pnodeNewSync = nullptr;
     int64_t nBestScore  = 0;
 
-    int32_t nBestHeight = GetNodeSignals().GetHeight().get_value_or(0);
-
     // Iterate over all nodes
     for (auto pNode : vNodes) {
         // check preconditions for allowing a sync
@@ -1171,48 +1361,65 @@ void static StartSync(const vector<CNode*>& vNodes) {
     }
 }
 
-void ThreadMessageHandler() {
-    SetThreadPriority(THREAD_PRIORITY_BELOW_NORMAL);
+// Message handler thread nThread. Peers are handled as soon as the socket thread has queued
+// them, besides that there is a pass over all peers of the thread every
+// MESSAGE_HANDLER_PASS_INTERVAL ms for the periodic work of SendMessages (trickle, pings,
+// block download) and for peers which had to wait for their send buffer to drain.
+void ThreadMessageHandler(size_t nThread) {
+    CMessageHandlerQueue& queue = *vMessageHandlerQueues[nThread];
+    int64_t nNextPass           = 0;
+    set<NodeId> setReady;
     while (true) {
-        bool fHaveSyncNode = false;
+        queue.Wait(setReady, nNextPass);
+        boost::this_thread::interruption_point();
+
+        bool fPass = GetTimeMillis() >= nNextPass;
+        if (fPass)
+            nNextPass = GetTimeMillis() + MESSAGE_HANDLER_PASS_INTERVAL;
+
+        // the sync peer is looked after by the first thread
+        int32_t nBestHeight = 0;
+        if (fPass && nThread == 0)
+            nBestHeight = GetNodeSignals().GetHeight().get_value_or(0);
 
         vector<CNode*> vNodesCopy;
+        CNode* pnodeTrickle = nullptr;
         {
             LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
-            for (auto pNode : vNodesCopy) {
-                pNode->AddRef();
+            bool fHaveSyncNode = false;
+            for (auto pNode : vNodes) {
                 if (pNode == pnodeSync)
                     fHaveSyncNode = true;
+                if (GetMessageHandler(pNode) == nThread && (fPass || setReady.count(pNode->GetId())))
+                    vNodesCopy.push_back(pNode->AddRef());
             }
-        }
 
-        if (!fHaveSyncNode)
-            StartSync(vNodesCopy);
+            if (fPass && nThread == 0 && !fHaveSyncNode)
+                StartSync(vNodes, nBestHeight);
 
-        // Poll the connected nodes for messages
-        CNode* pnodeTrickle = nullptr;
-        if (!vNodesCopy.empty())
-            pnodeTrickle = vNodesCopy[GetRand(vNodesCopy.size())];
-
-        bool fSleep = true;
+            // one peer in all gets the trickled messages per pass
+            if (fPass && !vNodes.empty()) {
+                CNode* pNode = vNodes[GetRand(vNodes.size())];
+                if (GetMessageHandler(pNode) == nThread)
+                    pnodeTrickle = pNode;
+            }
+        }
 
         for (auto pNode : vNodesCopy) {
             if (pNode->fDisconnect)
                 continue;
 
             // Receive messages
+            bool fMore = false;
             {
-                TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                if (lockRecv) {
-                    if (!GetNodeSignals().ProcessMessages(pNode))
-                        pNode->CloseSocketDisconnect();
-
-                    if (pNode->nSendSize < SendBufferSize()) {
-                        if (!pNode->vRecvGetData.empty() ||
-                            (!pNode->vRecvMsg.empty() && pNode->vRecvMsg[0].complete())) {
-                            fSleep = false;
-                        }
+                LOCK(pNode->cs_vRecvMsg);
+                if (!GetNodeSignals().ProcessMessages(pNode))
+                    pNode->CloseSocketDisconnect();
+
+                if (pNode->nSendSize < SendBufferSize()) {
+                    if (!pNode->vRecvGetData.empty() ||
+                        (!pNode->vRecvMsg.empty() && pNode->vRecvMsg[0].complete())) {
+                        fMore = true;
                     }
                 }
             }
@@ -1225,6 +1432,10 @@ void ThreadMessageHandler() {
                     GetNodeSignals().SendMessages(pNode, pNode == pnodeTrickle);
             }
 
+            // ProcessMessages handles one message per call, come back for the rest
+            if (fMore)
+                queue.Push(pNode->GetId());
+
             boost::this_thread::interruption_point();
         }
 
@@ -1233,9 +1444,6 @@ void ThreadMessageHandler() {
             for (auto pNode : vNodesCopy)
                 pNode->Release();
         }
-
-        if (fSleep)
-            MilliSleep(100);
     }
 }
 
@@ -1407,6 +1615,13 @@ void StartNode(boost::thread_group& threadGroup) {
     MapPort(SysCfg().GetBoolArg("-upnp", USE_UPNP));
 #endif
 
+    // Message handler queues have to be there before the socket thread wakes them
+    int32_t nMessageHandlers = SysCfg().GetArg("-msghandlerthreads", DEFAULT_MESSAGE_HANDLER_THREADS);
+    nMessageHandlers         = max(min(nMessageHandlers, MAX_MESSAGE_HANDLER_THREADS), 1);
+    vMessageHandlerQueues.clear();
+    for (int32_t i = 0; i < nMessageHandlers; i++)
+        vMessageHandlerQueues.emplace_back(new CMessageHandlerQueue());
+
     // Send and receive from sockets, accept connections
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "net", &ThreadSocketHandler));
 
@@ -1417,7 +1632,9 @@ void StartNode(boost::thread_group& threadGroup) {
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "opencon", &ThreadOpenConnections));
 
     // Process messages
-    threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "msghand", &ThreadMessageHandler));
+    for (int32_t i = 0; i < nMessageHandlers; i++)
+        threadGroup.create_thread(boost::bind(&TraceThread<boost::function<void()> >, "msghand",
+                                              boost::function<void()>(boost::bind(&ThreadMessageHandler, i))));
 
     // Dump network addresses
     threadGroup.create_thread(boost::bind(&LoopForever<void (*)()>, "dumpaddr", &DumpAddresses, DUMP_ADDRESSES_INTERVAL * 1000));
@@ -1494,20 +1711,16 @@ void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash, const CDataStream&
         mapRelay.insert(make_pair(inv, ss));
         vRelayExpiration.push_back(make_pair(GetTime() + 15 * 60, inv));
     }
+    LogPrint(BCLog::NET, "relay tx hash:%s time:%ld\n", inv.hash.GetHex(), GetTime());
+
+    // only queued here, SendMessages batches the invs up per peer
     LOCK(cs_vNodes);
     for (auto pNode : vNodes) {
         if (!pNode->fRelayTxes)
             continue;
         LOCK(pNode->cs_filter);
-        if (pNode->pFilter) {
-            if (pNode->pFilter->IsRelevantAndUpdate(pBaseTx, hash)) {
-                pNode->PushInventory(inv);
-                LogPrint(BCLog::NET, "hash:%s time:%ld\n", inv.hash.GetHex(), GetTime());
-            }
-        } else {
+        if (!pNode->pFilter || pNode->pFilter->IsRelevantAndUpdate(pBaseTx, hash))
             pNode->PushInventory(inv);
-            LogPrint(BCLog::NET, "hash:%s time:%ld\n", inv.hash.GetHex(), GetTime());
-        }
     }
 }
 
@@ -38,6 +38,12 @@ static const int TIMEOUT_INTERVAL = 20 * 60;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 
+/** -msghandlerthreads default, peers are spread over the message handler threads */
+static const int32_t DEFAULT_MESSAGE_HANDLER_THREADS = 4;
+static const int32_t MAX_MESSAGE_HANDLER_THREADS     = 16;
+/** Time between the passes of a message handler thread over all of its peers (in milliseconds). */
+static const int64_t MESSAGE_HANDLER_PASS_INTERVAL = 100;
+
 inline uint32_t ReceiveFloodSize() { return 1000 * SysCfg().GetArg("-maxreceivebuffer", 5 * 1000); }
 void AddOneShot(string strDest);
 bool RecvLine(SOCKET hSocket, string& strLine);
@@ -87,6 +93,9 @@ extern vector<string> vAddedNodes;
 extern CCriticalSection cs_vAddedNodes;
 extern map<CNetAddr, LocalServiceInfo> mapLocalHost;
 
+// have the message handler thread of the peer run it soon, e.g. to send what was queued for it
+void WakeMessageHandler(CNode* pNode);
+
 void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash);
 void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash, const CDataStream& ss);
 
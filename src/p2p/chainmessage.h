@@ -11,6 +11,7 @@
 #include "commons/util/util.h"
 #include "main.h"
 #include "net.h"
+#include "p2p/compactblock.h"
 #include "miner/pbftcontext.h"
 #include "miner/pbftmanager.h"
 #include "tx/einvalidtxtype.h"
@@ -87,8 +88,6 @@ inline void ProcessGetData(CNode *pFrom) {
 
     vector<CInv> vNotFound;
 
-    LOCK(cs_main);
-
     while (it != pFrom->vRecvGetData.end()) {
         // Don't bother if send buffer is too full to respond anyway
         if (pFrom->nSendSize >= SendBufferSize()) {
@@ -102,27 +101,40 @@ inline void ProcessGetData(CNode *pFrom) {
             it++;
 
             if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK) {
-                bool send                                = false;
-                map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
-                if (mi != mapBlockIndex.end()) {
-                    send = true;
-                } else {
-                    LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
+                bool send      = false;
+                int32_t height = 0;
+                CDiskBlockPos pos;
+                {
+                    LOCK(cs_main);
+                    map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
+                    if (mi != mapBlockIndex.end()) {
+                        send   = true;
+                        height = mi->second->height;
+                        pos    = mi->second->GetBlockPos();
+                    } else {
+                        LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
+                    }
                 }
 
-                if (send) {
-                    // Send block from disk
-                    CBlock block;
-                    ReadBlockFromDisk((*mi).second, block);
+                // Send block as serialized on disk, the read happens without cs_main
+                CRawBlockCache::RawBlock spBlock;
+                if (send && !(spBlock = rawBlockCache.Get(inv.hash, pos))) {
+                    LogPrint(BCLog::NET, "failed to read block[%d]: %s\n", height, inv.hash.GetHex());
+                    vNotFound.push_back(inv);
+                }
+
+                if (spBlock) {
                     if (inv.type == MSG_BLOCK) {
-                        LogPrint(BCLog::NET, "send block[%u]: %s to peer %s\n", block.GetHeight(), block.GetHash().GetHex(),
+                        LogPrint(BCLog::NET, "send block[%d]: %s to peer %s\n", height, inv.hash.GetHex(),
                                  pFrom->addr.ToString());
-                        pFrom->PushMessage(NetMsgType::BLOCK, block);
+                        pFrom->PushMessage(NetMsgType::BLOCK, *spBlock);
                     }
                     else  // MSG_FILTERED_BLOCK)
                     {
                         LOCK(pFrom->cs_filter);
                         if (pFrom->pFilter) {
+                            CBlock block;
+                            CDataStream(*spBlock) >> block;
                             CMerkleBlock merkleBlock(block, *pFrom->pFilter);
                             pFrom->PushMessage("merkleblock", merkleBlock);
                             // CMerkleBlock just contains hashes, so also push any transactions in the block the client
@@ -131,8 +143,9 @@ inline void ProcessGetData(CNode *pFrom) {
                             // send here - they must either disconnect and retry or request the full block. Thus, the
                             // protocol spec specified allows for us to provide duplicate txn here, however we MUST
                             // always provide at least what the remote peer needs
+                            LOCK(pFrom->cs_inventory);
                             for (auto &pair : merkleBlock.vMatchedTxn)
-                                if (!pFrom->setInventoryKnown.count(CInv(MSG_TX, pair.second)))
+                                if (!pFrom->filterInventoryKnown.contains(pair.second))
                                     pFrom->PushMessage(NetMsgType::TX, block.vptx[pair.first]);
                         }
                         // else
@@ -145,7 +158,10 @@ inline void ProcessGetData(CNode *pFrom) {
                         // and we want it right after the last block so they don't
                         // wait for other stuff first.
                         vector<CInv> vInv;
-                        vInv.push_back(CInv(MSG_BLOCK, chainActive.Tip()->GetBlockHash()));
+                        {
+                            LOCK(cs_main);
+                            vInv.push_back(CInv(MSG_BLOCK, chainActive.Tip()->GetBlockHash()));
+                        }
                         pFrom->PushMessage(NetMsgType::INV, vInv);
                         pFrom->hashContinue.SetNull();
                         LogPrint(BCLog::NET, "reset node hashcontinue\n");
@@ -298,6 +314,9 @@ inline int32_t ProcessVersionMessage(CNode *pFrom, string strCommand, CDataStrea
     else
         pFrom->fRelayTxes = true;
 
+    // new blocks are pushed to the peer as compact blocks if both sides speak them
+    pFrom->fCompactBlocks = pFrom->nVersion >= COMPACT_BLOCKS_VERSION;
+
     if (pFrom->fInbound && addrMe.IsRoutable()) {
         pFrom->addrLocal = addrMe;
         SeenLocal(addrMe);
@@ -669,10 +688,12 @@ inline bool ProcessInvMessage(CNode *pFrom, CDataStream &vRecv) {
             LogPrint(BCLog::NET, "recv inv new data! time_ms=%lld, i=%d, msg=%s, hash=%s, peer=%s\n",
                 GetTimeMillis(), i, msgName, inv.ToString(), pFrom->addrName);
             if (!SysCfg().IsImporting() && !SysCfg().IsReindex()) {
-                if (inv.type == MSG_BLOCK)
+                if (inv.type == MSG_BLOCK) {
+                    netStats.BlockSeen(inv.hash);
                     AddBlockToQueue(inv.hash, pFrom->GetId());
-                else
+                } else {
                     pFrom->AskFor(inv);  // MSG_TX
+                }
             }
         }
 
@@ -705,16 +726,11 @@ inline bool ProcessGetDataMessage(CNode *pFrom, CDataStream &vRecv) {
     return true;
 }
 
-inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
-    CBlock block;
-    vRecv >> block;
-
-    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
-        block.GetHash().ToString(), pFrom->addr.ToString());
-    // block.Print();
-
+// Hand a block received from a peer, in full or rebuilt from a compact block, to ProcessBlock
+inline void ProcessReceivedBlock(CNode *pFrom, CBlock &block) {
     CInv inv(MSG_BLOCK, block.GetHash());
     pFrom->AddInventoryKnown(inv);
+    netStats.BlockSeen(inv.hash);
 
     {
         // Remember who we got this block from.
@@ -737,6 +753,212 @@ inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
 
 }
 
+inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlock block;
+    vRecv >> block;
+
+    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        block.GetHash().ToString(), pFrom->addr.ToString());
+    // block.Print();
+
+    ProcessReceivedBlock(pFrom, block);
+}
+
+// Fall back to downloading the full block, e.g. when a compact block couldn't be rebuilt
+inline void RequestFullBlock(CNode *pFrom, const uint256 &hash) {
+    LOCK(cs_main);
+    if (!AlreadyHave(CInv(MSG_BLOCK, hash)))
+        AddBlockToQueue(hash, pFrom->GetId());
+}
+
+/**
+ * Cheap checks of a compact block before its txs are looked up in the mempool: it extends a known
+ * block, its height and time fit and it is signed by an active delegate, so a peer can't make us
+ * scan the mempool with made up headers. nDoS is how much the peer is to blame if it fails.
+ */
+inline bool CheckCompactBlockHeader(const CBlockHeaderAndShortTxIDs &cmpctBlock, int32_t &nDoS) {
+    AssertLockHeld(cs_main);
+    const CBlockHeader &header = cmpctBlock.header;
+    nDoS                       = 0;
+
+    // the peer may be ahead of us, the regular sync gets its chain
+    auto mi = mapBlockIndex.find(header.GetPrevBlockHash());
+    if (mi == mapBlockIndex.end())
+        return ERRORMSG("CheckCompactBlockHeader() : prev block %s not found", header.GetPrevBlockHash().ToString());
+
+    CBlockIndex *pPrevBlockIndex = mi->second;
+    if (header.GetHeight() != (uint32_t)pPrevBlockIndex->height + 1) {
+        nDoS = 100;
+        return ERRORMSG("CheckCompactBlockHeader() : height %u mismatches with prev block height %d",
+                        header.GetHeight(), pPrevBlockIndex->height);
+    }
+
+    if (header.GetBlockTime() <= pPrevBlockIndex->GetBlockTime() ||
+        header.GetBlockTime() > GetAdjustedTime() + GetBlockInterval(header.GetHeight()) + 2)
+        return ERRORMSG("CheckCompactBlockHeader() : invalid block time %d", header.GetBlockTime());
+
+    // the block reward tx is always sent along, its sender is the delegate who signed the block
+    if (cmpctBlock.prefilledTxs.empty() || cmpctBlock.prefilledTxs[0].index != 0 ||
+        !cmpctBlock.prefilledTxs[0].tx || !cmpctBlock.prefilledTxs[0].tx->IsBlockRewardTx()) {
+        nDoS = 100;
+        return ERRORMSG("CheckCompactBlockHeader() : block reward tx not prefilled");
+    }
+
+    const auto &blockSignature = header.GetSignature();
+    if (blockSignature.size() == 0 || blockSignature.size() > MAX_SIGNATURE_SIZE) {
+        nDoS = 100;
+        return ERRORMSG("CheckCompactBlockHeader() : invalid block signature size");
+    }
+
+    const CUserID &delegateUid = cmpctBlock.prefilledTxs[0].tx->txUid;
+    CAccount account;
+    if (!pCdMan->pAccountCache->GetAccount(delegateUid, account))
+        return ERRORMSG("CheckCompactBlockHeader() : failed to get delegate's account, uid=%s",
+                        delegateUid.ToString());
+
+    // the active delegates of our tip, which may differ from those of a block on a fork
+    VoteDelegateVector delegates;
+    if (!pCdMan->pDelegateCache->GetActiveDelegates(delegates))
+        return ERRORMSG("CheckCompactBlockHeader() : failed to get active delegates");
+
+    bool fActiveDelegate = false;
+    for (const auto &delegate : delegates) {
+        if (delegate.regid == account.regid) {
+            fActiveDelegate = true;
+            break;
+        }
+    }
+    if (!fActiveDelegate)
+        return ERRORMSG("CheckCompactBlockHeader() : %s is not an active delegate", account.regid.ToString());
+
+    uint256 hash = header.GetHash();
+    if (!VerifySignature(hash, blockSignature, account.owner_pubkey) &&
+        !VerifySignature(hash, blockSignature, account.miner_pubkey)) {
+        nDoS = 100;
+        return ERRORMSG("CheckCompactBlockHeader() : verify signature error");
+    }
+
+    return true;
+}
+
+inline void ProcessCompactBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockHeaderAndShortTxIDs cmpctBlock;
+    vRecv >> cmpctBlock;
+
+    uint256 hash = cmpctBlock.header.GetHash();
+    LogPrint(BCLog::NET, "recv cmpctblock! time_ms=%lld, hash=%s, txs=%u, peer=%s\n", GetTimeMillis(),
+        hash.ToString(), cmpctBlock.BlockTxCount(), pFrom->addr.ToString());
+
+    CInv inv(MSG_BLOCK, hash);
+    pFrom->AddInventoryKnown(inv);
+    {
+        LOCK(cs_main);
+        if (AlreadyHave(inv))
+            return;
+
+        int32_t nDoS = 0;
+        if (!CheckCompactBlockHeader(cmpctBlock, nDoS)) {
+            LogPrint(BCLog::NET, "ignored cmpctblock %s from peer %s\n", hash.ToString(), pFrom->addr.ToString());
+            if (nDoS > 0) {
+                Misbehaving(pFrom->GetId(), nDoS);
+                return;
+            }
+
+            // we may be behind the peer or on the other side of a delegate rotation. The peer won't
+            // announce the block again, so get it in full, ProcessBlock checks it against its own chain
+            if (!mapBlockIndex.count(cmpctBlock.header.GetPrevBlockHash()))
+                PushGetBlocks(pFrom, chainActive.Tip(), uint256());
+            RequestFullBlock(pFrom, hash);
+            return;
+        }
+    }
+    netStats.BlockSeen(hash);
+
+    // a peer only has one block being rebuilt at a time, the newer one wins
+    auto pPartialBlock = std::make_shared<CPartialBlock>();
+    pFrom->pPartialBlock.reset();
+    if (!pPartialBlock->InitData(cmpctBlock, mempool)) {
+        LogPrint(BCLog::INFO, "Misbehaving: invalid cmpctblock %s, nMisbehavior add 20\n", hash.ToString());
+        Misbehaving(pFrom->GetId(), 20);
+        return;
+    }
+
+    if (pPartialBlock->IsComplete()) {
+        CBlock block;
+        if (pPartialBlock->FillBlock(block, vector<std::shared_ptr<CBaseTx> >()))
+            ProcessReceivedBlock(pFrom, block);
+        else
+            RequestFullBlock(pFrom, hash);
+        return;
+    }
+
+    CBlockTransactionsRequest req;
+    req.blockHash = hash;
+    pPartialBlock->GetMissingIndexes(req.indexes);
+    pFrom->pPartialBlock = pPartialBlock;
+    pFrom->PushMessage(NetMsgType::GETBLOCKTXN, req);
+}
+
+inline void ProcessGetBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactionsRequest req;
+    vRecv >> req;
+
+    CDiskBlockPos pos;
+    {
+        LOCK(cs_main);
+        auto it = mapBlockIndex.find(req.blockHash);
+        if (it == mapBlockIndex.end()) {
+            LogPrint(BCLog::NET, "getblocktxn for unknown block %s from peer %s\n", req.blockHash.ToString(),
+                     pFrom->addr.ToString());
+            return;
+        }
+        pos = it->second->GetBlockPos();
+    }
+
+    CRawBlockCache::RawBlock spBlock = rawBlockCache.Get(req.blockHash, pos);
+    if (!spBlock) {
+        LogPrint(BCLog::NET, "failed to read block %s for getblocktxn\n", req.blockHash.ToString());
+        return;
+    }
+
+    CBlock block;
+    CDataStream(*spBlock) >> block;
+
+    CBlockTransactions resp(req);
+    for (size_t i = 0; i < req.indexes.size(); i++) {
+        if (req.indexes[i] >= block.vptx.size()) {
+            LogPrint(BCLog::INFO, "Misbehaving: getblocktxn index out of range, nMisbehavior add 100\n");
+            Misbehaving(pFrom->GetId(), 100);
+            return;
+        }
+        resp.txs[i] = block.vptx[req.indexes[i]];
+    }
+    pFrom->PushMessage(NetMsgType::BLOCKTXN, resp);
+}
+
+inline void ProcessBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactions resp;
+    vRecv >> resp;
+
+    std::shared_ptr<CPartialBlock> pPartialBlock = pFrom->pPartialBlock;
+    if (!pPartialBlock || pPartialBlock->GetHash() != resp.blockHash) {
+        LogPrint(BCLog::NET, "unexpected blocktxn for block %s from peer %s\n", resp.blockHash.ToString(),
+                 pFrom->addr.ToString());
+        return;
+    }
+    pFrom->pPartialBlock.reset();
+
+    CBlock block;
+    if (!pPartialBlock->FillBlock(block, resp.txs)) {
+        RequestFullBlock(pFrom, resp.blockHash);
+        return;
+    }
+
+    LogPrint(BCLog::NET, "rebuilt block from cmpctblock! time_ms=%lld, hash=%s, missing=%u, peer=%s\n",
+        GetTimeMillis(), resp.blockHash.ToString(), resp.txs.size(), pFrom->addr.ToString());
+    ProcessReceivedBlock(pFrom, block);
+}
+
 inline void ProcessMempoolMessage(CNode *pFrom, CDataStream &vRecv) {
     LOCK2(cs_main, pFrom->cs_filter);
 
@@ -824,42 +1046,63 @@ inline void ProcessFilterAddMessage(CNode *pFrom, CDataStream &vRecv) {
     }
 }
 
-bool ProcessBlockConfirmMessage(CNode *pFrom, CDataStream &vRecv) {
-
-    if(SysCfg().IsReindex()|| GetTime()-chainActive.Tip()->GetBlockTime()>600){
-        LogPrint(BCLog::NET, "local tip's height is too low,drop the confirm message ") ;
-        return false ;
+// Check the pbft messages we haven't seen yet, their signatures are verified in parallel
+template <typename MsgType>
+void CheckNewPBFTMessages(const int32_t msgType, CPBFTMessageMan<MsgType> &msgMan, const vector<MsgType> &msgs,
+                          vector<const MsgType *> &vValid) {
+    vector<const CPBFTMessage *> vNew;
+    for (const auto &message : msgs) {
+        LogPrint(BCLog::NET, "received pbft message: type=%d, blockHeight=%d, blockHash=%s, minerid=%s, signature=%s\n",
+                 msgType, message.height, message.blockHash.GetHex(), message.miner.ToString(),
+                 HexStr<vector<unsigned char>>(message.vSignature));
+
+        if (msgMan.IsKnown(message)) {
+            LogPrint(BCLog::NET, "duplicate pbft message, type=%d, miner_id=%s, blockhash=%s\n", msgType,
+                     message.miner.ToString(), message.blockHash.GetHex());
+            continue;
+        }
+        vNew.push_back(&message);
     }
 
-    CPBFTMessageMan<CBlockConfirmMessage>& msgMan = pbftContext.confirmMessageMan ;
-    CBlockConfirmMessage message ;
-    vRecv >> message;
-
-    LogPrint(BCLog::NET, "received Block confirmedMessage: blockHeight=%d, blockHash=%s, minerid =%s, signature=%s \n",
-             message.height, message.blockHash.GetHex(), message.miner.ToString(), HexStr<vector<unsigned char>>(message.vSignature));
+    vector<bool> results;
+    CheckPBFTMessages(msgType, vNew, results);
+    for (size_t i = 0; i < vNew.size(); i++) {
+        const MsgType &message = static_cast<const MsgType &>(*vNew[i]);
+        if (!results[i]) {
+            LogPrint(BCLog::NET, "pbft message check failed, type=%d, miner_id=%s, blockhash=%s\n", msgType,
+                     message.miner.ToString(), message.blockHash.GetHex());
+            continue;
+        }
+        msgMan.AddMessageKnown(message);
+        vValid.push_back(&message);
+    }
+}
 
-    pFrom->AddBlockConfirmMessageKnown(message) ;
+bool AcceptBlockConfirmMessages(CNode *pFrom, const vector<CBlockConfirmMessage> &msgs) {
 
-    if(msgMan.IsKnown(message)){
-        LogPrint(BCLog::NET, "duplicate confirm message,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
+    if(SysCfg().IsReindex()|| GetTime()-chainActive.Tip()->GetBlockTime()>600){
+        LogPrint(BCLog::NET, "local tip's height is too low,drop the confirm message ") ;
         return false ;
     }
 
-    if(!CheckPBFTMessage(PBFTMsgType::CONFIRM_BLOCK,message)){
-        LogPrint(BCLog::NET, "confirm message check failed,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
-        return false ;
-    }
+    CPBFTMessageMan<CBlockConfirmMessage>& msgMan = pbftContext.confirmMessageMan ;
+    for (const auto &message : msgs)
+        pFrom->AddBlockConfirmMessageKnown(message) ;
 
-    msgMan.AddMessageKnown(message);
-    int messageCount = msgMan.SaveMessageByBlock(message.blockHash, message);
+    vector<const CBlockConfirmMessage *> vValid;
+    CheckNewPBFTMessages(PBFTMsgType::CONFIRM_BLOCK, msgMan, msgs, vValid);
 
     bool updateFinalitySuccess = false ;
-    if(messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-       updateFinalitySuccess = pbftMan.UpdateLocalFinBlock(message) ;
+    vector<CBlockConfirmMessage> vRelay;
+    for (auto pMessage : vValid) {
+        uint32_t messageCount = msgMan.SaveMessageByBlock(*pMessage, pbftContext.GetDelegates(pMessage->preBlockHash));
+        if (messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT && pbftMan.UpdateLocalFinBlock(*pMessage))
+            updateFinalitySuccess = true;
+
+        if (CheckPBFTMessageSignaturer(*pMessage))
+            vRelay.push_back(*pMessage);
     }
-
-    if(CheckPBFTMessageSignaturer(message))
-        RelayBlockConfirmMessage(message) ;
+    RelayBlockConfirmMessages(vRelay);
 
     if(updateFinalitySuccess){
         BroadcastBlockFinality(pbftMan.GetLocalFinIndex());
@@ -868,42 +1111,64 @@ bool ProcessBlockConfirmMessage(CNode *pFrom, CDataStream &vRecv) {
     return true ;
 }
 
-
-bool ProcessBlockFinalityMessage(CNode *pFrom, CDataStream &vRecv) {
-
+bool AcceptBlockFinalityMessages(CNode *pFrom, const vector<CBlockFinalityMessage> &msgs) {
 
     if(SysCfg().IsReindex()|| GetTime()-chainActive.Tip()->GetBlockTime()>600)
         return false ;
 
     CPBFTMessageMan<CBlockFinalityMessage>& msgMan = pbftContext.finalityMessageMan ;
-    CBlockFinalityMessage message ;
-    vRecv >> message;
+    for (const auto &message : msgs)
+        pFrom->AddBlockFinalityMessageKnown(message) ;
 
-    LogPrint(BCLog::NET, "received Block FinalityMessage: blockHeight=%d, blockHash=%s, minerid =%s, signature=%s \n",
-             message.height, message.blockHash.GetHex(), message.miner.ToString(), HexStr<vector<unsigned char>>(message.vSignature));
+    vector<const CBlockFinalityMessage *> vValid;
+    CheckNewPBFTMessages(PBFTMsgType::FINALITY_BLOCK, msgMan, msgs, vValid);
 
-    pFrom->AddBlockFinalityMessageKnown(message) ;
+    vector<CBlockFinalityMessage> vRelay;
+    for (auto pMessage : vValid) {
+        uint32_t messageCount = msgMan.SaveMessageByBlock(*pMessage, pbftContext.GetDelegates(pMessage->preBlockHash));
+        if (messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+            pbftMan.UpdateGlobalFinBlock(*pMessage) ;
 
-    if(msgMan.IsKnown(message)){
-        LogPrint(BCLog::NET, "duplicate finality message,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
-        return false ;
+        if (CheckPBFTMessageSignaturer(*pMessage))
+            vRelay.push_back(*pMessage);
     }
+    RelayBlockFinalityMessages(vRelay);
 
-    if(!CheckPBFTMessage(PBFTMsgType::FINALITY_BLOCK,message)){
-        LogPrint(BCLog::NET, "finality block message check failed,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
-        return false ;
-    }
+    return true ;
+}
 
-    msgMan.AddMessageKnown(message);
-    int messageCount = msgMan.SaveMessageByBlock(message.blockHash, message);
-    if(messageCount>= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-        pbftMan.UpdateGlobalFinBlock(message) ;
+bool ProcessBlockConfirmMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockConfirmMessage message ;
+    vRecv >> message;
+    return AcceptBlockConfirmMessages(pFrom, vector<CBlockConfirmMessage>(1, message));
+}
+
+bool ProcessBlockConfirmMessages(CNode *pFrom, CDataStream &vRecv) {
+    vector<CBlockConfirmMessage> msgs ;
+    vRecv >> msgs;
+    if (msgs.size() > MAX_PBFT_BATCH_SZ) {
+        Misbehaving(pFrom->GetId(), 20);
+        return ERRORMSG("message confirmblks size() = %u from peer %s", msgs.size(), pFrom->addrName);
     }
-    if(CheckPBFTMessageSignaturer(message))
-        RelayBlockFinalityMessage(message) ;
+    return AcceptBlockConfirmMessages(pFrom, msgs);
+}
 
-    return true ;
+bool ProcessBlockFinalityMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockFinalityMessage message ;
+    vRecv >> message;
+    return AcceptBlockFinalityMessages(pFrom, vector<CBlockFinalityMessage>(1, message));
+}
+
+bool ProcessBlockFinalityMessages(CNode *pFrom, CDataStream &vRecv) {
+    vector<CBlockFinalityMessage> msgs ;
+    vRecv >> msgs;
+    if (msgs.size() > MAX_PBFT_BATCH_SZ) {
+        Misbehaving(pFrom->GetId(), 20);
+        return ERRORMSG("message finblocks size() = %u from peer %s", msgs.size(), pFrom->addrName);
+    }
+    return AcceptBlockFinalityMessages(pFrom, msgs);
 }
+
 inline void ProcessRejectMessage(CNode *pFrom, CDataStream &vRecv) {
     if (SysCfg().IsDebug()) {
         string message;
@@ -0,0 +1,139 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "compactblock.h"
+
+#include "commons/random.h"
+#include "crypto/hash.h"
+#include "crypto/siphash.h"
+#include "logging.h"
+#include "tx/txmempool.h"
+
+#include <limits>
+#include <unordered_map>
+
+using namespace std;
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock &block)
+    : nonce(GetRand(numeric_limits<uint64_t>::max())), header(block.GetBlockHeader()) {
+    FillShortTxIDSelector();
+
+    // the block reward and price median txs are made by the producer, no peer has them
+    uint32_t lastPrefilled = 0;
+    for (uint32_t i = 0; i < block.vptx.size(); i++) {
+        const shared_ptr<CBaseTx> &pTx = block.vptx[i];
+        if (pTx->IsBlockRewardTx() || pTx->IsPriceMedianTx()) {
+            prefilledTxs.push_back(CPrefilledTx{i - lastPrefilled, pTx});
+            lastPrefilled = i + 1;
+        } else {
+            shortTxIds.push_back(GetShortID(pTx->GetHash()));
+        }
+    }
+}
+
+void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << header << nonce;
+    uint256 selector = ss.GetHash();
+    shortTxIdK0      = selector.GetUint64(0);
+    shortTxIdK1      = selector.GetUint64(1);
+}
+
+uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256 &txid) const {
+    return SipHashUint256(shortTxIdK0, shortTxIdK1, txid) & 0xffffffffffffL;
+}
+
+bool CPartialBlock::InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, const CTxMemPool &pool) {
+    if (cmpctBlock.BlockTxCount() == 0 || cmpctBlock.BlockTxCount() > MAX_BLOCK_SIZE)
+        return ERRORMSG("CPartialBlock::InitData() : invalid tx count %u", cmpctBlock.BlockTxCount());
+
+    header = cmpctBlock.header;
+    hash   = header.GetHash();
+    vptx.assign(cmpctBlock.BlockTxCount(), nullptr);
+
+    uint32_t lastPrefilled = 0;
+    for (const auto &prefilled : cmpctBlock.prefilledTxs) {
+        uint64_t index = (uint64_t)lastPrefilled + prefilled.index;
+        if (index >= vptx.size() || !prefilled.tx)
+            return ERRORMSG("CPartialBlock::InitData() : invalid prefilled tx index %u", index);
+
+        vptx[index]   = prefilled.tx;
+        lastPrefilled = index + 1;
+    }
+
+    // map the short ids to the slots they fill, a short id seen twice means the block can't be
+    // rebuilt reliably from the mempool, so all its slots are left to be fetched
+    unordered_map<uint64_t, uint32_t> mapShortIdIndex;
+    mapShortIdIndex.reserve(cmpctBlock.shortTxIds.size());
+    vector<bool> vCollided(vptx.size(), false);
+    uint32_t index = 0;
+    for (uint64_t shortId : cmpctBlock.shortTxIds) {
+        while (vptx[index])
+            index++;
+
+        auto ret = mapShortIdIndex.emplace(shortId, index);
+        if (!ret.second)
+            vCollided[ret.first->second] = vCollided[index] = true;
+        index++;
+    }
+
+    {
+        LOCK(pool.cs);
+        for (const auto &item : pool.memPoolTxs) {
+            auto it = mapShortIdIndex.find(cmpctBlock.GetShortID(item.first));
+            if (it == mapShortIdIndex.end() || vCollided[it->second])
+                continue;
+
+            if (vptx[it->second]) {
+                // two mempool txs with the same short id, fetch the one the block has
+                vptx[it->second]      = nullptr;
+                vCollided[it->second] = true;
+                continue;
+            }
+            vptx[it->second] = item.second.GetTransaction();
+        }
+    }
+
+    // the block is going to be connected, don't share the tx objects with the mempool
+    nMissing = 0;
+    for (auto &pTx : vptx) {
+        if (!pTx)
+            nMissing++;
+        else if (!pTx->IsBlockRewardTx() && !pTx->IsPriceMedianTx())
+            pTx = pTx->GetNewInstance();
+    }
+
+    LogPrint(BCLog::NET, "rebuilding block %s from compact block, txs=%u, prefilled=%u, missing=%u\n",
+             hash.ToString(), vptx.size(), cmpctBlock.prefilledTxs.size(), nMissing);
+    return true;
+}
+
+void CPartialBlock::GetMissingIndexes(vector<uint32_t> &indexes) const {
+    indexes.clear();
+    indexes.reserve(nMissing);
+    for (uint32_t i = 0; i < vptx.size(); i++) {
+        if (!vptx[i])
+            indexes.push_back(i);
+    }
+}
+
+bool CPartialBlock::FillBlock(CBlock &block, const vector<shared_ptr<CBaseTx> > &vMissingTx) {
+    if (vMissingTx.size() != nMissing)
+        return ERRORMSG("CPartialBlock::FillBlock() : got %u txs, %u missing", vMissingTx.size(), nMissing);
+
+    block = CBlock(header);
+    block.vptx.reserve(vptx.size());
+    size_t missingIndex = 0;
+    for (const auto &pTx : vptx) {
+        const shared_ptr<CBaseTx> &pFilled = pTx ? pTx : vMissingTx[missingIndex++];
+        if (!pFilled)
+            return ERRORMSG("CPartialBlock::FillBlock() : null tx in block %s", hash.ToString());
+        block.vptx.push_back(pFilled);
+    }
+
+    if (block.BuildMerkleTree() != header.GetMerkleRootHash())
+        return ERRORMSG("CPartialBlock::FillBlock() : merkle root mismatch of block %s", hash.ToString());
+
+    return true;
+}
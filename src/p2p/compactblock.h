@@ -0,0 +1,147 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_COMPACTBLOCK_H
+#define P2P_COMPACTBLOCK_H
+
+#include "commons/serialize.h"
+#include "commons/uint256.h"
+#include "persistence/block.h"
+#include "tx/tx.h"
+
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <vector>
+
+class CTxMemPool;
+
+// bytes of a short txid on the wire
+static const uint32_t SHORTTXIDS_LENGTH = 6;
+
+/**
+ * A transaction sent along with a compact block since the receiver can't have it in its mempool,
+ * i.e. the block reward and price median txs. The index is the difference to the index of the
+ * previous prefilled tx, minus one.
+ */
+class CPrefilledTx {
+public:
+    uint32_t index;
+    std::shared_ptr<CBaseTx> tx;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(VARINT(index));
+        READWRITE(tx);
+    )
+};
+
+/**
+ * The "cmpctblock" message: a block header and, instead of the txs, their short ids which are the
+ * lower 6 bytes of SipHash-2-4(txid) keyed from the header hash and a random nonce, so a receiver
+ * can rebuild the block from its mempool. The nonce differs per block we send out, so a collision
+ * a peer runs into with one sender is unlikely to repeat with the next one.
+ */
+class CBlockHeaderAndShortTxIDs {
+private:
+    mutable uint64_t shortTxIdK0, shortTxIdK1;
+    uint64_t nonce;
+
+    void FillShortTxIDSelector() const;
+
+public:
+    CBlockHeader header;
+    std::vector<uint64_t> shortTxIds;
+    std::vector<CPrefilledTx> prefilledTxs;
+
+    CBlockHeaderAndShortTxIDs() : shortTxIdK0(0), shortTxIdK1(0), nonce(0) {}
+    explicit CBlockHeaderAndShortTxIDs(const CBlock &block);
+
+    uint64_t GetShortID(const uint256 &txid) const;
+    size_t BlockTxCount() const { return shortTxIds.size() + prefilledTxs.size(); }
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(header);
+        READWRITE(nonce);
+
+        std::vector<uint8_t> vBytes;
+        if (fRead) {
+            READWRITE(vBytes);
+            if (vBytes.size() % SHORTTXIDS_LENGTH != 0)
+                throw std::ios_base::failure("CBlockHeaderAndShortTxIDs: bad short txids length");
+
+            CBlockHeaderAndShortTxIDs &us = *(const_cast<CBlockHeaderAndShortTxIDs *>(this));
+            us.shortTxIds.resize(vBytes.size() / SHORTTXIDS_LENGTH);
+            for (size_t i = 0; i < us.shortTxIds.size(); i++) {
+                uint64_t shortId = 0;
+                for (uint32_t b = 0; b < SHORTTXIDS_LENGTH; b++)
+                    shortId |= (uint64_t)vBytes[i * SHORTTXIDS_LENGTH + b] << (8 * b);
+                us.shortTxIds[i] = shortId;
+            }
+            us.FillShortTxIDSelector();
+        } else {
+            vBytes.resize(shortTxIds.size() * SHORTTXIDS_LENGTH);
+            for (size_t i = 0; i < shortTxIds.size(); i++) {
+                for (uint32_t b = 0; b < SHORTTXIDS_LENGTH; b++)
+                    vBytes[i * SHORTTXIDS_LENGTH + b] = (shortTxIds[i] >> (8 * b)) & 0xff;
+            }
+            READWRITE(vBytes);
+        }
+
+        READWRITE(prefilledTxs);
+    )
+};
+
+/** The "getblocktxn" message: the indexes of the txs of a compact block the receiver is missing */
+class CBlockTransactionsRequest {
+public:
+    uint256 blockHash;
+    std::vector<uint32_t> indexes;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(indexes);
+    )
+};
+
+/** The "blocktxn" message: the txs asked for by a "getblocktxn" message, in the same order */
+class CBlockTransactions {
+public:
+    uint256 blockHash;
+    std::vector<std::shared_ptr<CBaseTx> > txs;
+
+    CBlockTransactions() {}
+    CBlockTransactions(const CBlockTransactionsRequest &req) : blockHash(req.blockHash), txs(req.indexes.size()) {}
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(txs);
+    )
+};
+
+/**
+ * A block being rebuilt from a compact block: the prefilled txs and those found in the mempool are
+ * filled in, the rest has to be fetched from the peer with a "getblocktxn" round trip.
+ */
+class CPartialBlock {
+public:
+    CBlockHeader header;
+
+    // returns false if the compact block is malformed
+    bool InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, const CTxMemPool &pool);
+
+    bool IsComplete() const { return nMissing == 0; }
+    uint256 GetHash() const { return hash; }
+    void GetMissingIndexes(std::vector<uint32_t> &indexes) const;
+
+    // fill in the missing txs in the order of GetMissingIndexes(), returns false if they don't
+    // match the count asked for or the merkle root of the result, e.g. on a short id collision
+    bool FillBlock(CBlock &block, const std::vector<std::shared_ptr<CBaseTx> > &vMissingTx);
+
+private:
+    uint256 hash;
+    std::vector<std::shared_ptr<CBaseTx> > vptx;  // nullptr where still missing
+    size_t nMissing = 0;
+};
+
+#endif  // P2P_COMPACTBLOCK_H
@@ -5,6 +5,55 @@
 
 #include "netmessage.h"
 
+CNetBufferPool& GetNetBufferPool() {
+    // never destroyed, messages may still be freed during the static destruction
+    static CNetBufferPool* pPool = new CNetBufferPool();
+    return *pPool;
+}
+
+void CNetBufferPool::Get(CSerializeData& data) {
+    assert(data.empty());
+    LOCK(cs_pool);
+    if (vFree.empty())
+        return;
+
+    nFreeBytes -= vFree.back().capacity();
+    data.swap(vFree.back());
+    vFree.pop_back();
+}
+
+void CNetBufferPool::Put(CSerializeData& data) {
+    size_t nCapacity = data.capacity();
+    if (nCapacity == 0 || nCapacity > MAX_POOLED_NET_BUFFER_SIZE) {
+        CSerializeData().swap(data);
+        return;
+    }
+
+    data.clear();
+    {
+        LOCK(cs_pool);
+        if (nFreeBytes + nCapacity <= MAX_POOLED_NET_BUFFER_BYTES) {
+            nFreeBytes += nCapacity;
+            vFree.emplace_back();
+            vFree.back().swap(data);
+            return;
+        }
+    }
+    CSerializeData().swap(data);
+}
+
+void CNetBufferPool::Get(CDataStream& stream) {
+    CSerializeData data;
+    Get(data);
+    stream.Swap(data);
+}
+
+void CNetBufferPool::Put(CDataStream& stream) {
+    CSerializeData data;
+    stream.Swap(data);
+    Put(data);
+}
+
 int32_t CNetMessage::readHeader(const char* pch, uint32_t nBytes) {
     // copy data to temporary parsing buffer
     uint32_t nRemaining = 24 - nHdrPos;
@@ -30,6 +79,8 @@ int32_t CNetMessage::readHeader(const char* pch, uint32_t nBytes) {
 
     // switch state to reading message data
     in_data = true;
+    if (vRecv.empty())
+        GetNetBufferPool().Get(vRecv);
     vRecv.resize(hdr.nMessageSize);
 
     return nCopy;
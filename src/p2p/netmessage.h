@@ -8,6 +8,37 @@
 
 #include "commons/serialize.h"
 #include "p2p/protocol.h"
+#include "sync.h"
+
+#include <vector>
+
+// Buffers kept for reuse by the pool, in bytes of capacity
+static const size_t MAX_POOLED_NET_BUFFER_BYTES = 16 * 1024 * 1024;
+// Larger buffers, e.g. of blocks, are freed instead of pooled
+static const size_t MAX_POOLED_NET_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Free list of the buffers of network messages. A message buffer freed the usual way is wiped by
+ * zero_after_free_allocator and the next message allocates anew; the payloads of network messages
+ * are public, so their buffers are rather handed on from one message to the next.
+ */
+class CNetBufferPool {
+public:
+    // swap a pooled buffer into the empty data, if there is one
+    void Get(CSerializeData& data);
+    // take the buffer of data, leaving data empty
+    void Put(CSerializeData& data);
+
+    void Get(CDataStream& stream);
+    void Put(CDataStream& stream);
+
+private:
+    CCriticalSection cs_pool;
+    std::vector<CSerializeData> vFree;
+    size_t nFreeBytes = 0;
+};
+
+CNetBufferPool& GetNetBufferPool();
 
 class CNetMessage {
 public:
@@ -17,7 +48,7 @@ public:
     CMessageHeader hdr;  // complete header
     uint32_t nHdrPos;
 
-    CDataStream vRecv;  // received message data
+    CDataStream vRecv;  // received message data, its buffer comes from and goes back to the pool
     uint32_t nDataPos;
 
     CNetMessage(int32_t nTypeIn, int32_t nVersionIn) : hdrbuf(nTypeIn, nVersionIn), vRecv(nTypeIn, nVersionIn) {
@@ -27,12 +58,26 @@ public:
         nDataPos = 0;
     }
 
+    CNetMessage(CNetMessage&&) = default;
+    CNetMessage& operator=(CNetMessage&&) = default;
+
+    ~CNetMessage() { GetNetBufferPool().Put(vRecv); }
+
     bool complete() const {
         if (!in_data)
             return false;
         return (hdr.nMessageSize == nDataPos);
     }
 
+    // bytes of the message data not received yet
+    uint32_t DataRemaining() const { return in_data ? hdr.nMessageSize - nDataPos : 0; }
+
+    // where the message data goes next, DataRemaining() bytes can be received there directly
+    char* DataEnd() { return &vRecv[nDataPos]; }
+
+    // account for nBytes received at DataEnd()
+    void DataReceived(uint32_t nBytes) { nDataPos += nBytes; }
+
     void SetVersion(int32_t nVersionIn) {
         hdrbuf.SetVersion(nVersionIn);
         vRecv.SetVersion(nVersionIn);
@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "netstats.h"
+
+#include "commons/util/time.h"
+#include "p2p/protocol.h"
+
+#include <unordered_map>
+
+using namespace std;
+
+CNetStats netStats;
+
+const vector<string> &GetNetMsgTypes() {
+    static const vector<string> vTypes = {
+        NetMsgType::VERSION,      NetMsgType::VERACK,        NetMsgType::ADDR,           NetMsgType::INV,
+        NetMsgType::GETDATA,      "merkleblock",             NetMsgType::GETBLOCKS,      NetMsgType::GETHEADERS,
+        NetMsgType::TX,           NetMsgType::BLOCK,         NetMsgType::GETADDR,        NetMsgType::MEMPOOL,
+        NetMsgType::PING,         NetMsgType::PONG,          NetMsgType::ALERT,          NetMsgType::FILTERLOAD,
+        NetMsgType::FILTERADD,    NetMsgType::FILTERCLEAR,   NetMsgType::REJECT,         NetMsgType::CONFIRMBLOCK,
+        NetMsgType::FINALITYBLOCK, NetMsgType::CONFIRMBLOCKS, NetMsgType::FINALITYBLOCKS, NetMsgType::CMPCTBLOCK,
+        NetMsgType::GETBLOCKTXN,  NetMsgType::BLOCKTXN,
+    };
+    return vTypes;
+}
+
+size_t GetNetMsgTypeIndex(const string &strCommand) {
+    static const unordered_map<string, size_t> mapTypes = []() {
+        unordered_map<string, size_t> mapTypes;
+        for (size_t i = 0; i < GetNetMsgTypes().size(); i++)
+            mapTypes.emplace(GetNetMsgTypes()[i], i);
+        return mapTypes;
+    }();
+
+    auto it = mapTypes.find(strCommand);
+    return it == mapTypes.end() ? GetNetMsgTypes().size() : it->second;
+}
+
+string GetNetMsgTypeName(size_t nType) {
+    return nType < GetNetMsgTypes().size() ? GetNetMsgTypes()[nType] : "*other*";
+}
+
+CStatsHistogram::CStatsHistogram() : nCount(0), nSum(0) {
+    for (auto &bucket : vBuckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void CStatsHistogram::Add(uint64_t nValue) {
+    size_t k = 0;
+    while (k < STATS_HISTOGRAM_BUCKETS - 1 && (nValue >> k) != 0)
+        k++;
+
+    nCount.fetch_add(1, std::memory_order_relaxed);
+    nSum.fetch_add(nValue, std::memory_order_relaxed);
+    vBuckets[k].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CNetStats::BlockSeen(const uint256 &hash) {
+    LOCK(cs_blockSeen);
+    if (!mapBlockSeen.count(hash))
+        mapBlockSeen.insert(hash, GetTimeMillis());
+}
+
+void CNetStats::BlockConnected(const uint256 &hash) {
+    int64_t nSeen;
+    {
+        LOCK(cs_blockSeen);
+        int64_t *pSeen = mapBlockSeen.find(hash);
+        if (pSeen == nullptr)
+            return;  // mined by us or loaded from disk
+
+        nSeen = *pSeen;
+        mapBlockSeen.erase(hash);
+    }
+    blockPropagation.Add(std::max<int64_t>(0, GetTimeMillis() - nSeen));
+}
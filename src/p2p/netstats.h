@@ -0,0 +1,114 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_NETSTATS_H
+#define P2P_NETSTATS_H
+
+#include "commons/lrucache.h"
+#include "commons/uint256.h"
+#include "sync.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// buckets of a stats histogram, bucket k counts the values below 2^k, the last one the rest
+static const size_t STATS_HISTOGRAM_BUCKETS = 32;
+// blocks whose first sighting is kept until they are connected
+static const size_t MAX_BLOCKS_SEEN = 1000;
+
+/**
+ * The message types counted one by one, in a fixed order; the index of a message type is its
+ * position, unknown commands count as "other" with index GetNetMsgTypes().size().
+ */
+const std::vector<std::string> &GetNetMsgTypes();
+size_t GetNetMsgTypeIndex(const std::string &strCommand);
+std::string GetNetMsgTypeName(size_t nType);
+
+/** Distribution of values over power of two buckets, updated without a lock */
+class CStatsHistogram {
+public:
+    CStatsHistogram();
+
+    void Add(uint64_t nValue);
+
+    uint64_t Count() const { return nCount.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return nSum.load(std::memory_order_relaxed); }
+    uint64_t Bucket(size_t k) const { return vBuckets[k].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> nCount;
+    std::atomic<uint64_t> nSum;
+    std::atomic<uint64_t> vBuckets[STATS_HISTOGRAM_BUCKETS];
+};
+
+/** Counters of one message type, of a single peer or of all peers */
+class CNetMsgTypeStats {
+public:
+    std::atomic<uint64_t> nMsgsRecv{0};
+    std::atomic<uint64_t> nBytesRecv{0};
+    std::atomic<uint64_t> nMsgsSent{0};
+    std::atomic<uint64_t> nBytesSent{0};
+    std::atomic<uint64_t> nProcessTime{0};  // microseconds spent in ProcessMessage()
+};
+
+/** Counters per message type, relaxed atomics so the network threads never wait on them */
+class CNetMsgStats {
+public:
+    CNetMsgStats() : vTypes(GetNetMsgTypes().size() + 1) {}
+
+    void Received(size_t nType, uint64_t nBytes, int64_t nProcessTime) {
+        CNetMsgTypeStats &stats = vTypes[nType];
+        stats.nMsgsRecv.fetch_add(1, std::memory_order_relaxed);
+        stats.nBytesRecv.fetch_add(nBytes, std::memory_order_relaxed);
+        stats.nProcessTime.fetch_add(nProcessTime, std::memory_order_relaxed);
+    }
+
+    void Sent(size_t nType, uint64_t nBytes) {
+        CNetMsgTypeStats &stats = vTypes[nType];
+        stats.nMsgsSent.fetch_add(1, std::memory_order_relaxed);
+        stats.nBytesSent.fetch_add(nBytes, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return vTypes.size(); }
+    const CNetMsgTypeStats &operator[](size_t nType) const { return vTypes[nType]; }
+
+private:
+    std::vector<CNetMsgTypeStats> vTypes;
+};
+
+/**
+ * Network stats of the node as a whole, reported by the getnetstats RPC: the message counters of
+ * all peers, the time ProcessMessage() takes per message type and how long blocks take from the
+ * first time we hear of them until they are connected.
+ */
+class CNetStats {
+public:
+    CNetMsgStats msgs;
+    std::vector<CStatsHistogram> vProcessTime;  // per message type, in microseconds
+    CStatsHistogram blockPropagation;           // in milliseconds
+
+    CNetStats() : vProcessTime(GetNetMsgTypes().size() + 1), mapBlockSeen(MAX_BLOCKS_SEEN) {}
+
+    void Received(size_t nType, uint64_t nBytes, int64_t nProcessTime) {
+        msgs.Received(nType, nBytes, nProcessTime);
+        vProcessTime[nType].Add(nProcessTime);
+    }
+
+    void Sent(size_t nType, uint64_t nBytes) { msgs.Sent(nType, nBytes); }
+
+    // a block was announced or received, only its first sighting counts
+    void BlockSeen(const uint256 &hash);
+    // a block became the tip
+    void BlockConnected(const uint256 &hash);
+
+private:
+    CCriticalSection cs_blockSeen;
+    lrucache<uint256, int64_t> mapBlockSeen;  // time in milliseconds
+};
+
+extern CNetStats netStats;
+
+#endif  // P2P_NETSTATS_H
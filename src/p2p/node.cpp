@@ -8,6 +8,10 @@
 #include "netmessage.h"
 #include <openssl/rand.h>
 
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
 uint64_t CNode::nTotalBytesRecv = 0;
 uint64_t CNode::nTotalBytesSent = 0;
 CCriticalSection CNode::cs_totalBytesRecv;
@@ -24,6 +28,9 @@ NodeId nLastNodeId = 0;
 limitedmap<CInv, int64_t> mapAlreadyAskedFor(MAX_INV_SZ);
 CNode* pnodeSync = nullptr;
 
+// Messages handed to the kernel per send call
+static const size_t MAX_SEND_IOVECS = 64;
+
 
 
 // Requires cs_mapNodeState.
@@ -41,21 +48,49 @@ void CNode::SocketSendData() {
     deque<CSerializeData>::iterator it = vSendMsg.begin();
 
     while (it != vSendMsg.end()) {
-        const CSerializeData& data = *it;
-        assert(data.size() > nSendOffset);
-        int32_t nBytes = send(hSocket, &data[nSendOffset], data.size() - nSendOffset,
-                              MSG_NOSIGNAL | MSG_DONTWAIT);
+        assert(it->size() > nSendOffset);
+        size_t nToSend = 0;
+#ifndef WIN32
+        // hand the queued messages over to the kernel in one call, rather than one call each
+        struct iovec iov[MAX_SEND_IOVECS];
+        size_t nIov    = 0;
+        size_t nOffset = nSendOffset;
+        for (auto itSend = it; itSend != vSendMsg.end() && nIov < MAX_SEND_IOVECS; ++itSend, ++nIov) {
+            iov[nIov].iov_base = &(*itSend)[nOffset];
+            iov[nIov].iov_len  = itSend->size() - nOffset;
+            nToSend += iov[nIov].iov_len;
+            nOffset = 0;
+        }
+        struct msghdr msg = {};
+        msg.msg_iov       = iov;
+        msg.msg_iovlen    = nIov;
+        int32_t nBytes    = sendmsg(hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+        nToSend        = it->size() - nSendOffset;
+        int32_t nBytes = send(hSocket, &(*it)[nSendOffset], nToSend, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
         if (nBytes > 0) {
             nLastSend = GetTime();
             nSendBytes += nBytes;
-            nSendOffset += nBytes;
             RecordBytesSent(nBytes);
-            if (nSendOffset == data.size()) {
+
+            // step over the messages sent in full, their buffers go back to the pool
+            size_t nSent = nBytes;
+            while (nSent > 0) {
+                size_t nLeft = it->size() - nSendOffset;
+                if (nSent < nLeft) {
+                    nSendOffset += nSent;
+                    break;
+                }
+                nSent -= nLeft;
                 nSendOffset = 0;
-                nSendSize -= data.size();
+                nSendSize -= it->size();
+                GetNetBufferPool().Put(*it);
                 it++;
-            } else {
-                // could not send full message; stop sending more
+            }
+
+            if ((size_t)nBytes < nToSend) {
+                // could not send it all; stop sending more
                 break;
             }
         } else {
@@ -77,6 +112,19 @@ void CNode::SocketSendData() {
         assert(nSendSize == 0);
     }
     vSendMsg.erase(vSendMsg.begin(), it);
+    nSendMsgQueued = vSendMsg.size();
+
+#ifdef USE_EPOLL
+    // ask the socket thread to go on only while a send left data behind
+    bool fWantSend = !vSendMsg.empty();
+    if (fWantSend != fSendInterest) {
+        LOCK(cs_hSocket);
+        if (hSocket != INVALID_SOCKET) {
+            fSendInterest = fWantSend;
+            GetSocketEvents().SetSendInterest(this, fWantSend);
+        }
+    }
+#endif
 }
 
 
@@ -117,15 +165,24 @@ CAddress GetLocalAddress(const CNetAddr* paddrPeer) {
 
 void CNode::CloseSocketDisconnect() {
     fDisconnect = true;
-    if (hSocket != INVALID_SOCKET) {
-        LogPrint(BCLog::NET, "disconnecting node %s\n", addrName);
-        closesocket(hSocket);
-        hSocket = INVALID_SOCKET;
+    {
+        LOCK(cs_hSocket);
+        if (hSocket != INVALID_SOCKET) {
+            LogPrint(BCLog::NET, "disconnecting node %s\n", addrName);
+#ifdef USE_EPOLL
+            GetSocketEvents().RemoveNode(this);
+#endif
+            closesocket(hSocket);
+            hSocket = INVALID_SOCKET;
+        }
     }
 
     // in case this fails, we'll empty the recv buffer when the CNode is deleted
     TRY_LOCK(cs_vRecvMsg, lockRecv);
-    if (lockRecv) vRecvMsg.clear();
+    if (lockRecv) {
+        vRecvMsg.clear();
+        nRecvMsgQueued = 0;
+    }
 
     // if this was the sync node, we'll need a new one
     if (this == pnodeSync)
@@ -227,7 +284,7 @@ void CNode::copyStats(CNodeStats& stats) {
 bool CNode::ReceiveMsgBytes(const char* pch, uint32_t nBytes) {
     while (nBytes > 0) {
         // get current incomplete message, or create a new one
-        if (vRecvMsg.empty() || vRecvMsg.back().complete()) vRecvMsg.push_back(CNetMessage(SER_NETWORK, nRecvVersion));
+        if (vRecvMsg.empty() || vRecvMsg.back().complete()) vRecvMsg.emplace_back(SER_NETWORK, nRecvVersion);
 
         CNetMessage& msg = vRecvMsg.back();
 
@@ -245,6 +302,7 @@ bool CNode::ReceiveMsgBytes(const char* pch, uint32_t nBytes) {
         nBytes -= handled;
     }
 
+    nRecvMsgQueued = vRecvMsg.size();
     return true;
 }
 
@@ -17,8 +17,11 @@
 #include "commons/mruset.h"
 #include "commons/random.h"
 #include "p2p/netmessage.h"
+#include "p2p/netstats.h"
+#include "p2p/socketevents.h"
 
 class CNode ;
+class CPartialBlock;
 struct CNodeSignals;
 struct CNodeState ;
 
@@ -38,6 +41,19 @@ static const uint32_t MAX_INV_SZ = 50000;
 static const size_t MAPASKFOR_MAX_SZ = MAX_INV_SZ;
 /** The maximum number of new addresses to accumulate before announcing. */
 static const uint32_t MAX_ADDR_TO_SEND = 1000;
+/** The maximum number of entries in an 'inv' message we send */
+static const uint32_t MAX_INV_SEND_SZ = 1000;
+/** Average time between two flushes of the tx invs queued for an outbound peer (in milliseconds), inbound peers
+ * wait twice as long */
+static const int64_t INVENTORY_BROADCAST_INTERVAL = 500;
+/** The maximum number of tx invs sent to a peer per flush, the rest waits for the next one */
+static const uint32_t INVENTORY_BROADCAST_MAX = 5 * MAX_INV_SEND_SZ;
+/** The maximum number of tx invs queued for a peer, newer ones are dropped while it is full */
+static const uint32_t INVENTORY_TX_QUEUE_MAX = 10 * INVENTORY_BROADCAST_MAX;
+/** The number of recent invs remembered to be known by a peer */
+static const uint32_t INVENTORY_KNOWN_MAX = 50000;
+/** The maximum number of pbft confirm or finality messages in a 'confirmblks' or 'finblocks' message we send */
+static const uint32_t MAX_PBFT_BATCH_SZ = 500;
 
 extern limitedmap<CInv, int64_t> mapAlreadyAskedFor;
 
@@ -135,12 +151,15 @@ public:
     // socket
     uint64_t nServices;
     SOCKET hSocket;
+    CCriticalSection cs_hSocket;  // guards closing hSocket against changing its registration
     CDataStream ssSend;
     size_t nSendSize;    // total size of all vSendMsg entries
     size_t nSendOffset;  // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
     deque<CSerializeData> vSendMsg;
     CCriticalSection cs_vSend;
+    bool fSendInterest;  // writable events wanted for hSocket, requires cs_vSend
+    size_t nSendMsgType;  // GetNetMsgTypeIndex() of the message in ssSend
 
     deque<CInv> vRecvGetData;  // strCommand == "getdata 保存的inv
     deque<CNetMessage> vRecvMsg;
@@ -148,6 +167,11 @@ public:
     uint64_t nRecvBytes;
     int32_t nRecvVersion;
 
+    // for getnetstats, updated by the network threads and read without their locks
+    CNetMsgStats msgStats;
+    std::atomic<uint32_t> nRecvMsgQueued;  // vRecvMsg.size()
+    std::atomic<uint32_t> nSendMsgQueued;  // vSendMsg.size()
+
     int64_t nLastSend;
     int64_t nLastRecv;
     int64_t nLastSendEmpty;
@@ -197,24 +221,33 @@ public:
     // flood relay
     vector<CAddress> vAddrToSend;
     mruset<CAddress> setAddrKnown;
+    CCriticalSection cs_addrKnown;  // guards vAddrToSend and setAddrKnown, peers relay to each other
     bool fGetAddr;
     set<uint256> setKnown;  // alertHash
 
     // inventory based relay
-    mruset<CInv> setInventoryKnown;  //存放已收到的inv
-    vector<CInv> vInventoryToSend;   //待发送的inv
-    std::set<CInv> setForceToSend;   //强制发送的inv
+    CRollingBloomFilter filterInventoryKnown;  // hashes of the recent invs the peer knows
+    vector<CInv> vInventoryToSend;             //待发送的inv
+    vector<uint256> vInventoryTxToSend;        // tx invs batched up until nNextInvSend
+    int64_t nNextInvSend;                      // time of the next flush of vInventoryTxToSend, in milliseconds
+    std::set<CInv> setForceToSend;             //强制发送的inv
 
     CCriticalSection cs_inventory;
     multimap<int64_t, CInv> mapAskFor;  //向网络请求交易的时间, a priority queue
 
 
     mruset<CBlockConfirmMessage> setBlockConfirmMsgKnown ;
+    vector<CBlockConfirmMessage> vBlockConfirmToSend;      // sent in batches by SendMessages
     CCriticalSection cs_blockConfirm ;
 
     mruset<CBlockFinalityMessage> setBlockFinalityMsgKnown ;
+    vector<CBlockFinalityMessage> vBlockFinalityToSend;    // sent in batches by SendMessages
     CCriticalSection cs_blockFinality ;
 
+    // compact block relay
+    bool fCompactBlocks;                           // peer takes cmpctblock, set by version message
+    std::shared_ptr<CPartialBlock> pPartialBlock;  // block being rebuilt, only used by the peer's message handler
+
     // Ping time measurement
     uint64_t nPingNonceSent;
     int64_t nPingUsecStart;
@@ -222,7 +255,8 @@ public:
     bool fPingQueued;
 
     CNode(SOCKET hSocketIn, CAddress addrIn, string addrNameIn = "", bool fInboundIn = false)
-            : ssSend(SER_NETWORK, INIT_PROTO_VERSION), setAddrKnown(5000) {
+            : ssSend(SER_NETWORK, INIT_PROTO_VERSION), setAddrKnown(5000),
+              filterInventoryKnown(INVENTORY_KNOWN_MAX, 0.000001) {
         nServices                = 0;
         hSocket                  = hSocketIn;
         nRecvVersion             = INIT_PROTO_VERSION;
@@ -245,6 +279,10 @@ public:
         nRefCount                = 0;
         nSendSize                = 0;
         nSendOffset              = 0;
+        fSendInterest            = false;
+        nSendMsgType             = 0;
+        nRecvMsgQueued           = 0;
+        nSendMsgQueued           = 0;
         hashContinue             = uint256();
         pIndexLastGetBlocksBegin = 0;
         hashLastGetBlocksEnd     = uint256();
@@ -252,8 +290,10 @@ public:
         fStartSync               = false;
         fGetAddr                 = false;
         fRelayTxes               = false;
-        setInventoryKnown.max_size(SendBufferSize() / 1000);
+        fCompactBlocks           = false;
+        nNextInvSend             = 0;
         setBlockConfirmMsgKnown.max_size(200);
+        setBlockFinalityMsgKnown.max_size(200);
         pFilter        = new CBloomFilter();
         nPingNonceSent = 0;
         nPingUsecStart = 0;
@@ -265,6 +305,11 @@ public:
             id = nLastNodeId++;
         }
 
+#ifdef USE_EPOLL
+        if (hSocket != INVALID_SOCKET)
+            GetSocketEvents().AddNode(this);
+#endif
+
         // Be shy and don't send version until we hear
         if (hSocket != INVALID_SOCKET && !fInbound)
             PushVersion();
@@ -274,6 +319,9 @@ public:
 
     ~CNode() {
         if (hSocket != INVALID_SOCKET) {
+#ifdef USE_EPOLL
+            GetSocketEvents().RemoveNode(this);
+#endif
             closesocket(hSocket);
             hSocket = INVALID_SOCKET;
         }
@@ -332,15 +380,26 @@ public:
 
     void Release() { nRefCount--; }
 
-    void AddAddressKnown(const CAddress& addr) { setAddrKnown.insert(addr); }
+    void AddAddressKnown(const CAddress& addr) {
+        LOCK(cs_addrKnown);
+        setAddrKnown.insert(addr);
+    }
 
-    void AddBlockConfirmMessageKnown(const CBlockConfirmMessage msg){ setBlockConfirmMsgKnown.insert(msg); }
-    void AddBlockFinalityMessageKnown(const CBlockFinalityMessage msg){ setBlockFinalityMsgKnown.insert(msg); }
+    void AddBlockConfirmMessageKnown(const CBlockConfirmMessage& msg) {
+        LOCK(cs_blockConfirm);
+        setBlockConfirmMsgKnown.insert(msg);
+    }
+
+    void AddBlockFinalityMessageKnown(const CBlockFinalityMessage& msg) {
+        LOCK(cs_blockFinality);
+        setBlockFinalityMsgKnown.insert(msg);
+    }
 
     void PushAddress(const CAddress& addr) {
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
+        LOCK(cs_addrKnown);
         if (addr.IsValid() && !setAddrKnown.count(addr)) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand() % vAddrToSend.size()] = addr;
@@ -350,10 +409,11 @@ public:
         }
     }
 
+    // invs are told apart by their hash alone, a tx and a block never share one
     void AddInventoryKnown(const CInv& inv) {
         {
             LOCK(cs_inventory);
-            setInventoryKnown.insert(inv);
+            filterInventoryKnown.insert(inv.hash);
         }
     }
 
@@ -361,20 +421,41 @@ public:
         {
             LOCK(cs_inventory);
 
+            // tx invs are only checked against the known ones when they get flushed
+            if (inv.type == MSG_TX && !forced) {
+                if (vInventoryTxToSend.size() < INVENTORY_TX_QUEUE_MAX)
+                    vInventoryTxToSend.push_back(inv.hash);
+                return;
+            }
+
             if(forced){
                 setForceToSend.insert(inv);
             }
 
-            if (forced || !setInventoryKnown.count(inv))
+            if (forced || !filterInventoryKnown.contains(inv.hash))
                 vInventoryToSend.push_back(inv);
 
         }
     }
 
+    // send the data of inv right away instead of announcing it, unless the peer already knows it
+    template <typename T1>
+    bool PushInventoryData(const CInv& inv, const char* pszCommand, const T1& a1) {
+        {
+            LOCK(cs_inventory);
+            if (filterInventoryKnown.contains(inv.hash))
+                return false;
+            filterInventoryKnown.insert(inv.hash);
+        }
+        PushMessage(pszCommand, a1);
+        return true;
+    }
+
+    // the pbft messages are queued up and go out together on the next SendMessages call
     void PushBlockConfirmMessage(const CBlockConfirmMessage& msg) {
         LOCK(cs_blockConfirm);
         if(!setBlockConfirmMsgKnown.count(msg)){
-            PushMessage(NetMsgType::CONFIRMBLOCK, msg);
+            vBlockConfirmToSend.push_back(msg);
             setBlockConfirmMsgKnown.insert(msg);
         }
     }
@@ -382,7 +463,7 @@ public:
     void PushBlockFinalityMessage(const CBlockFinalityMessage& msg) {
         LOCK(cs_blockFinality);
         if(!setBlockFinalityMsgKnown.count(msg)){
-            PushMessage(NetMsgType::FINALITYBLOCK, msg) ;
+            vBlockFinalityToSend.push_back(msg);
             setBlockFinalityMsgKnown.insert(msg);
         }
     }
@@ -424,6 +505,7 @@ public:
             ENTER_CRITICAL_SECTION(cs_vSend);
             assert(ssSend.size() == 0);
             ssSend << CMessageHeader(pszCommand, 0);
+            nSendMsgType = GetNetMsgTypeIndex(pszCommand);
             LogPrint(BCLog::NET, "sending: %s\n", pszCommand);
     }
 
@@ -465,9 +547,14 @@ public:
 
             LogPrint(BCLog::NET, "(%d bytes)\n", nSize);
 
+            // the message buffer moves over to vSendMsg, ssSend goes on with a pooled one
             deque<CSerializeData>::iterator it = vSendMsg.insert(vSendMsg.end(), CSerializeData());
             ssSend.GetAndClear(*it);
+            GetNetBufferPool().Get(ssSend);
             nSendSize += (*it).size();
+            msgStats.Sent(nSendMsgType, (*it).size());
+            netStats.Sent(nSendMsgType, (*it).size());
+            nSendMsgQueued = vSendMsg.size();
 
             // If write queue empty, attempt "optimistic write"
             if (it == vSendMsg.begin()) SocketSendData();
@@ -72,8 +72,27 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
         ProcessBlockMessage(pFrom, vRecv);
     }
 
+    else if (strCommand == NetMsgType::CMPCTBLOCK &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())
+    {
+        ProcessCompactBlockMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::GETBLOCKTXN) {
+        ProcessGetBlockTxnMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::BLOCKTXN &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())
+    {
+        ProcessBlockTxnMessage(pFrom, vRecv);
+    }
+
     else if (strCommand == NetMsgType::GETADDR) {
-        pFrom->vAddrToSend.clear();
+        {
+            LOCK(pFrom->cs_addrKnown);
+            pFrom->vAddrToSend.clear();
+        }
         vector<CAddress> vAddr = addrman.GetAddr();
         for (const auto &addr : vAddr)
             pFrom->PushAddress(addr);
@@ -133,6 +152,10 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
         ProcessBlockConfirmMessage(pFrom, vRecv) ;
     } else if (strCommand == NetMsgType::FINALITYBLOCK) {
         ProcessBlockFinalityMessage(pFrom, vRecv);
+    } else if (strCommand == NetMsgType::CONFIRMBLOCKS) {
+        ProcessBlockConfirmMessages(pFrom, vRecv);
+    } else if (strCommand == NetMsgType::FINALITYBLOCKS) {
+        ProcessBlockFinalityMessages(pFrom, vRecv);
     }
     else {
         // Ignore unknown commands for extensibility
@@ -225,6 +248,8 @@ bool ProcessMessages(CNode *pFrom) {
         }
 
         // Process message
+        size_t nType          = GetNetMsgTypeIndex(strCommand);
+        int64_t nProcessStart = GetTimeMicros();
         bool fRet = false;
         try {
             fRet = ProcessMessage(pFrom, strCommand, vRecv);
@@ -249,6 +274,10 @@ bool ProcessMessages(CNode *pFrom) {
             PrintExceptionContinue(nullptr, "ProcessMessages()");
         }
 
+        int64_t nProcessTime = GetTimeMicros() - nProcessStart;
+        pFrom->msgStats.Received(nType, nMessageSize + CMessageHeader::HEADER_SIZE, nProcessTime);
+        netStats.Received(nType, nMessageSize + CMessageHeader::HEADER_SIZE, nProcessTime);
+
         if (!fRet)
             LogPrint(BCLog::INFO, "ProcessMessage(%s, %u bytes) FAILED\n", strCommand, nMessageSize);
 
@@ -256,8 +285,10 @@ bool ProcessMessages(CNode *pFrom) {
     }
 
     // In case the connection got shut down, its receive buffer was wiped
-    if (!pFrom->fDisconnect)
+    if (!pFrom->fDisconnect) {
         pFrom->vRecvMsg.erase(pFrom->vRecvMsg.begin(), it);
+        pFrom->nRecvMsgQueued = pFrom->vRecvMsg.size();
+    }
 
     return fOk;
 }
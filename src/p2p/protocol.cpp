@@ -36,12 +36,13 @@ namespace NetMsgType {
     const char *REJECT="reject";
     const char *CONFIRMBLOCK = "confirmblock";
     const char *FINALITYBLOCK = "finblock" ;
+    const char *CONFIRMBLOCKS = "confirmblks";
+    const char *FINALITYBLOCKS = "finblocks";
     // const char *SENDHEADERS="sendheaders";
     // const char *FEEFILTER="feefilter";
-    // const char *SENDCMPCT="sendcmpct";
-    // const char *CMPCTBLOCK="cmpctblock";
-    // const char *GETBLOCKTXN="getblocktxn";
-    // const char *BLOCKTXN="blocktxn";
+    const char *CMPCTBLOCK="cmpctblock";
+    const char *GETBLOCKTXN="getblocktxn";
+    const char *BLOCKTXN="blocktxn";
 } // namespace NetMsgType
 
 static const char* ppszTypeName[] =
@@ -218,17 +218,10 @@ extern const char *SENDHEADERS;
  * @since protocol version 70013 as described by BIP133
  */
 extern const char *FEEFILTER;
-/**
- * Contains a 1-byte bool and 8-byte LE version number.
- * Indicates that a node is willing to provide blocks via "cmpctblock" messages.
- * May indicate that a node prefers to receive new block announcements via a
- * "cmpctblock" message rather than an "inv", depending on message contents.
- * @since protocol version 70014 as described by BIP 152
- */
-extern const char *SENDCMPCT;
 /**
  * Contains a CBlockHeaderAndShortTxIDs object - providing a header and
- * list of "short txids".
+ * list of "short txids". Only sent to peers which announced compact block
+ * support in their version message.
  * @since protocol version 70014 as described by BIP 152
  */
 extern const char *CMPCTBLOCK;
@@ -253,6 +246,14 @@ extern const char *BLOCKTXN;
 extern const char *CONFIRMBLOCK ;
 
 extern const char *FINALITYBLOCK ;
+
+/**
+ * A batch of "confirmblock" or "finblock" messages, sent to peers
+ * starting with PBFT_BATCH_VERSION.
+ */
+extern const char *CONFIRMBLOCKS;
+
+extern const char *FINALITYBLOCKS;
 };
 
 enum PBFTMsgType {
@@ -26,6 +26,24 @@ void MarkBlockAsInFlight(const uint256 &hash, NodeId nodeId) {
     mapBlocksInFlight[hash] = std::make_tuple(nodeId, it, GetTimeMicros());
 }
 
+// Send the queued pbft messages, in batches to the peers which take them. Requires the lock of vToSend.
+template <typename MsgType>
+void PushPBFTMessages(CNode *pTo, vector<MsgType> &vToSend, const char *pszCommand, const char *pszBatchCommand) {
+    if (vToSend.empty())
+        return;
+
+    if (pTo->nVersion < PBFT_BATCH_VERSION) {
+        for (const auto &msg : vToSend)
+            pTo->PushMessage(pszCommand, msg);
+    } else {
+        for (size_t i = 0; i < vToSend.size(); i += MAX_PBFT_BATCH_SZ) {
+            vector<MsgType> vBatch(vToSend.begin() + i, vToSend.begin() + std::min<size_t>(vToSend.size(), i + MAX_PBFT_BATCH_SZ));
+            pTo->PushMessage(pszBatchCommand, vBatch);
+        }
+    }
+    vToSend.clear();
+}
+
 bool SendMessages(CNode *pTo, bool fSendTrickle) {
     {
         // Don't send anything until we get their version message
@@ -68,6 +86,18 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             //LogPrint(BCLog::NET, "send ping: %s\n", DateTimeStrFormat("YYYY-MM-DDTHH-MM-SS", pTo->nPingUsecStart).c_str());
         }
 
+        //
+        // Message: pbft confirm and finality messages
+        //
+        {
+            LOCK(pTo->cs_blockConfirm);
+            PushPBFTMessages(pTo, pTo->vBlockConfirmToSend, NetMsgType::CONFIRMBLOCK, NetMsgType::CONFIRMBLOCKS);
+        }
+        {
+            LOCK(pTo->cs_blockFinality);
+            PushPBFTMessages(pTo, pTo->vBlockFinalityToSend, NetMsgType::FINALITYBLOCK, NetMsgType::FINALITYBLOCKS);
+        }
+
         {
             TRY_LOCK(cs_main, lockMain);  // Acquire cs_main for IsInitialBlockDownload() and CNodeState()
             if (!lockMain)
@@ -76,12 +106,16 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             // Address refresh broadcast
             static int64_t nLastRebroadcast;
             if (!IsInitialBlockDownload() && (GetTime() - nLastRebroadcast > 24 * 60 * 60)) {
-                {
-                    LOCK(cs_vNodes);
+                // pTo->cs_vSend is held here while other threads take cs_vNodes before pushing a
+                // message, so don't wait for it; the rebroadcast is just retried on the next call
+                TRY_LOCK(cs_vNodes, lockNodes);
+                if (lockNodes) {
                     for (auto pNode : vNodes) {
                         // Periodically clear setAddrKnown to allow refresh broadcasts
-                        if (nLastRebroadcast)
+                        if (nLastRebroadcast) {
+                            LOCK(pNode->cs_addrKnown);
                             pNode->setAddrKnown.clear();
+                        }
 
                         // Rebroadcast our address
                         if (!fNoListen) {
@@ -90,14 +124,15 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
                                 pNode->PushAddress(addr);
                         }
                     }
+                    nLastRebroadcast = GetTime();
                 }
-                nLastRebroadcast = GetTime();
             }
 
             //
             // Message: addr
             //
             if (fSendTrickle) {
+                LOCK(pTo->cs_addrKnown);
                 vector<CAddress> vAddr;
                 vAddr.reserve(pTo->vAddrToSend.size());
                 for (const auto &addr : pTo->vAddrToSend) {
@@ -154,49 +189,61 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
         // Message: inventory
         //
         vector<CInv> vInv;
-        vector<CInv> vInvWait;
+        vector<uint256> vTxToSend;
         {
             LOCK(pTo->cs_inventory);
-            vInv.reserve(pTo->vInventoryToSend.size());
-            vInvWait.reserve(pTo->vInventoryToSend.size());
+            vInv.reserve(min<size_t>(pTo->vInventoryToSend.size() + pTo->vInventoryTxToSend.size(), MAX_INV_SEND_SZ));
             for (const auto &inv : pTo->vInventoryToSend) {
-
-                if(pTo->setForceToSend.count(inv)){
-                    pTo->setInventoryKnown.insert(inv);
-                    vInv.push_back(inv);
-                    pTo->setForceToSend.erase(inv);
+                // the forced ones are sent again even though the peer knows them
+                if (!pTo->setForceToSend.erase(inv) && pTo->filterInventoryKnown.contains(inv.hash))
                     continue;
+
+                pTo->filterInventoryKnown.insert(inv.hash);
+                vInv.push_back(inv);
+                if (vInv.size() >= MAX_INV_SEND_SZ) {
+                    pTo->PushMessage(NetMsgType::INV, vInv);
+                    vInv.clear();
                 }
+            }
+            pTo->vInventoryToSend.clear();
 
-                if (pTo->setInventoryKnown.count(inv))
-                    continue;
+            // tx invs are batched up until the flush timer of the peer fires, which saves lots of small
+            // messages under load and, being random, hides which peer a tx was first heard from
+            int64_t nNow = GetTimeMillis();
+            if (!pTo->vInventoryTxToSend.empty() && pTo->nNextInvSend <= nNow) {
+                int64_t nInterval = pTo->fInbound ? 2 * INVENTORY_BROADCAST_INTERVAL : INVENTORY_BROADCAST_INTERVAL;
+                pTo->nNextInvSend = nNow + nInterval / 2 + GetRand(nInterval);
+                vTxToSend.swap(pTo->vInventoryTxToSend);
+            }
+        }
 
-                // trickle out tx inv to protect privacy
-                if (inv.type == MSG_TX && !fSendTrickle) {
-                    // 1/4 of tx invs blast to all immediately
-                    static uint256 hashSalt;
-                    if (hashSalt.IsNull())
-                        hashSalt = GetRandHash();
-                    uint256 hashRand  = ArithToUint256(UintToArith256(inv.hash) ^ UintToArith256(hashSalt));
-                    hashRand          = Hash(BEGIN(hashRand), END(hashRand));
-                    bool fTrickleWait = ((UintToArith256(hashRand) & 3) != 0);
-
-                    if (fTrickleWait) {
-                        vInvWait.push_back(inv);
-                        continue;
-                    }
-                }
+        if (!vTxToSend.empty()) {
+            // the txs mined or evicted while they were queued aren't announced, checked without
+            // cs_inventory since the mempool may relay txs while it holds its lock
+            {
+                LOCK(mempool.cs);
+                vTxToSend.erase(remove_if(vTxToSend.begin(), vTxToSend.end(),
+                                          [](const uint256 &txid) { return !mempool.memPoolTxs.count(txid); }),
+                                vTxToSend.end());
+            }
 
-                // returns true if wasn't already contained in the set
-                if (pTo->setInventoryKnown.insert(inv).second) {
-                    vInv.push_back(inv);
-                    if (vInv.size() >= 1000) {
-                        pTo->PushMessage(NetMsgType::INV, vInv);
-                        vInv.clear();
-                    }
+            LOCK(pTo->cs_inventory);
+            uint32_t nRelayed = 0;
+            auto it           = vTxToSend.begin();
+            for (; it != vTxToSend.end() && nRelayed < INVENTORY_BROADCAST_MAX; ++it) {
+                if (pTo->filterInventoryKnown.contains(*it))
+                    continue;
+
+                pTo->filterInventoryKnown.insert(*it);
+                vInv.push_back(CInv(MSG_TX, *it));
+                nRelayed++;
+                if (vInv.size() >= MAX_INV_SEND_SZ) {
+                    pTo->PushMessage(NetMsgType::INV, vInv);
+                    vInv.clear();
                 }
             }
-            pTo->vInventoryToSend = vInvWait;
+            // the rest goes first next time, ahead of the txs queued meanwhile
+            pTo->vInventoryTxToSend.insert(pTo->vInventoryTxToSend.begin(), it, vTxToSend.end());
         }
         if (!vInv.empty())
             pTo->PushMessage(NetMsgType::INV, vInv);
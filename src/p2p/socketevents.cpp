@@ -0,0 +1,99 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "socketevents.h"
+
+#ifdef USE_EPOLL
+
+#include "logging.h"
+#include "netbase.h"
+#include "p2p/node.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+static const uint32_t NODE_RECV_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET;
+
+CSocketEvents::CSocketEvents() : vReady(256) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        strError = NetworkErrorString(errno);
+        LogPrint(BCLog::ERROR, "CSocketEvents() : epoll_create1 failed: %s\n", strError);
+    }
+}
+
+CSocketEvents::~CSocketEvents() {
+    if (epollFd != -1)
+        close(epollFd);
+}
+
+bool CSocketEvents::AddListenSocket(SOCKET hListenSocket) {
+    struct epoll_event event = {};
+    event.events             = EPOLLIN;
+    event.data.ptr           = nullptr;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, hListenSocket, &event) == -1) {
+        LogPrint(BCLog::ERROR, "AddListenSocket() : epoll_ctl failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    return true;
+}
+
+bool CSocketEvents::AddNode(CNode *pNode) {
+    struct epoll_event event = {};
+    event.events             = NODE_RECV_EVENTS;
+    event.data.ptr           = pNode;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, pNode->hSocket, &event) == -1) {
+        LogPrint(BCLog::ERROR, "AddNode() : epoll_ctl failed for %s: %s\n", pNode->addrName, NetworkErrorString(errno));
+        return false;
+    }
+    return true;
+}
+
+void CSocketEvents::RemoveNode(CNode *pNode) {
+    // closing the socket would be enough, unless a forked child still holds a copy of it
+    if (pNode->hSocket != INVALID_SOCKET)
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, pNode->hSocket, nullptr);
+}
+
+void CSocketEvents::SetSendInterest(CNode *pNode, bool fSend) {
+    struct epoll_event event = {};
+    event.events             = fSend ? (NODE_RECV_EVENTS | EPOLLOUT) : NODE_RECV_EVENTS;
+    event.data.ptr           = pNode;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, pNode->hSocket, &event) == -1)
+        LogPrint(BCLog::NET, "SetSendInterest() : epoll_ctl failed for %s: %s\n", pNode->addrName,
+                 NetworkErrorString(errno));
+}
+
+bool CSocketEvents::Wait(std::vector<Event> &vEvents, int32_t nTimeoutMs) {
+    vEvents.clear();
+    int32_t nReady = epoll_wait(epollFd, vReady.data(), vReady.size(), nTimeoutMs);
+    if (nReady == -1) {
+        if (errno != EINTR) {
+            LogPrint(BCLog::INFO, "socket epoll_wait error %s\n", NetworkErrorString(errno));
+            return false;
+        }
+        return true;
+    }
+
+    for (int32_t i = 0; i < nReady; i++) {
+        const struct epoll_event &ready = vReady[i];
+        Event event;
+        event.pNode = (CNode *)ready.data.ptr;
+        event.fRecv = ready.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR);
+        event.fSend = ready.events & EPOLLOUT;
+        vEvents.push_back(event);
+    }
+
+    // a full batch means there were more, take them in one go next time
+    if ((size_t)nReady == vReady.size())
+        vReady.resize(vReady.size() * 2);
+    return true;
+}
+
+CSocketEvents &GetSocketEvents() {
+    static CSocketEvents socketEvents;
+    return socketEvents;
+}
+
+#endif  // USE_EPOLL
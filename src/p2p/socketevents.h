@@ -0,0 +1,73 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_SOCKETEVENTS_H
+#define P2P_SOCKETEVENTS_H
+
+#include "commons/compat/compat.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#define USE_EPOLL 1
+#endif
+
+#ifdef USE_EPOLL
+
+#include <sys/epoll.h>
+
+class CNode;
+
+/**
+ * Readiness of the p2p sockets for ThreadSocketHandler, backed by an edge triggered epoll set.
+ *
+ * A node socket is registered for reading once, when the node is created, and stays registered
+ * until the socket is closed. Interest in writing is only added while the node has data queued
+ * that a send couldn't get rid of, so an idle connection costs the socket thread nothing and the
+ * number of connections is limited by the process fd limit rather than FD_SETSIZE.
+ *
+ * Being edge triggered, an event is reported once per change of readiness: the socket thread has
+ * to keep the node in its ready set until recv() drains the socket buffer.
+ */
+class CSocketEvents {
+public:
+    struct Event {
+        CNode *pNode;  // nullptr for a listen socket
+        bool fRecv;    // readable, hung up or failed
+        bool fSend;    // writable
+    };
+
+    CSocketEvents();
+    ~CSocketEvents();
+
+    // false if the epoll set couldn't be created, checked once at startup
+    bool IsValid() const { return epollFd != -1; }
+    const std::string &GetError() const { return strError; }
+
+    // listen sockets are level triggered, one connection is accepted per loop
+    bool AddListenSocket(SOCKET hListenSocket);
+    bool AddNode(CNode *pNode);
+    void RemoveNode(CNode *pNode);
+    // requires LOCK(pNode->cs_vSend)
+    void SetSendInterest(CNode *pNode, bool fSend);
+
+    // wait up to nTimeoutMs for events, which replace the content of vEvents
+    bool Wait(std::vector<Event> &vEvents, int32_t nTimeoutMs);
+
+private:
+    int epollFd;
+    std::string strError;
+    std::vector<struct epoll_event> vReady;
+
+    CSocketEvents(const CSocketEvents &);
+    void operator=(const CSocketEvents &);
+};
+
+CSocketEvents &GetSocketEvents();
+
+#endif  // USE_EPOLL
+
+#endif  // P2P_SOCKETEVENTS_H
@@ -185,6 +185,75 @@ bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block) {
     return true;
 }
 
+bool ReadRawBlockFromDisk(const CDiskBlockPos &pos, CDataStream &ssBlock) {
+    ssBlock.clear();
+    if (pos.nPos < MESSAGE_START_SIZE + sizeof(uint32_t))
+        return ERRORMSG("ReadRawBlockFromDisk : invalid block position %d:%u", pos.nFile, pos.nPos);
+
+    // Open history file at the index header written by WriteBlockToDisk()
+    CDiskBlockPos hpos(pos.nFile, pos.nPos - MESSAGE_START_SIZE - sizeof(uint32_t));
+    CAutoFile filein = CAutoFile(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return ERRORMSG("ReadRawBlockFromDisk : OpenBlockFile failed");
+
+    try {
+        char pchMessageStart[MESSAGE_START_SIZE];
+        uint32_t nSize;
+        filein >> FLATDATA(pchMessageStart) >> nSize;
+        if (memcmp(pchMessageStart, SysCfg().MessageStart(), MESSAGE_START_SIZE) != 0)
+            return ERRORMSG("ReadRawBlockFromDisk : no block header at %d:%u", pos.nFile, pos.nPos);
+        if (nSize > MAX_BLOCK_SIZE)
+            return ERRORMSG("ReadRawBlockFromDisk : block at %d:%u is too large (%u)", pos.nFile, pos.nPos, nSize);
+
+        ssBlock.resize(nSize);
+        filein.read(&ssBlock[0], nSize);
+    } catch (std::exception &e) {
+        ssBlock.clear();
+        return ERRORMSG("%s : I/O error - %s", __func__, e.what());
+    }
+
+    return true;
+}
+
+CRawBlockCache rawBlockCache(DEFAULT_BLOCK_SERVE_CACHE_SIZE << 20);
+
+CRawBlockCache::RawBlock CRawBlockCache::Get(const uint256 &hash, const CDiskBlockPos &pos) {
+    {
+        LOCK(cs_cache);
+        RawBlock *pBlock = cache.find(hash);
+        if (pBlock)
+            return *pBlock;
+    }
+
+    auto spBlock = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    if (!ReadRawBlockFromDisk(pos, *spBlock))
+        return nullptr;
+
+    // the header is all it takes to check the bytes are the block asked for
+    try {
+        size_t nSize = spBlock->size();
+        CBlockHeader header;
+        *spBlock >> header;
+        if (header.GetHash() != hash) {
+            LogPrint(BCLog::ERROR, "CRawBlockCache::Get : block at %d:%u isn't %s\n", pos.nFile, pos.nPos, hash.GetHex());
+            return nullptr;
+        }
+        spBlock->Rewind(nSize - spBlock->size());
+    } catch (std::exception &e) {
+        LogPrint(BCLog::ERROR, "CRawBlockCache::Get : Deserialize error - %s\n", e.what());
+        return nullptr;
+    }
+
+    LOCK(cs_cache);
+    cache.insert(hash, spBlock, spBlock->size());
+    return spBlock;
+}
+
+void CRawBlockCache::SetMaxSize(size_t nMaxSize) {
+    LOCK(cs_cache);
+    cache.max_cost(nMaxSize);
+}
+
 bool ReadBaseTxFromDisk(const CTxCord txCord, std::shared_ptr<CBaseTx> &pTx) {
     auto pBlock = std::make_shared<CBlock>();
     const CBlockIndex* pBlockIndex = chainActive[ txCord.GetHeight() ];
@@ -7,6 +7,7 @@
 #define PERSIST_BLOCK_H
 
 #include "commons/base58.h"
+#include "commons/lrucache.h"
 #include "commons/serialize.h"
 #include "commons/uint256.h"
 #include "config/configuration.h"
@@ -468,6 +469,34 @@ struct CBlockLocator {
 bool WriteBlockToDisk(CBlock &block, CDiskBlockPos &pos);
 bool ReadBlockFromDisk(const CDiskBlockPos &pos, CBlock &block);
 bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block);
+/** -blockservecachesize default, in megabytes */
+static const int64_t DEFAULT_BLOCK_SERVE_CACHE_SIZE = 64;
+
+// the block at pos as serialized on disk, which is also its network serialization
+bool ReadRawBlockFromDisk(const CDiskBlockPos &pos, CDataStream &ssBlock);
+
+/**
+ * Recently served blocks in their serialized form. Peers catching up ask several seeds for
+ * the same ranges, so a getdata for a block is answered from here or from the bytes on disk,
+ * without deserializing the block and serializing it again. Thread safe, the disk read is
+ * done outside the lock.
+ */
+class CRawBlockCache {
+public:
+    typedef std::shared_ptr<const CDataStream> RawBlock;
+
+    explicit CRawBlockCache(size_t nMaxSizeIn) : cache(nMaxSizeIn) {}
+
+    // the serialized block, nullptr if it can't be read or isn't the block with the given hash
+    RawBlock Get(const uint256 &hash, const CDiskBlockPos &pos);
+    void SetMaxSize(size_t nMaxSize);
+
+private:
+    CCriticalSection cs_cache;
+    lrucache<uint256, RawBlock> cache;
+};
+
+extern CRawBlockCache rawBlockCache;
 
 
 bool ReadBaseTxFromDisk(const CTxCord txCord, std::shared_ptr<CBaseTx> &pTx);
@@ -16,6 +16,15 @@ std::shared_ptr<CCacheWrapper>CCacheWrapper::NewCopyFrom(CCacheDBManager* pCdMan
     return pNewCopy;
 }
 
+std::shared_ptr<CCacheWrapper> CCacheWrapper::NewReadOnlyCopyFrom(CCacheDBManager* pCdMan) {
+    auto pNewCopy = make_shared<CCacheWrapper>();
+    pNewCopy->CopyDBCachesFrom(pCdMan);
+    pNewCopy->txCache = *pCdMan->pTxCache;
+    // never flushed, so the shared price points are only read
+    pNewCopy->ppCache.SetBaseViewPtr(pCdMan->pPpCache);
+    return pNewCopy;
+}
+
 CCacheWrapper::CCacheWrapper() {}
 
 CCacheWrapper::CCacheWrapper(CCacheWrapper *cwIn) {
@@ -51,6 +60,13 @@ CCacheWrapper::CCacheWrapper(CCacheDBManager* pCdMan) {
 }
 
 void CCacheWrapper::CopyFrom(CCacheDBManager* pCdMan){
+    CopyDBCachesFrom(pCdMan);
+
+    txCache = *pCdMan->pTxCache;
+    ppCache = *pCdMan->pPpCache;
+}
+
+void CCacheWrapper::CopyDBCachesFrom(CCacheDBManager* pCdMan) {
     sysParamCache  = *pCdMan->pSysParamCache;
     blockCache     = *pCdMan->pBlockCache;
     accountCache   = *pCdMan->pAccountCache;
@@ -61,9 +77,6 @@ void CCacheWrapper::CopyFrom(CCacheDBManager* pCdMan){
     closedCdpCache = *pCdMan->pClosedCdpCache;
     dexCache       = *pCdMan->pDexCache;
     txReceiptCache = *pCdMan->pReceiptCache;
-
-    txCache = *pCdMan->pTxCache;
-    ppCache = *pCdMan->pPpCache;
 }
 
 CCacheWrapper& CCacheWrapper::operator=(CCacheWrapper& other) {
@@ -146,6 +159,8 @@ CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
 
     pContractDb     = new CDBAccess(dbDir, DBNameType::CONTRACT, false, fReIndex);
     pContractCache  = new CContractDBCache(pContractDb);
+    pContractCache->SetHotCacheSize(
+        std::max<int64_t>(SysCfg().GetArg("-contractdatacachesize", DEFAULT_CONTRACT_DATA_CACHE_SIZE), 0) << 20);
 
     pDelegateDb     = new CDBAccess(dbDir, DBNameType::DELEGATE, false, fReIndex);
     pDelegateCache  = new CDelegateDBCache(pDelegateDb);
@@ -175,6 +190,48 @@ CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
     pPpCache        = new CPricePointMemCache();
 }
 
+CCacheDBManager::CCacheDBManager(CCacheDBManager *pBaseIn) {
+    pSysParamDb     = new CDBAccess(pBaseIn->pSysParamDb);
+    pSysParamCache  = new CSysParamDBCache(pSysParamDb);
+
+    pAccountDb      = new CDBAccess(pBaseIn->pAccountDb);
+    pAccountCache   = new CAccountDBCache(pAccountDb);
+
+    pAssetDb        = new CDBAccess(pBaseIn->pAssetDb);
+    pAssetCache     = new CAssetDBCache(pAssetDb);
+
+    pContractDb     = new CDBAccess(pBaseIn->pContractDb);
+    pContractCache  = new CContractDBCache(pContractDb);
+
+    pDelegateDb     = new CDBAccess(pBaseIn->pDelegateDb);
+    pDelegateCache  = new CDelegateDBCache(pDelegateDb);
+
+    pCdpDb          = new CDBAccess(pBaseIn->pCdpDb);
+    pCdpCache       = new CCdpDBCache(pCdpDb);
+
+    pClosedCdpDb    = new CDBAccess(pBaseIn->pClosedCdpDb);
+    pClosedCdpCache = new CClosedCdpDBCache(pClosedCdpDb);
+
+    pDexDb          = new CDBAccess(pBaseIn->pDexDb);
+    pDexCache       = new CDexDBCache(pDexDb);
+
+    pBlockIndexDb   = nullptr;
+
+    pBlockDb        = new CDBAccess(pBaseIn->pBlockDb);
+    pBlockCache     = new CBlockDBCache(pBlockDb);
+
+    pLogDb          = new CDBAccess(pBaseIn->pLogDb);
+    pLogCache       = new CLogDBCache(pLogDb);
+
+    pReceiptDb      = new CDBAccess(pBaseIn->pReceiptDb);
+    pReceiptCache   = new CTxReceiptDBCache(pReceiptDb);
+
+    // memory-only cache
+    pTxCache        = new CTxMemCache();
+    pPpCache        = new CPricePointMemCache();
+    *pPpCache       = *pBaseIn->pPpCache;
+}
+
 CCacheDBManager::~CCacheDBManager() {
     delete pSysParamCache;  pSysParamCache = nullptr;
     delete pAccountCache;   pAccountCache = nullptr;
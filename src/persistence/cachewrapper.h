@@ -39,6 +39,8 @@ public:
     CPricePointMemCache ppCache;
 public:
     static std::shared_ptr<CCacheWrapper> NewCopyFrom(CCacheDBManager* pCdMan);
+    // copy for a reader of the read-only pCdMan, its price points are read through instead of copied
+    static std::shared_ptr<CCacheWrapper> NewReadOnlyCopyFrom(CCacheDBManager* pCdMan);
 public:
     CCacheWrapper();
 
@@ -55,6 +57,8 @@ public:
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap);
 private:
+    void CopyDBCachesFrom(CCacheDBManager* pCdMan);
+
     CCacheWrapper(const CCacheWrapper&) = delete;
     CCacheWrapper& operator=(const CCacheWrapper&) = delete;
 
@@ -102,6 +106,9 @@ public:
 
 public:
     CCacheDBManager(bool fReIndex, bool fMemory);
+    // read-only copy of the current state of pBaseIn, with the dbs read through snapshots.
+    // The tx memory cache is left empty and the block index db is not opened.
+    explicit CCacheDBManager(CCacheDBManager *pBaseIn);
 
     ~CCacheDBManager();
 
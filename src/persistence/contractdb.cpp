@@ -12,6 +12,7 @@
 #include "entities/key.h"
 #include "commons/uint256.h"
 #include "commons/util/util.h"
+#include "crypto/hash.h"
 #include "vm/luavm/luavmrunenv.h"
 
 #include <stdint.h>
@@ -43,7 +44,21 @@ bool CContractDBCache::GetContracts(map<CRegIDKey, CUniversalContract> &contract
 }
 
 bool CContractDBCache::SaveContract(const CRegID &contractRegId, const CUniversalContract &contract) {
-    return contractCache.SetData(contractRegId, contract);
+    return contractCache.SetData(contractRegId, contract) &&
+           contractCodeHashCache.SetData(contractRegId, Hash(contract.code.begin(), contract.code.end()));
+}
+
+bool CContractDBCache::GetContractCodeHash(const CRegID &contractRegId, uint256 &codeHash) {
+    if (contractCodeHashCache.GetData(contractRegId, codeHash))
+        return true;
+
+    // contracts saved before the code hash was persisted
+    CUniversalContract contract;
+    if (!contractCache.GetData(contractRegId, contract))
+        return false;
+
+    codeHash = Hash(contract.code.begin(), contract.code.end());
+    return true;
 }
 
 bool CContractDBCache::HaveContract(const CRegID &contractRegId) {
@@ -51,6 +66,7 @@ bool CContractDBCache::HaveContract(const CRegID &contractRegId) {
 }
 
 bool CContractDBCache::EraseContract(const CRegID &contractRegId) {
+    contractCodeHashCache.EraseData(contractRegId);
     return contractCache.EraseData(contractRegId);
 }
 
@@ -89,6 +105,7 @@ bool CContractDBCache::Flush() {
     contractDataCache.Flush();
     contractAccountCache.Flush();
     contractTracesCache.Flush();
+    contractCodeHashCache.Flush();
 
     return true;
 }
@@ -96,7 +113,8 @@ bool CContractDBCache::Flush() {
 uint32_t CContractDBCache::GetCacheSize() const {
     return contractCache.GetCacheSize() +
         contractDataCache.GetCacheSize() +
-        contractTracesCache.GetCacheSize();
+        contractTracesCache.GetCacheSize() +
+        contractCodeHashCache.GetCacheSize();
 }
 
 
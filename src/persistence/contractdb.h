@@ -55,11 +55,23 @@ public:
         return sp_it_Impl->SeekUpper(&lastKey);
     }
 
+    bool SeekLower(const string *pContractKey) {
+        if (pContractKey == nullptr || db_util::IsEmpty(*pContractKey))
+            return First();
+        if (pContractKey->size() > CDBContractKey::MAX_KEY_SIZE)
+            return false;
+        KeyType key(GetPrefixElement().first, *pContractKey);
+        return sp_it_Impl->SeekLower(&key);
+    }
+
     const string& GetContractKey() const {
         return GetKey().second.GetKey();
     }
 };
 
+/** -contractdatacachesize default (MiB) */
+static const int64_t DEFAULT_CONTRACT_DATA_CACHE_SIZE = 32;
+
 class CContractDBCache {
 public:
     CContractDBCache() {}
@@ -68,7 +80,8 @@ public:
         contractCache(pDbAccess),
         contractDataCache(pDbAccess),
         contractAccountCache(pDbAccess),
-        contractTracesCache(pDbAccess) {
+        contractTracesCache(pDbAccess),
+        contractCodeHashCache(pDbAccess) {
         assert(pDbAccess->GetDbNameType() == DBNameType::CONTRACT);
     };
 
@@ -76,7 +89,8 @@ public:
         contractCache(pBaseIn->contractCache),
         contractDataCache(pBaseIn->contractDataCache),
         contractAccountCache(pBaseIn->contractAccountCache),
-        contractTracesCache(pBaseIn->contractTracesCache) {};
+        contractTracesCache(pBaseIn->contractTracesCache),
+        contractCodeHashCache(pBaseIn->contractCodeHashCache) {};
 
     bool GetContractAccount(const CRegID &contractRegId, const string &accountKey, CAppUserAccount &appAccOut);
     bool SetContractAccount(const CRegID &contractRegId, const CAppUserAccount &appAccIn);
@@ -84,6 +98,9 @@ public:
     bool GetContract(const CRegID &contractRegId, CUniversalContract &contract);
     bool GetContracts(map<CRegIDKey, CUniversalContract> &contracts);
     bool SaveContract(const CRegID &contractRegId, const CUniversalContract &contract);
+    // hash of the contract code, saved together with the contract so VMs can key their caches by it
+    // without loading the code
+    bool GetContractCodeHash(const CRegID &contractRegId, uint256 &codeHash);
     bool HaveContract(const CRegID &contractRegId);
     bool EraseContract(const CRegID &contractRegId);
 
@@ -98,11 +115,18 @@ public:
     bool Flush();
     uint32_t GetCacheSize() const;
 
+    // keep hot contract data and contract accounts in memory across flushes of the db layer
+    void SetHotCacheSize(size_t maxBytes) {
+        contractDataCache.SetHotCacheSize(maxBytes * 3 / 4);
+        contractAccountCache.SetHotCacheSize(maxBytes / 4);
+    }
+
     void SetBaseViewPtr(CContractDBCache *pBaseIn) {
         contractCache.SetBase(&pBaseIn->contractCache);
         contractDataCache.SetBase(&pBaseIn->contractDataCache);
         contractAccountCache.SetBase(&pBaseIn->contractAccountCache);
         contractTracesCache.SetBase(&pBaseIn->contractTracesCache);
+        contractCodeHashCache.SetBase(&pBaseIn->contractCodeHashCache);
     };
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
@@ -110,6 +134,7 @@ public:
         contractDataCache.SetDbOpLogMap(pDbOpLogMapIn);
         contractAccountCache.SetDbOpLogMap(pDbOpLogMapIn);
         contractTracesCache.SetDbOpLogMap(pDbOpLogMapIn);
+        contractCodeHashCache.SetDbOpLogMap(pDbOpLogMapIn);
     }
 
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
@@ -117,6 +142,7 @@ public:
         contractDataCache.RegisterUndoFunc(undoDataFuncMap);
         contractAccountCache.RegisterUndoFunc(undoDataFuncMap);
         contractTracesCache.RegisterUndoFunc(undoDataFuncMap);
+        contractCodeHashCache.RegisterUndoFunc(undoDataFuncMap);
     }
 
     shared_ptr<CDBContractDataIterator> CreateContractDataIterator(const CRegID &contractRegid,
@@ -135,6 +161,8 @@ private:
     CCompositeKVCache< dbk::CONTRACT_ACCOUNT,     pair<CRegIDKey, string>,     CAppUserAccount >      contractAccountCache;
     // txid -> contract_traces
     CCompositeKVCache< dbk::CONTRACT_ACCOUNT,     uint256,                  string >      contractTracesCache;
+    // contract $RegIdKey -> hash of contract code
+    CCompositeKVCache< dbk::CONTRACT_CODE_HASH,   CRegIDKey,                   uint256 >              contractCodeHashCache;
 };
 
 #endif  // PERSIST_CONTRACTDB_H
\ No newline at end of file
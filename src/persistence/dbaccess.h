@@ -6,10 +6,13 @@
 #ifndef PERSIST_DB_ACCESS_H
 #define PERSIST_DB_ACCESS_H
 
+#include "commons/lrucache.h"
 #include "commons/uint256.h"
 #include "dbconf.h"
 #include "leveldbwrapper.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -153,6 +156,8 @@ public:
     CDBAccess(const boost::filesystem::path& dir, DBNameType dbNameTypeIn, bool fMemory, bool fWipe) :
               dbNameType(dbNameTypeIn),
               db( dir / ::GetDbName(dbNameTypeIn), DBCacheSize[dbNameTypeIn], fMemory, fWipe ) {}
+    // read-only snapshot of the current data of pBaseIn, which must outlive it
+    explicit CDBAccess(CDBAccess *pBaseIn) : dbNameType(pBaseIn->dbNameType), db(&pBaseIn->db) {}
 
     int64_t GetDbCount() const { return db.GetDbCount(); }
     template<typename KeyType, typename ValueType>
@@ -370,6 +375,71 @@ private:
     mutable CLevelDBWrapper db; // // TODO: remove the mutable declare
 };
 
+/**
+ * Read cache below the bottom CCompositeKVCache layer. The bottom layer drops all its
+ * data when it is flushed, this one keeps the frequently read db values (and misses)
+ * across flushes. A key is only admitted when it is read from the db again while it is
+ * still among the recent candidates, so one-off reads and scans don't evict hot keys.
+ * Flushes write through it, so it never serves a value older than the db. A value read
+ * from the db is only admitted if no flush happened since the read started, see
+ * GetGeneration().
+ */
+template<typename KeyType, typename ValueType>
+class CDBHotCache {
+public:
+    static const size_t MAX_CANDIDATES = 64 * 1024;
+
+    explicit CDBHotCache(size_t maxBytes): entries(maxBytes), candidates(MAX_CANDIDATES), generation(0) {}
+
+    /** taken before a db read, a flush in between makes Admit drop the value read */
+    uint64_t GetGeneration() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return generation;
+    }
+
+    /** an empty value means the key is known not to be in the db */
+    bool Get(const KeyType &key, ValueType &value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const ValueType *pValue = entries.find(key);
+        if (pValue == nullptr)
+            return false;
+        value = *pValue;
+        return true;
+    }
+
+    void Admit(const KeyType &key, const ValueType &value, uint64_t readGeneration) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (readGeneration != generation)
+            return;  // the value may be older than the one the flush wrote
+        if (!candidates.erase(key)) {
+            candidates.insert(key, true);
+            return;
+        }
+        entries.insert(key, value, Cost(key, value));
+    }
+
+    void Update(const map<KeyType, ValueType> &mapData) {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        for (const auto &item : mapData) {
+            if (entries.count(item.first))
+                entries.insert(item.first, item.second, Cost(item.first, item.second));
+        }
+    }
+
+private:
+    std::mutex mutex;
+    lrucache<KeyType, ValueType> entries;
+    lrucache<KeyType, bool> candidates;
+    uint64_t generation;
+
+    static size_t Cost(const KeyType &key, const ValueType &value) {
+        // serialized size plus a rough per entry overhead of the list and map nodes
+        return ::GetSerializeSize(key, SER_DISK, CLIENT_VERSION) +
+               ::GetSerializeSize(value, SER_DISK, CLIENT_VERSION) + 128;
+    }
+};
+
 template<int32_t PREFIX_TYPE_VALUE, typename __KeyType, typename __ValueType>
 class CCompositeKVCache {
 public:
@@ -407,6 +477,15 @@ public:
         pDbOpLogMap = pDbOpLogMapIn;
     }
 
+    /** Keep hot db values across flushes, only for the bottom layer. 0 disables it. */
+    void SetHotCacheSize(size_t maxBytes) {
+        assert(pDbAccess != nullptr);
+        if (maxBytes > 0)
+            pHotCache = std::make_shared<CDBHotCache<KeyType, ValueType>>(maxBytes);
+        else
+            pHotCache = nullptr;
+    }
+
     bool IsCalcSize() const { return is_calc_size; }
 
     uint32_t GetCacheSize() const {
@@ -520,6 +599,8 @@ public:
         } else if (pDbAccess != nullptr) {
             assert(pBase == nullptr);
             pDbAccess->BatchWrite<KeyType, ValueType>(PREFIX_TYPE, mapData);
+            if (pHotCache)
+                pHotCache->Update(mapData);
         }
 
         Clear();
@@ -576,9 +657,19 @@ private:
         } else if (pDbAccess != NULL) {
             // TODO: need to save the empty value to mapData for search performance?
             auto pDbValue = db_util::MakeEmptyValue<ValueType>();
+            if (pHotCache && pHotCache->Get(key, *pDbValue)) {
+                if (!db_util::IsEmpty(*pDbValue))
+                    return AddDataToMap(key, *pDbValue);
+                return mapData.end();
+            }
+            uint64_t readGeneration = pHotCache ? pHotCache->GetGeneration() : 0;
             if (pDbAccess->GetData(PREFIX_TYPE, key, *pDbValue)) {
+                if (pHotCache)
+                    pHotCache->Admit(key, *pDbValue, readGeneration);
                 return AddDataToMap(key, *pDbValue);
             }
+            if (pHotCache)
+                pHotCache->Admit(key, *db_util::MakeEmptyValue<ValueType>(), readGeneration);
         }
 
         return mapData.end();
@@ -720,6 +811,7 @@ private:
     CDBOpLogMap *pDbOpLogMap = nullptr;
     bool is_calc_size = false;
     mutable uint32_t size = 0;
+    std::shared_ptr<CDBHotCache<KeyType, ValueType>> pHotCache;
 };
 
 
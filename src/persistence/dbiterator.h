@@ -30,6 +30,9 @@ public:
 
     virtual bool SeekUpper(const KeyType *pKey) = 0;
 
+    // seek to the first key not less than *pKey
+    virtual bool SeekLower(const KeyType *pKey) = 0;
+
     virtual bool Next() = 0;
 
     virtual bool IsValid() const {
@@ -79,6 +82,13 @@ public:
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey) {
+        if (pKey == nullptr || db_util::IsEmpty(*pKey))
+            return First();
+        p_db_it->Seek(dbk::GenDbKey(CacheType::PREFIX_TYPE, *pKey));
+        return ProcessData();
+    }
+
     bool Next() {
         p_db_it->Next();
         return ProcessData();
@@ -130,6 +140,13 @@ public:
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey) {
+        if (pKey == nullptr || db_util::IsEmpty(*pKey))
+            return First();
+        map_it = this->db_cache.GetMapData().lower_bound(*pKey);
+        return ProcessData();
+    }
+
     bool Next() {
         assert(this->IsValid());
         map_it++;
@@ -185,6 +202,14 @@ public:
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey) {
+        if (pKey == nullptr || db_util::IsEmpty(*pKey))
+            return First();
+        sp_map_it->SeekLower(pKey);
+        sp_base_it->SeekLower(pKey);
+        return ProcessData();
+    }
+
     const KeyType& GetKey() {
         assert(this->is_valid);
         return *this->sp_key;
@@ -285,6 +310,10 @@ public:
         return sp_it_Impl->SeekUpper(pKey);
     }
 
+    virtual bool SeekLower(const KeyType *pKey) {
+        return sp_it_Impl->SeekLower(pKey);
+    }
+
     virtual bool Next() {
         return sp_it_Impl->Next();
     }
@@ -406,6 +435,12 @@ public:
         return this->sp_it_Impl->SeekUpper(pKey);
     }
 
+    virtual bool SeekLower(const KeyType *pKey) {
+        if (pKey == nullptr || db_util::IsEmpty(*pKey))
+            return First();
+        return this->sp_it_Impl->SeekLower(pKey);
+    }
+
     virtual bool IsValid() const {
         return Base::IsValid() && PrefixMatcher::MatchPrefix(this->GetKey(), prefix_element);
     }
@@ -52,6 +52,7 @@ static leveldb::Options GetOptions(size_t nCacheSize) {
 
 CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, size_t nCacheSize, bool fMemory, bool fWipe) {
     penv                         = nullptr;
+    pSnapshot                    = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache       = false;
@@ -74,7 +75,25 @@ CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, size_t nCa
     LogPrint(BCLog::INFO, "Opened LevelDB successfully\n");
 }
 
+CLevelDBWrapper::CLevelDBWrapper(CLevelDBWrapper *pBase) {
+    penv                 = nullptr;
+    readoptions          = pBase->readoptions;
+    iteroptions          = pBase->iteroptions;
+    pdb                  = pBase->pdb;
+    pSnapshot            = pdb->GetSnapshot();
+    readoptions.snapshot = pSnapshot;
+    iteroptions.snapshot = pSnapshot;
+}
+
 CLevelDBWrapper::~CLevelDBWrapper() {
+    if (pSnapshot != nullptr) {
+        // the db belongs to the base wrapper
+        pdb->ReleaseSnapshot(pSnapshot);
+        pSnapshot = nullptr;
+        pdb       = nullptr;
+        return;
+    }
+
     delete pdb;
     pdb = nullptr;
     delete options.filter_policy;
@@ -86,6 +105,7 @@ CLevelDBWrapper::~CLevelDBWrapper() {
 }
 
 bool CLevelDBWrapper::WriteBatch(CLevelDBBatch &batch, bool fSync) {
+    assert(pSnapshot == nullptr);
     leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
     ThrowError(status);
     return true;
@@ -169,8 +169,13 @@ private:
     // the database itself
     leveldb::DB *pdb;
 
+    // the state all reads see, only set in read-only views of another wrapper
+    const leveldb::Snapshot *pSnapshot;
+
 public:
     CLevelDBWrapper(const boost::filesystem::path &path, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    // read-only view of the current state of pBase, which must outlive it
+    explicit CLevelDBWrapper(CLevelDBWrapper *pBase);
     ~CLevelDBWrapper();
 
     template<typename V>
@@ -104,10 +104,10 @@ public:
     /** Precondition: worker threads have all stopped (they have been joined).
      */
     ~WorkQueue() {}
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item) {
+    /** Enqueue a work item, unless fewer than nKeepFree more would fit afterwards */
+    bool Enqueue(WorkItem* item, size_t nKeepFree = 0) {
         STD_LOCK(cs);
-        if (queue.size() >= maxDepth) {
+        if (queue.size() + nKeepFree >= maxDepth) {
             return false;
         }
         queue.emplace_back(std::unique_ptr<WorkItem>(item));
@@ -292,6 +292,14 @@ static void http_request_cb(struct evhttp_request* req, void* arg) {
     }
 }
 
+bool EnqueueHTTPWork(std::unique_ptr<HTTPClosure>& item, size_t nKeepFree) {
+    if (!workQueue || !workQueue->Enqueue(item.get(), nKeepFree))
+        return false;
+
+    item.release(); /* queue took ownership */
+    return true;
+}
+
 /** Callback to reject HTTP requests after shutdown. */
 static void http_reject_request_cb(struct evhttp_request* req, void*) {
     LogPrint(BCLog::RPC, "Rejecting request while shutting down\n");
@@ -517,12 +525,16 @@ void HTTPEvent::trigger(struct timeval* tv) {
         evtimer_add(ev, tv);  // trigger after timeval passed
 }
 
-HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req), replySent(false) {
+HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req), replySent(false), chunkedReplyStarted(false) {
 
 }
 
 HTTPRequest::~HTTPRequest() {
-    if (!replySent) {
+    if (!replySent && chunkedReplyStarted) {
+        // A chunked reply can only be cut short
+        LogPrint(BCLog::ERROR, "%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrint(BCLog::ERROR, "%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -570,7 +582,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  * this cannot be done from worker threads.
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
-    assert(!replySent && req);
+    assert(!replySent && !chunkedReplyStarted && req);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -598,6 +610,55 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
     req       = nullptr;  // transferred back to main thread
 }
 
+/** Each chunk is moved to the main http thread in its own buffer, the events are
+ * handled there in the order they were triggered.
+ */
+void HTTPRequest::WriteReplyChunk(int nStatus, const std::string& strChunk) {
+    assert(!replySent && req);
+    if (!chunkedReplyStarted) {
+        if (ShutdownRequested()) {
+            WriteHeader("Connection", "close");
+        }
+        auto req_copy = req;
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
+            evhttp_send_reply_start(req_copy, nStatus, nullptr);
+        });
+        ev->trigger(nullptr);
+        chunkedReplyStarted = true;
+    }
+
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb] {
+        evhttp_send_reply_chunk(req_copy, evb);
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::EndChunkedReply() {
+    assert(!replySent && chunkedReplyStarted && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy] {
+        evhttp_send_reply_end(req_copy);
+        // Re-enable reading from the socket, see WriteReply.
+        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+            if (conn) {
+                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+                if (bev) {
+                    bufferevent_enable(bev, EV_READ | EV_WRITE);
+                }
+            }
+        }
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req       = nullptr;  // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer() const {
     evhttp_connection* con = evhttp_request_get_connection(req);
     CService peer;
@@ -8,6 +8,7 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int32_t DEFAULT_HTTP_THREADS        = 4;
 static const int32_t DEFAULT_HTTP_WORKQUEUE      = 16;
@@ -17,6 +18,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+class HTTPClosure;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -46,6 +48,12 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Queue a closure to run on an HTTP worker thread, e.g. to spread the work of one request.
+ * Returns false if the work queue is full, counting nKeepFree slots left to the incoming
+ * requests, or the server is not running, the caller keeps the ownership of the item then.
+ */
+bool EnqueueHTTPWork(std::unique_ptr<HTTPClosure>& item, size_t nKeepFree = 0);
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -59,6 +67,7 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool chunkedReplyStarted;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -114,6 +123,21 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Write a piece of the HTTP reply body, the reply is sent with chunked transfer encoding.
+     * nStatus and the headers are sent along with the first piece.
+     *
+     * @note Once a chunk was written, finish the reply with EndChunkedReply instead of WriteReply.
+     */
+    void WriteReplyChunk(int nStatus, const std::string& strChunk);
+
+    /**
+     * Finish a reply started with WriteReplyChunk.
+     *
+     * @note Like WriteReply, do not call any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
 };
 
 /** Event handler closure.
@@ -0,0 +1,140 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "jsonwriter.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cwctype>
+
+using namespace json_spirit;
+
+static const char HEX_CHARS[] = "0123456789ABCDEF";
+
+// chars json_spirit writes as they are without looking at the locale
+static inline bool IsPlainChar(char c) { return c >= 0x20 && c < 0x7f && c != '"' && c != '\\'; }
+
+CJSONWriter::CJSONWriter(size_t flushSizeIn, const FlushFunc &flushFuncIn)
+    : flushSize(flushSizeIn), flushFunc(flushFuncIn), flushed(false) {
+    if (flushFunc)
+        buffer.reserve(flushSize + flushSize / 4);
+}
+
+void CJSONWriter::Write(const Value &value) {
+    switch (value.type()) {
+        case obj_type:   WriteObject(value.get_obj());                    break;
+        case array_type: WriteArray(value.get_array());                   break;
+        case str_type:   WriteString(value.get_str());                    break;
+        case bool_type:  value.get_bool() ? Append("true", 4) : Append("false", 5); break;
+        case int_type:   WriteInt(value);                                 break;
+        case real_type:  WriteReal(value.get_real());                     break;
+        case null_type:  Append("null", 4);                               break;
+        default: assert(false);
+    }
+}
+
+void CJSONWriter::WriteRaw(const char *str, size_t len) {
+    Append(str, len);
+    CheckFlush();
+}
+
+void CJSONWriter::Flush() {
+    if (!flushFunc || buffer.empty())
+        return;
+
+    flushFunc(buffer);
+    buffer.clear();
+    flushed = true;
+}
+
+// same escaping as json_spirit::add_esc_chars()
+void CJSONWriter::WriteString(const std::string &str) {
+    Append('"');
+    const char *begin = str.data();
+    const char *end   = begin + str.size();
+    const char *plain = begin;
+    for (const char *p = begin; p != end; ++p) {
+        if (IsPlainChar(*p))
+            continue;
+
+        Append(plain, p - plain);
+        plain = p + 1;
+        switch (*p) {
+            case '"':  Append("\\\"", 2); continue;
+            case '\\': Append("\\\\", 2); continue;
+            case '\b': Append("\\b", 2);  continue;
+            case '\f': Append("\\f", 2);  continue;
+            case '\n': Append("\\n", 2);  continue;
+            case '\r': Append("\\r", 2);  continue;
+            case '\t': Append("\\t", 2);  continue;
+        }
+
+        const wint_t c = (uint8_t)*p;
+        if (iswprint(c)) {
+            Append(*p);
+        } else {
+            char esc[6] = {'\\', 'u', HEX_CHARS[(c >> 12) & 0xF], HEX_CHARS[(c >> 8) & 0xF],
+                           HEX_CHARS[(c >> 4) & 0xF], HEX_CHARS[c & 0xF]};
+            Append(esc, sizeof(esc));
+        }
+    }
+    Append(plain, end - plain);
+    Append('"');
+}
+
+void CJSONWriter::WriteInt(const Value &value) {
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *p   = end;
+    bool negative = false;
+    uint64_t n;
+    if (value.is_uint64()) {
+        n = value.get_uint64();
+    } else {
+        int64_t i = value.get_int64();
+        negative  = i < 0;
+        n         = negative ? 0 - (uint64_t)i : (uint64_t)i;
+    }
+
+    do {
+        *--p = '0' + n % 10;
+        n /= 10;
+    } while (n > 0);
+    if (negative)
+        *--p = '-';
+
+    Append(p, end - p);
+}
+
+void CJSONWriter::WriteReal(double value) {
+    // json_spirit writes reals with std::showpoint << std::fixed << std::setprecision(8)
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf), "%.8f", value);
+    assert(len > 0 && (size_t)len < sizeof(buf));
+    Append(buf, len);
+}
+
+void CJSONWriter::WriteObject(const Object &obj) {
+    Append('{');
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        if (it != obj.begin())
+            Append(',');
+        WriteString(it->name_);
+        Append(':');
+        Write(it->value_);
+        CheckFlush();
+    }
+    Append('}');
+}
+
+void CJSONWriter::WriteArray(const Array &arr) {
+    Append('[');
+    for (auto it = arr.begin(); it != arr.end(); ++it) {
+        if (it != arr.begin())
+            Append(',');
+        Write(*it);
+        CheckFlush();
+    }
+    Append(']');
+}
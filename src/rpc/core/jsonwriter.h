@@ -0,0 +1,61 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_JSONWRITER_H
+#define RPC_CORE_JSONWRITER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "commons/json/json_spirit_value.h"
+
+/**
+ * Compact json writer that produces the same text as json_spirit::write_string(value, false),
+ * but appends it to a buffer which is handed to a flush function whenever it grows beyond
+ * the flush size, so a big reply goes out in pieces instead of being built as one string.
+ * Strings which need no escaping (hashes, hex data, addresses...) are copied as they are
+ * and integers are formatted without going through an ostream.
+ */
+class CJSONWriter {
+public:
+    typedef std::function<void(const std::string &chunk)> FlushFunc;
+
+    // without a flush function the whole text is kept in the buffer
+    explicit CJSONWriter(size_t flushSizeIn = 0, const FlushFunc &flushFuncIn = nullptr);
+
+    void Write(const json_spirit::Value &value);
+    // append text as it is, e.g. the separators of an object written by hand
+    void WriteRaw(const char *str, size_t len);
+    void WriteRaw(const std::string &str) { WriteRaw(str.data(), str.size()); }
+
+    // hand the buffered text to the flush function
+    void Flush();
+
+    // whether any text was handed to the flush function
+    bool Flushed() const { return flushed; }
+    const std::string &GetBuffer() const { return buffer; }
+
+private:
+    void WriteString(const std::string &str);
+    void WriteInt(const json_spirit::Value &value);
+    void WriteReal(double value);
+    void WriteObject(const json_spirit::Object &obj);
+    void WriteArray(const json_spirit::Array &arr);
+
+    void Append(const char *str, size_t len) { buffer.append(str, len); }
+    void Append(char c) { buffer.push_back(c); }
+    void CheckFlush() {
+        if (flushFunc && buffer.size() >= flushSize)
+            Flush();
+    }
+
+private:
+    size_t flushSize;
+    FlushFunc flushFunc;
+    std::string buffer;
+    bool flushed;
+};
+
+#endif  // RPC_CORE_JSONWRITER_H
@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpccache.h"
+
+#include "commons/util/util.h"
+#include "jsonwriter.h"
+#include "persistence/block.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace json_spirit;
+
+CRPCResponseCache::CRPCResponseCache(size_t nMaxBytes)
+    : fEnabled(nMaxBytes > 0),
+      tipEntries(max<size_t>(nMaxBytes / 2, 1)),
+      immutableEntries(max<size_t>(nMaxBytes / 2, 1)) {}
+
+bool CRPCResponseCache::GetKey(const string &method, const Array &params, RPCCacheMode mode,
+                               const uint256 &stateTipHash, CRPCCacheKey &key) const {
+    if (!fEnabled || mode == RPC_CACHE_NONE)
+        return false;
+
+    key.fImmutable = mode == RPC_CACHE_RAWDATA && params.size() == 2 && params[0].type() == str_type &&
+                     params[1].type() == bool_type && !params[1].get_bool();
+    if (!key.fImmutable) {
+        LOCK(cs);
+        if (tipHash.IsNull() || tipHash != stateTipHash)
+            return false;
+        key.tipHash = tipHash;
+    }
+
+    // the compact json text of the params is the same for equal params
+    CJSONWriter writer;
+    writer.Write(params);
+    key.key.clear();
+    key.key.reserve(method.size() + writer.GetBuffer().size() + (key.fImmutable ? 1 : 33));
+    if (!key.fImmutable)
+        key.key.append((const char *)key.tipHash.begin(), key.tipHash.size());
+    key.key.append(method);
+    key.key.push_back('\0');
+    key.key.append(writer.GetBuffer());
+    return true;
+}
+
+bool CRPCResponseCache::Get(const CRPCCacheKey &key, JSONPtr &spResultJSON) {
+    LOCK(cs);
+    JSONPtr *pEntry = key.fImmutable ? immutableEntries.find(key.key) : tipEntries.find(key.key);
+    if (pEntry == nullptr)
+        return false;
+
+    spResultJSON = *pEntry;
+    return true;
+}
+
+void CRPCResponseCache::Put(const CRPCCacheKey &key, const JSONPtr &spResultJSON) {
+    size_t cost = key.key.size() + spResultJSON->size();
+
+    LOCK(cs);
+    if (key.fImmutable)
+        immutableEntries.insert(key.key, spResultJSON, cost);
+    else if (key.tipHash == tipHash)
+        tipEntries.insert(key.key, spResultJSON, cost);
+}
+
+void CRPCResponseCache::SetTip(const uint256 &tipHashIn) {
+    LOCK(cs);
+    if (tipHash == tipHashIn)
+        return;
+
+    tipHash = tipHashIn;
+    tipEntries.clear();
+}
+
+size_t CRPCResponseCache::Size() const {
+    LOCK(cs);
+    return tipEntries.size() + immutableEntries.size();
+}
+
+CRPCResponseCache &GetRPCResponseCache() {
+    static CRPCResponseCache rpcResponseCache(
+        max<int64_t>(SysCfg().GetArg("-rpccachesize", DEFAULT_RPC_CACHE_SIZE), 0) << 20);
+    return rpcResponseCache;
+}
+
+static thread_local bool fSkipResponseCache = false;
+
+void SkipRPCResponseCache() { fSkipResponseCache = true; }
+
+bool TakeRPCResponseCacheSkipped() {
+    bool fSkipped      = fSkipResponseCache;
+    fSkipResponseCache = false;
+    return fSkipped;
+}
+
+void SetRPCCacheTip(const CBlockIndex *pTip) {
+    GetRPCResponseCache().SetTip(pTip ? pTip->GetBlockHash() : uint256());
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_RPCCACHE_H
+#define RPC_CORE_RPCCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "commons/json/json_spirit_value.h"
+#include "commons/lrucache.h"
+#include "commons/uint256.h"
+#include "sync.h"
+
+class CBlockIndex;
+
+/** -rpccachesize default (MiB) */
+static const int64_t DEFAULT_RPC_CACHE_SIZE = 32;
+
+/** Whether and how long the responses of a method are cached, the cache column of vRPCCommands */
+enum RPCCacheMode : uint8_t {
+    RPC_CACHE_NONE = 0,  // not cached
+    RPC_CACHE_TIP,       // cached until the tip changes
+    RPC_CACHE_RAWDATA,   // the hex data looked up by a hash, i.e. params ["hash", false], never
+                         // changes, other calls are cached as RPC_CACHE_TIP
+};
+
+class CRPCCacheKey {
+public:
+    std::string key;  // method and params, prefixed with the tip unless immutable
+    uint256 tipHash;
+    bool fImmutable = false;
+};
+
+/**
+ * Responses of read-only rpc calls, so repeated identical queries aren't rebuilt from the chain
+ * state. The results which depend on it are keyed by the tip they are computed at and dropped
+ * when the tip changes, the immutable ones are kept apart to survive that. The results are kept
+ * as their json text, which a hit writes into the reply as it is, and both parts are bounded by
+ * its size.
+ */
+class CRPCResponseCache {
+public:
+    explicit CRPCResponseCache(size_t nMaxBytes);
+
+    /** The key of a call, false if it must not be cached, e.g. while the chain state the queries
+     *  run on (stateTipHash) lags behind the tip */
+    bool GetKey(const std::string &method, const json_spirit::Array &params, RPCCacheMode mode,
+                const uint256 &stateTipHash, CRPCCacheKey &key) const;
+    bool Get(const CRPCCacheKey &key, std::shared_ptr<const std::string> &spResultJSON);
+    /** Results computed at a tip that has changed meanwhile are dropped */
+    void Put(const CRPCCacheKey &key, const std::shared_ptr<const std::string> &spResultJSON);
+
+    /** Drop the responses bound to the previous tip */
+    void SetTip(const uint256 &tipHashIn);
+
+    size_t Size() const;
+
+private:
+    typedef std::shared_ptr<const std::string> JSONPtr;
+
+    bool fEnabled;
+    mutable CCriticalSection cs;
+    uint256 tipHash;
+    lrucache<std::string, JSONPtr> tipEntries;
+    lrucache<std::string, JSONPtr> immutableEntries;
+};
+
+CRPCResponseCache &GetRPCResponseCache();
+
+/** Keep the response of the call running in this thread out of the cache, for results which can
+ *  change without a tip change, e.g. those read from the mempool */
+void SkipRPCResponseCache();
+/** Whether SkipRPCResponseCache() was called in this thread since the last call, and reset that */
+bool TakeRPCResponseCacheSkipped();
+
+/** Called with cs_main held whenever chainActive gets a new tip */
+void SetRPCCacheTip(const CBlockIndex *pTip);
+
+#endif  // RPC_CORE_RPCCACHE_H
@@ -244,6 +244,27 @@ Object SubmitTx(const CKeyID &keyid, CBaseTx &tx) {
     return obj;
 }
 
+static thread_local std::shared_ptr<const CChainSnapshot> spPinnedSnapshot;
+
+CRPCSnapshotPin::CRPCSnapshotPin(const std::shared_ptr<const CChainSnapshot> &spSnapshot)
+    : spPrevious(spPinnedSnapshot) {
+    spPinnedSnapshot = spSnapshot;
+}
+
+CRPCSnapshotPin::~CRPCSnapshotPin() { spPinnedSnapshot = spPrevious; }
+
+std::shared_ptr<const CChainSnapshot> FindRPCChainSnapshot() {
+    return spPinnedSnapshot ? spPinnedSnapshot : GetChainSnapshot();
+}
+
+std::shared_ptr<const CChainSnapshot> GetRPCChainSnapshot() {
+    auto spSnapshot = FindRPCChainSnapshot();
+    if (!spSnapshot)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "The chain state is not loaded yet");
+
+    return spSnapshot;
+}
+
 string RegIDToAddress(CUserID &userId) {
     CKeyID keyId;
     if (pCdMan->pAccountCache->GetKeyId(userId, keyId))
@@ -253,16 +274,22 @@ string RegIDToAddress(CUserID &userId) {
 }
 
 bool GetKeyId(const string &addr, CKeyID &keyId) {
+    return GetKeyId(*pCdMan->pAccountCache, addr, keyId);
+}
 
-    if(CRegID::GetKeyId(addr, keyId)){
-        return true ;
+bool GetKeyId(const CAccountDBCache &accountCache, const string &addr, CKeyID &keyId) {
+    CRegID regId(addr);
+    if (!regId.IsEmpty()) {
+        keyId = regId.GetKeyId(accountCache);
+        if (!keyId.IsEmpty())
+            return true;
     }
     keyId = CKeyID(addr);
     if (!keyId.IsEmpty()){
         return true ;
     }
     CNickID nickId(addr) ;
-    return pCdMan->pAccountCache->GetKeyId(nickId, keyId);
+    return accountCache.GetKeyId(nickId, keyId);
 }
 
 Object GetTxDetailJSON(const uint256& txid) {
@@ -270,10 +297,11 @@ Object GetTxDetailJSON(const uint256& txid) {
     {
         std::shared_ptr<CBaseTx> pBaseTx;
 
-        LOCK(cs_main);
+        auto spSnapshot = GetRPCChainSnapshot();
+        auto spCw       = spSnapshot->NewCacheWrapper();
         if (SysCfg().IsTxIndex()) {
             CDiskTxPos postx;
-            if (pCdMan->pBlockCache->ReadTxIndex(txid, postx)) {
+            if (spCw->blockCache.ReadTxIndex(txid, postx)) {
                 CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
                 CBlockHeader header;
 
@@ -282,17 +310,17 @@ Object GetTxDetailJSON(const uint256& txid) {
                     fseek(file, postx.nTxOffset, SEEK_CUR);
                     file >> pBaseTx;
                     //obj = pBaseTx->IsMultiSignSupport()?pBaseTx->ToJsonMultiSign(*database):pBaseTx->ToJson(*pCdMan->pAccountCache);
-                    obj = pBaseTx->ToJson(*pCdMan->pAccountCache);
+                    obj = pBaseTx->ToJson(spCw->accountCache);
 
-                    obj.push_back(Pair("confirmations",     chainActive.Height() - (int32_t)header.GetHeight()));
+                    obj.push_back(Pair("confirmations",     spSnapshot->Height() - (int32_t)header.GetHeight()));
                     obj.push_back(Pair("confirmed_height",  (int32_t)header.GetHeight()));
                     obj.push_back(Pair("confirmed_time",    (int32_t)header.GetTime()));
                     obj.push_back(Pair("block_hash",        header.GetHash().GetHex()));
 
                     if (SysCfg().IsGenReceipt()) {
                         vector<CReceipt> receipts;
-                        pCdMan->pReceiptCache->GetTxReceipts(txid, receipts);
-                        obj.push_back(Pair("receipts", JSON::ToJson(*pCdMan->pAccountCache, receipts)));
+                        spCw->txReceiptCache.GetTxReceipts(txid, receipts);
+                        obj.push_back(Pair("receipts", JSON::ToJson(spCw->accountCache, receipts)));
                     }
 
                     CDataStream ds(SER_DISK, CLIENT_VERSION);
@@ -300,9 +328,8 @@ Object GetTxDetailJSON(const uint256& txid) {
                     obj.push_back(Pair("rawtx", HexStr(ds.begin(), ds.end())));
 
                     string trace;
-                    auto database = std::make_shared<CCacheWrapper>(pCdMan);
-                    auto resolver = make_resolver(database);
-                    if(database->contractCache.GetContractTraces(txid, trace)){
+                    auto resolver = make_resolver(spCw);
+                    if(spCw->contractCache.GetContractTraces(txid, trace)){
 
                         json_spirit::Value value_json;
                         std::vector<char>  trace_bytes = std::vector<char>(trace.begin(), trace.end());
@@ -319,10 +346,12 @@ Object GetTxDetailJSON(const uint256& txid) {
             }
         }
 
+        // only the confirmed txs above are cached, the mempool changes without a tip change
+        SkipRPCResponseCache();
         {
             pBaseTx = mempool.Lookup(txid);
             if (pBaseTx.get()) {
-                obj = pBaseTx->ToJson(*pCdMan->pAccountCache);
+                obj = pBaseTx->ToJson(spCw->accountCache);
                 CDataStream ds(SER_DISK, CLIENT_VERSION);
                 ds << pBaseTx;
                 obj.push_back(Pair("rawtx", HexStr(ds.begin(), ds.end())));
@@ -332,15 +361,17 @@ Object GetTxDetailJSON(const uint256& txid) {
 
         /* try */
         CBlock genesisblock;
-        CBlockIndex* pGenesisBlockIndex = mapBlockIndex[SysCfg().GetGenesisBlockHash()];
-        ReadBlockFromDisk(pGenesisBlockIndex, genesisblock);
+        const CBlockIndex* pGenesisBlockIndex = (*spSnapshot)[0];
+        if (pGenesisBlockIndex == nullptr || !ReadBlockFromDisk(pGenesisBlockIndex, genesisblock))
+            return obj;
+
         assert(genesisblock.GetMerkleRootHash() == genesisblock.BuildMerkleTree());
         for (uint32_t i = 0; i < genesisblock.vptx.size(); ++i) {
             if (txid == genesisblock.GetTxid(i)) {
-                obj = genesisblock.vptx[i]->ToJson(*pCdMan->pAccountCache);
+                obj = genesisblock.vptx[i]->ToJson(spCw->accountCache);
 
-                obj.push_back(Pair("confirmations",     chainActive.Height()));
-                obj.push_back(Pair("confirmed_height",  chainActive.Height()));
+                obj.push_back(Pair("confirmations",     spSnapshot->Height()));
+                obj.push_back(Pair("confirmed_height",  spSnapshot->Height()));
                 obj.push_back(Pair("confirmed_time",    (int32_t)genesisblock.GetTime()));
                 obj.push_back(Pair("block_hash",        genesisblock.GetHash().GetHex()));
 
@@ -5,6 +5,7 @@
 #ifndef RPC_CORE_COMMONS_H
 #define RPC_CORE_COMMONS_H
 
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -19,13 +20,32 @@
 using namespace std;
 using namespace json_spirit;
 
+class CChainSnapshot;
+
 string RegIDToAddress(CUserID &userId);
 bool GetKeyId(const string &addr, CKeyID &keyId);
+bool GetKeyId(const CAccountDBCache &accountCache, const string &addr, CKeyID &keyId);
 Object GetTxDetailJSON(const uint256& txid);
 Array GetTxAddressDetail(std::shared_ptr<CBaseTx> pBaseTx);
 
 Object SubmitTx(const CKeyID &keyid, CBaseTx &tx);
 
+// the chain state the read-only queries run on without cs_main, see CChainSnapshot
+std::shared_ptr<const CChainSnapshot> GetRPCChainSnapshot();
+// the same, or null while the chain state is not loaded yet
+std::shared_ptr<const CChainSnapshot> FindRPCChainSnapshot();
+
+/** Pins the snapshot the queries run on in this thread while in scope, so that all the entries
+ *  of a batch request read the same tip */
+class CRPCSnapshotPin {
+public:
+    explicit CRPCSnapshotPin(const std::shared_ptr<const CChainSnapshot> &spSnapshot);
+    ~CRPCSnapshotPin();
+
+private:
+    std::shared_ptr<const CChainSnapshot> spPrevious;
+};
+
 namespace JSON {
     const Value& GetObjectFieldValue(const Value &jsonObj, const string &fieldName);
     const char* GetValueTypeName(const Value_type &valueType);
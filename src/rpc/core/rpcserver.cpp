@@ -13,10 +13,14 @@
 #include "main.h"
 
 #include <boost/algorithm/string.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include "wallet/wallet.h"
 #include "commons/json/json_spirit_writer_template.h"
 #include "httpserver.h"
+#include "jsonwriter.h"
+#include "rpccommons.h"
 #include "rpc/rpcvm.h"
 
 using namespace std;
@@ -234,11 +238,12 @@ Value stop(const Array& params, bool fHelp) {
 //
 
 static const CRPCCommand vRPCCommands[] =
-{ //  name                      actor (function)         okSafeMode threadSafe reqWallet
-  //  ------------------------  -----------------------  ---------- ---------- ---------
+{ //  name                      actor (function)         okSafeMode threadSafe reqWallet  cache
+  //  ------------------------  -----------------------  ---------- ---------- ---------  -----------------
     /* Overall control/query calls */
     { "help",                   &help,                   true,      true,       false },
     { "getinfo",                &getinfo,                true,      false,      false }, /* uses wallet if enabled */
+    { "getsigcacheinfo",        &getsigcacheinfo,        true,      true,       false },
     { "stop",                   &stop,                   true,      true,       false },
     { "validateaddr",           &validateaddr,           true,      true,       false },
     { "createmulsig",           &createmulsig,           true,      true ,      false },
@@ -249,14 +254,15 @@ static const CRPCCommand vRPCCommands[] =
     { "getaddednodeinfo",       &getaddednodeinfo,       true,      true,       false },
     { "getconnectioncount",     &getconnectioncount,     true,      false,      false },
     { "getnettotals",           &getnettotals,           true,      true,       false },
+    { "getnetstats",            &getnetstats,            true,      true,       false },
     { "getpeerinfo",            &getpeerinfo,            true,      false,      false },
     { "ping",                   &ping,                   true,      false,      false },
     { "getchaininfo",           &getchaininfo,           true,      false,      false },
 
     /* Block chain and UTXO */
     { "getfcoingenesistxinfo",  &getfcoingenesistxinfo,  true,      true,       false },
-    { "getblockcount",          &getblockcount,          true,      true,       false },
-    { "getblock",               &getblock,               true,      false,      false },
+    { "getblockcount",          &getblockcount,          true,      true,       false,     RPC_CACHE_TIP },
+    { "getblock",               &getblock,               true,      true,       false,     RPC_CACHE_RAWDATA },
     { "getrawmempool",          &getrawmempool,          true,      false,      false },
     { "verifychain",            &verifychain,            true,      false,      false },
 
@@ -275,9 +281,9 @@ static const CRPCCommand vRPCCommands[] =
 
     /* uses wallet if enabled */
     { "addmulsigaddr",          &addmulsigaddr,          false,     false,      true },
-    { "getaccountinfo",         &getaccountinfo,         true,      false,      true },
+    { "getaccountinfo",         &getaccountinfo,         true,      true,       true },
     { "getnewaddr",             &getnewaddr,             false,     false,      true },
-    { "gettxdetail",            &gettxdetail,            true,      false,      true },
+    { "gettxdetail",            &gettxdetail,            true,      true,       true,      RPC_CACHE_TIP },
     { "getclosedcdp",           &getclosedcdp,           true,      false,      true },
     { "getwalletinfo",          &getwalletinfo,          true,      false,      true },
 
@@ -309,7 +315,7 @@ static const CRPCCommand vRPCCommands[] =
     { "signtxraw",              &signtxraw,              true,      false,      true },
     { "getcontractaccountinfo", &getcontractaccountinfo, true,      false,      true },
     { "getsignature",           &getsignature,           true,      false,      true },
-    { "listdelegates",          &listdelegates,          true,      false,      true },
+    { "listdelegates",          &listdelegates,          true,      false,      true,      RPC_CACHE_TIP },
     { "decodetxraw",            &decodetxraw,            true,      false,      false },
     { "decodemulsigscript",     &decodemulsigscript,     true,      false,      false },
 
@@ -334,8 +340,8 @@ static const CRPCCommand vRPCCommands[] =
     { "submitcdpredeemtx",      &submitcdpredeemtx,      false,     false,      true },
     { "submitcdpliquidatetx",   &submitcdpliquidatetx,   false,     false,      true },
 
-    { "getscoininfo",           &getscoininfo,           true,      false,      false },
-    { "getcdp",                 &getcdp,                 true,      false,      false },
+    { "getscoininfo",           &getscoininfo,           true,      false,      false,     RPC_CACHE_TIP },
+    { "getcdp",                 &getcdp,                 true,      true,       false },
     { "getusercdp",             &getusercdp,             true,      false,      false },
 
     /* for dex */
@@ -348,7 +354,7 @@ static const CRPCCommand vRPCCommands[] =
     { "submitdexoperatorregtx",     &submitdexoperatorregtx,     false,     false,      false },
     { "submitdexoperatorupdatetx",  &submitdexoperatorupdatetx,  false,     false,      false },
 
-    { "getdexorder",                &getdexorder,                true,      false,      false },
+    { "getdexorder",                &getdexorder,                true,      true,       false },
     { "getdexsysorders",            &getdexsysorders,            true,      false,      false },
     { "getdexorders",               &getdexorders,               true,      false,      false },
     { "getdexoperator",             &getdexoperator,             true,      false,      false },
@@ -363,7 +369,7 @@ static const CRPCCommand vRPCCommands[] =
     /* for wasm */
     { "submitwasmcontractdeploytx", &submitwasmcontractdeploytx,       true,      false,      true },
     { "submitwasmcontractcalltx",   &submitwasmcontractcalltx,          true,      false,      true },
-    { "gettablewasm",               &gettablewasm,      true,      false,      true },
+    { "gettablewasm",               &gettablewasm,      true,      true,       true },
     { "jsontobinwasm",              &jsontobinwasm,     true,      false,      true },
     { "bintojsonwasm",              &bintojsonwasm,     true,      false,      true },
     { "getcodewasm",                &getcodewasm,       true,      false,      true },
@@ -561,34 +567,148 @@ void JSONRequest::parse(const Value& valRequest) {
         throw JSONRPCError(RPC_INVALID_REQUEST, "Params must be an array");
 }
 
-Object JSONRPCExecOne(const Value& req) {
-    Object rpc_result;
+/** Write the same text as JSONRPCReplyObj(result, Value::null, id), the result may be given
+ *  as its json text, e.g. from the response cache, instead of as a value */
+static void WriteJSONRPCResult(CJSONWriter& writer, const Value& result,
+                               const std::shared_ptr<const string>& spResultJSON, const Value& id) {
+    writer.WriteRaw("{\"result\":");
+    if (spResultJSON)
+        writer.WriteRaw(*spResultJSON);
+    else
+        writer.Write(result);
+    writer.WriteRaw(",\"error\":null,\"id\":");
+    writer.Write(id);
+    writer.WriteRaw("}");
+}
+
+string JSONRPCExecOne(const Value& req) {
+    CJSONWriter writer;
 
     JSONRequest jreq;
     try {
         jreq.parse(req);
 
-        Value result = tableRPC.execute(jreq.strMethod, jreq.params);
-        rpc_result   = JSONRPCReplyObj(result, Value::null, jreq.id);
+        std::shared_ptr<const string> spResultJSON;
+        Value result = tableRPC.execute(jreq.strMethod, jreq.params, spResultJSON);
+        WriteJSONRPCResult(writer, result, spResultJSON, jreq.id);
+        return writer.GetBuffer();
     } catch (Object& objError) {
-        rpc_result = JSONRPCReplyObj(Value::null, objError, jreq.id);
+        writer.Write(JSONRPCReplyObj(Value::null, objError, jreq.id));
     } catch (std::exception& e) {
-        rpc_result = JSONRPCReplyObj(Value::null, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        writer.Write(JSONRPCReplyObj(Value::null, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id));
+    } catch (...) {
+        writer.Write(JSONRPCReplyObj(Value::null, JSONRPCError(RPC_MISC_ERROR, "unknown exception"), jreq.id));
     }
 
-    return rpc_result;
+    return writer.GetBuffer();
 }
 
+/**
+ * The thread safe entries of a batch request, run by the http worker threads. The thread serving
+ * the request claims entries as well, so the batch completes even if no worker is free. All of
+ * them run on the one snapshot taken for the batch.
+ */
+class CRPCBatch {
+public:
+    Array vReq;
+    vector<string> vReply;
+    vector<uint32_t> vParallel;  // indexes of the entries which may run in parallel
+    std::shared_ptr<const CChainSnapshot> spSnapshot;
+
+    explicit CRPCBatch(const Array& vReqIn) : vReq(vReqIn), vReply(vReqIn.size()) {}
+
+    // run the entries until none is left to claim
+    void Run() {
+        CRPCSnapshotPin pin(spSnapshot);
+        uint32_t next;
+        while ((next = nNext++) < vParallel.size()) {
+            vReply[vParallel[next]] = JSONRPCExecOne(vReq[vParallel[next]]);
+
+            STD_LOCK(cs);
+            if (++nDone == vParallel.size())
+                cond.notify_all();
+        }
+    }
+
+    // wait for the entries claimed by other threads
+    void Wait() {
+        STD_WAIT_LOCK(cs, lock);
+        while (nDone < vParallel.size())
+            cond.wait(lock);
+    }
+
+private:
+    std::atomic<uint32_t> nNext{0};
+    StdMutex cs;
+    std::condition_variable cond;
+    size_t nDone = 0;
+};
+
+class CRPCBatchWorkItem final : public HTTPClosure {
+public:
+    explicit CRPCBatchWorkItem(const std::shared_ptr<CRPCBatch>& batchIn) : batch(batchIn) {}
+    void operator()() override { batch->Run(); }
+
+private:
+    std::shared_ptr<CRPCBatch> batch;
+};
+
 string JSONRPCExecBatch(const Array& vReq) {
-    Array ret;
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+    auto batch = std::make_shared<CRPCBatch>(vReq);
+    vector<uint32_t> vSerial;
+    for (uint32_t reqIdx = 0; reqIdx < vReq.size(); reqIdx++) {
+        const CRPCCommand* pcmd = nullptr;
+        if (vReq[reqIdx].type() == obj_type) {
+            const Value& valMethod = find_value(vReq[reqIdx].get_obj(), "method");
+            if (valMethod.type() == str_type)
+                pcmd = tableRPC[valMethod.get_str()];
+        }
 
-    return write_string(Value(ret), false) + "\n";
+        if (pcmd && pcmd->threadSafe)
+            batch->vParallel.push_back(reqIdx);
+        else
+            vSerial.push_back(reqIdx);
+    }
+
+    batch->spSnapshot = GetChainSnapshot();
+    if (batch->vParallel.size() > 1) {
+        // the work queue is shared with the incoming requests, keep half of it free for them
+        size_t nKeepFree = std::max<int32_t>(SysCfg().GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L) / 2;
+        int32_t nWorkers = SysCfg().GetArg("-rpcthreads", DEFAULT_HTTP_THREADS) - 1;
+        nWorkers = std::min<int32_t>(nWorkers, batch->vParallel.size() - 1);
+        for (int32_t i = 0; i < nWorkers; i++) {
+            std::unique_ptr<HTTPClosure> item(new CRPCBatchWorkItem(batch));
+            if (!EnqueueHTTPWork(item, nKeepFree))
+                break;
+        }
+    }
+    batch->Run();
+
+    // the other entries take cs_main one by one, so the block validation isn't held up by the batch
+    for (uint32_t reqIdx : vSerial)
+        batch->vReply[reqIdx] = JSONRPCExecOne(vReq[reqIdx]);
+
+    batch->Wait();
+
+    size_t nSize = 3;
+    for (const auto& reply : batch->vReply)
+        nSize += reply.size() + 1;
+
+    string ret;
+    ret.reserve(nSize);
+    ret.push_back('[');
+    for (size_t i = 0; i < batch->vReply.size(); i++) {
+        if (i > 0)
+            ret.push_back(',');
+        ret.append(batch->vReply[i]);
+    }
+    ret.append("]\n");
+
+    return ret;
 }
 
-json_spirit::Value CRPCTable::execute(const string& strMethod,
-                                      const json_spirit::Array& params) const {
+json_spirit::Value CRPCTable::execute(const string& strMethod, const json_spirit::Array& params,
+                                      std::shared_ptr<const string>& spResultJSON) const {
     // Find method
     const CRPCCommand* pcmd = tableRPC[strMethod];
     if (!pcmd)
@@ -608,6 +728,19 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
             throw JSONRPCError(RPC_FORBIDDEN_BY_SAFE_MODE, "Banned RPC method by blacklist");
     }
 
+    // the cache is consulted after the checks above, they depend on the config and not the call
+    CRPCResponseCache& cache = GetRPCResponseCache();
+    CRPCCacheKey cacheKey;
+    bool fCache = false;
+    if (pcmd->cache != RPC_CACHE_NONE) {
+        auto spSnapshot = FindRPCChainSnapshot();
+        uint256 stateTipHash = (spSnapshot && spSnapshot->Tip()) ? spSnapshot->Tip()->GetBlockHash() : uint256();
+        fCache = cache.GetKey(strMethod, params, pcmd->cache, stateTipHash, cacheKey);
+        if (fCache && cache.Get(cacheKey, spResultJSON))
+            return Value::null;
+        TakeRPCResponseCacheSkipped();
+    }
+
     try {
         // Execute
         Value result;
@@ -623,6 +756,15 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
             }
         }
 
+        if (fCache && !TakeRPCResponseCacheSkipped()) {
+            // the reply is written from the same text
+            CJSONWriter writer;
+            writer.Write(result);
+            spResultJSON = std::make_shared<const string>(writer.GetBuffer());
+            cache.Put(cacheKey, spResultJSON);
+            return Value::null;
+        }
+
         return result;
     } catch (std::exception& e) {
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
@@ -642,6 +784,27 @@ string HelpExampleRpc(string methodname, string args) {
 
 const CRPCTable tableRPC;
 
+/** Replies growing beyond this are streamed to the client with chunked transfer encoding */
+static const size_t RPC_REPLY_CHUNK_SIZE = 256 * 1024;
+
+/** Write the same text as JSONRPCReply(result, Value::null, id), without copying the result
+ *  into a reply object and big replies without building them in memory at once. */
+static void WriteJSONRPCReply(HTTPRequest* req, const Value& result,
+                              const std::shared_ptr<const string>& spResultJSON, const Value& id) {
+    CJSONWriter writer(RPC_REPLY_CHUNK_SIZE, [req](const std::string& chunk) {
+        req->WriteReplyChunk(HTTP_OK, chunk);
+    });
+    WriteJSONRPCResult(writer, result, spResultJSON, id);
+    writer.WriteRaw("\n");
+
+    if (writer.Flushed()) {
+        writer.Flush();
+        req->EndChunkedReply();
+    } else {
+        req->WriteReply(HTTP_OK, writer.GetBuffer());
+    }
+}
+
 /** json rpc handler registered to http server */
 static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
     // JSONRPC handles only POST or GET
@@ -681,24 +844,23 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         if (!read_string(req->ReadBody(), valRequest))
             throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
 
-        string strReply;
-
         // singleton request
         if (valRequest.type() == obj_type) {
             jreq.parse(valRequest);
-            Value result = tableRPC.execute(jreq.strMethod, jreq.params);
+            std::shared_ptr<const string> spResultJSON;
+            Value result = tableRPC.execute(jreq.strMethod, jreq.params, spResultJSON);
 
             // Send reply
-            strReply = JSONRPCReply(result, Value::null, jreq.id);
+            req->WriteHeader("Content-Type", "application/json");
+            WriteJSONRPCReply(req, result, spResultJSON, jreq.id);
 
             // array of requests
-        } else if (valRequest.type() == array_type)
-            strReply = JSONRPCExecBatch(valRequest.get_array());
-        else
+        } else if (valRequest.type() == array_type) {
+            string strReply = JSONRPCExecBatch(valRequest.get_array());
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strReply);
+        } else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
-
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strReply);
     } catch (Object& objError) {
         ErrorReply(req, objError, jreq.id);
         return false;
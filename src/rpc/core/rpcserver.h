@@ -6,6 +6,7 @@
 #ifndef _COINRPC_SERVER_H_
 #define _COINRPC_SERVER_H_
 
+#include "rpccache.h"
 #include "rpcprotocol.h"
 #include "commons/uint256.h"
 
@@ -60,6 +61,7 @@ public:
     bool okSafeMode;
     bool threadSafe;
     bool reqWallet;
+    RPCCacheMode cache;  // RPC_CACHE_NONE when left out of the table row
 };
 
 /**
@@ -78,10 +80,13 @@ public:
      * Execute a method.
      * @param method   Method to execute
      * @param params   Array of arguments (JSON objects)
+     * @param spResultJSON  Set to the json text of the result if it is served from or put into
+     *                      the response cache, the returned value is null then
      * @returns Result of the call.
      * @throws an exception (json_spirit::Value) when an error happens.
      */
-    json_spirit::Value execute(const string& method, const json_spirit::Array& params) const;
+    json_spirit::Value execute(const string& method, const json_spirit::Array& params,
+                               std::shared_ptr<const string>& spResultJSON) const;
 };
 
 extern const CRPCTable tableRPC;
@@ -111,6 +116,7 @@ extern json_spirit::Value ping(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value addnode(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getaddednodeinfo(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getnettotals(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value getnetstats(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getchaininfo(const json_spirit::Array& params, bool fHelp);
 
 extern json_spirit::Value dumpprivkey(const json_spirit::Array& params, bool fHelp); // in rpcdump.cpp
@@ -141,6 +147,7 @@ extern json_spirit::Value walletpassphrasechange(const json_spirit::Array& param
 extern json_spirit::Value walletlock(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value encryptwallet(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getinfo(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value getsigcacheinfo(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getwalletinfo(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getnetworkinfo(const json_spirit::Array& params, bool fHelp);
 
@@ -209,7 +216,8 @@ extern json_spirit::Value getcodewasm(const json_spirit::Array& params, bool fHe
 extern json_spirit::Value getabiwasm(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value gettxtrace(const json_spirit::Array& params, bool fHelp);
 
-json_spirit::Object JSONRPCExecOne(const json_spirit::Value& req);
+// the json text of the reply to one entry of a batch request
+std::string JSONRPCExecOne(const json_spirit::Value& req);
 
 std::string JSONRPCExecBatch(const json_spirit::Array& vReq);
 
@@ -13,9 +13,9 @@
 #include "init.h"
 #include "commons/json/json_spirit_value.h"
 #include "main.h"
+#include "rpc/core/rpccommons.h"
 #include "rpc/core/rpcserver.h"
 #include "sync.h"
-#include "tx/merkletx.h"
 #include "tx/tx.h"
 #include "tx/coinrewardtx.h"
 #include "wallet/wallet.h"
@@ -25,14 +25,14 @@ using namespace std;
 
 class CBaseCoinTransferTx;
 
-Object BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex) {
+Object BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex, const CChainSnapshot& chain) {
     Object result;
     result.push_back(Pair("block_hash",     block.GetHash().GetHex()));
     result.push_back(Pair("block_miner",    block.vptx[0]->txUid.ToString()));
 
-    CMerkleTx txGen(block.vptx[0]);
-    txGen.SetMerkleBranch(&block);
-    result.push_back(Pair("confirmations",  (int32_t)txGen.GetDepthInMainChain()));
+    // the depth of the block reward tx, which is never in the mempool
+    bool inChain = chain.Contains(pBlockIndex);
+    result.push_back(Pair("confirmations",  inChain ? chain.Height() - pBlockIndex->height + 1 : -1));
     result.push_back(Pair("size",           (int32_t)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION)));
     result.push_back(Pair("height",         (int32_t)block.GetHeight()));
     result.push_back(Pair("version",        block.GetVersion()));
@@ -47,7 +47,7 @@ Object BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex) {
 
     if (pBlockIndex->pprev)
         result.push_back(Pair("previous_block_hash", pBlockIndex->pprev->GetBlockHash().GetHex()));
-    CBlockIndex* pNext = chainActive.Next(pBlockIndex);
+    const CBlockIndex* pNext = inChain ? chain[pBlockIndex->height + 1] : nullptr;
     if (pNext)
         result.push_back(Pair("next_block_hash", pNext->GetBlockHash().GetHex()));
 
@@ -208,28 +208,30 @@ Value getblock(const Array& params, bool fHelp) {
 
     // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
 
-    std::string strHash;
+    auto spSnapshot = GetRPCChainSnapshot();
+    const CBlockIndex* pBlockIndex = nullptr;
     if (int_type == params[0].type()) {
         int height = params[0].get_int();
-        if (height < 0 || height > chainActive.Height())
+        if (height < 0 || height > spSnapshot->Height())
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
 
-        CBlockIndex* pBlockIndex = chainActive[height];
-        strHash                  = pBlockIndex->GetBlockHash().GetHex();
+        pBlockIndex = (*spSnapshot)[height];
     } else {
-        strHash = params[0].get_str();
+        uint256 hash(uint256S(params[0].get_str()));
+        // only the lookup needs cs_main, the block index entries are never freed
+        LOCK(cs_main);
+        auto it = mapBlockIndex.find(hash);
+        if (it == mapBlockIndex.end())
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+        pBlockIndex = it->second;
     }
-    uint256 hash(uint256S(strHash));
 
     bool fVerbose = true;
     if (params.size() > 1)
         fVerbose = params[1].get_bool();
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-
     CBlock block;
-    CBlockIndex* pBlockIndex = mapBlockIndex[hash];
     if (!ReadBlockFromDisk(pBlockIndex, block)) {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
     }
@@ -241,7 +243,7 @@ Value getblock(const Array& params, bool fHelp) {
         return strHex;
     }
 
-    return BlockToJSON(block, pBlockIndex);
+    return BlockToJSON(block, pBlockIndex, *spSnapshot);
 }
 
 Value verifychain(const Array& params, bool fHelp) {
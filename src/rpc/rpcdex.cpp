@@ -516,9 +516,9 @@ Value getdexorder(const Array& params, bool fHelp) {
     }
     const uint256 &orderId = RPC_PARAM::GetTxid(params[0], "order_id");
 
-    auto pDexCache = pCdMan->pDexCache;
+    auto spCw = GetRPCChainSnapshot()->NewCacheWrapper();
     CDEXOrderDetail orderDetail;
-    if (!pDexCache->GetActiveOrder(orderId, orderDetail))
+    if (!spCw->dexCache.GetActiveOrder(orderId, orderDetail))
         throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("The order not exists or inactive! order_id=%s", orderId.ToString()));
 
     Object obj;
@@ -147,6 +147,37 @@ Value getinfo(const Array& params, bool fHelp) {
     return obj;
 }
 
+Value getsigcacheinfo(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getsigcacheinfo\n"
+            "\nget the statistics of the signature cache.\n"
+            "\nArguments:\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"hits\": xxxxx,        (numeric) lookups answered by the cache\n"
+            "  \"misses\": xxxxx,      (numeric) lookups which had to verify the signature\n"
+            "  \"inserts\": xxxxx,     (numeric) verified signatures added to the cache\n"
+            "  \"evictions\": xxxxx,   (numeric) entries pushed out by inserts into a full bucket\n"
+            "  \"capacity\": xxxxx,    (numeric) the max number of entries\n"
+            "  \"bytes\": xxxxx        (numeric) the memory held by the cache, set by -maxsigcachesize\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getsigcacheinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getsigcacheinfo", ""));
+
+    CSignatureCache::Stats stats = signatureCache.GetStats();
+
+    Object obj;
+    obj.push_back(Pair("hits",          (int64_t)stats.hits));
+    obj.push_back(Pair("misses",        (int64_t)stats.misses));
+    obj.push_back(Pair("inserts",       (int64_t)stats.inserts));
+    obj.push_back(Pair("evictions",     (int64_t)stats.evictions));
+    obj.push_back(Pair("capacity",      (int64_t)stats.entries));
+    obj.push_back(Pair("bytes",         (int64_t)stats.bytes));
+
+    return obj;
+}
+
 Value verifymessage(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 3)
         throw runtime_error(
@@ -8,6 +8,7 @@
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
+#include "p2p/netstats.h"
 #include "p2p/protocol.h"
 #include "sync.h"
 #include "commons/util/util.h"
@@ -322,6 +323,112 @@ Value getnettotals(const Array& params, bool fHelp) {
     return obj;
 }
 
+static Object HistogramToJSON(const CStatsHistogram& histogram) {
+    Object obj;
+    obj.push_back(Pair("count",         (int64_t)histogram.Count()));
+    obj.push_back(Pair("sum",           (int64_t)histogram.Sum()));
+
+    Array buckets;
+    for (size_t k = 0; k < STATS_HISTOGRAM_BUCKETS; k++) {
+        if (histogram.Bucket(k) == 0)
+            continue;
+        Object bucket;
+        bucket.push_back(Pair("below",  k < STATS_HISTOGRAM_BUCKETS - 1 ? (int64_t)1 << k : (int64_t)-1));
+        bucket.push_back(Pair("count",  (int64_t)histogram.Bucket(k)));
+        buckets.push_back(bucket);
+    }
+    obj.push_back(Pair("buckets",       buckets));
+    return obj;
+}
+
+static Object MsgStatsToJSON(const CNetMsgStats& msgStats, const vector<CStatsHistogram>* pProcessTime) {
+    Object obj;
+    for (size_t nType = 0; nType < msgStats.size(); nType++) {
+        const CNetMsgTypeStats& stats = msgStats[nType];
+        if (stats.nMsgsRecv == 0 && stats.nMsgsSent == 0)
+            continue;
+
+        Object typeObj;
+        typeObj.push_back(Pair("msgsrecv",      (int64_t)stats.nMsgsRecv));
+        typeObj.push_back(Pair("bytesrecv",     (int64_t)stats.nBytesRecv));
+        typeObj.push_back(Pair("msgssent",      (int64_t)stats.nMsgsSent));
+        typeObj.push_back(Pair("bytessent",     (int64_t)stats.nBytesSent));
+        typeObj.push_back(Pair("processtime",   (int64_t)stats.nProcessTime));
+        if (pProcessTime != nullptr)
+            typeObj.push_back(Pair("processtimes", HistogramToJSON((*pProcessTime)[nType])));
+        obj.push_back(Pair(GetNetMsgTypeName(nType), typeObj));
+    }
+    return obj;
+}
+
+Value getnetstats(const Array& params, bool fHelp) {
+    if (fHelp || params.size() > 1)
+        throw runtime_error(
+            "getnetstats [verbose]\n"
+            "\nReturns network counters per message type and per peer.\n"
+            "\nArguments:\n"
+            "1. verbose              (boolean, optional, default=false) also break down the messages of each peer by type\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"messages\": {         (object) the messages of all peers, by type, types not seen are left out\n"
+            "    \"type\": {\n"
+            "      \"msgsrecv\": n,     (numeric) messages received\n"
+            "      \"bytesrecv\": n,    (numeric) bytes received, headers included\n"
+            "      \"msgssent\": n,     (numeric) messages sent\n"
+            "      \"bytessent\": n,    (numeric) bytes sent, headers included\n"
+            "      \"processtime\": n,  (numeric) microseconds spent handling the received messages\n"
+            "      \"processtimes\": {  (object) histogram of the handling time of a message in microseconds\n"
+            "        \"count\": n,      (numeric) values counted\n"
+            "        \"sum\": n,        (numeric) sum of the values\n"
+            "        \"buckets\": [     (array) non-empty buckets, counting the values below \"below\"\n"
+            "          {\"below\": n, \"count\": n}, ...   the last bucket has below=-1 and counts the rest\n"
+            "        ]\n"
+            "      }\n"
+            "    }, ...\n"
+            "  },\n"
+            "  \"blockpropagation\": {...}, (object) histogram of the milliseconds from the first time a block\n"
+            "                                was announced or received until it was connected as the tip\n"
+            "  \"peers\": [\n"
+            "    {\n"
+            "      \"id\": n,             (numeric) the peer id\n"
+            "      \"addr\": \"host:port\", (string) the address of the peer\n"
+            "      \"recvqueue\": n,      (numeric) received messages waiting to be handled\n"
+            "      \"sendqueue\": n,      (numeric) messages waiting to be sent\n"
+            "      \"sendqueuebytes\": n, (numeric) bytes waiting to be sent\n"
+            "      \"messages\": {...}    (object) verbose only, like \"messages\" above without histograms\n"
+            "    }, ...\n"
+            "  ],\n"
+            "  \"timemillis\": t       (numeric) current time in milliseconds\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getnetstats", "") + "\nAs json rpc\n" + HelpExampleRpc("getnetstats", "true"));
+
+    bool fVerbose = params.size() > 0 && params[0].get_bool();
+
+    Object obj;
+    obj.push_back(Pair("messages",          MsgStatsToJSON(netStats.msgs, &netStats.vProcessTime)));
+    obj.push_back(Pair("blockpropagation",  HistogramToJSON(netStats.blockPropagation)));
+
+    Array peers;
+    {
+        LOCK(cs_vNodes);
+        for (auto pNode : vNodes) {
+            Object peer;
+            peer.push_back(Pair("id",               pNode->GetId()));
+            peer.push_back(Pair("addr",             pNode->addrName));
+            peer.push_back(Pair("recvqueue",        (int64_t)pNode->nRecvMsgQueued));
+            peer.push_back(Pair("sendqueue",        (int64_t)pNode->nSendMsgQueued));
+            peer.push_back(Pair("sendqueuebytes",   (int64_t)pNode->nSendSize));
+            if (fVerbose)
+                peer.push_back(Pair("messages",     MsgStatsToJSON(pNode->msgStats, nullptr)));
+            peers.push_back(peer);
+        }
+    }
+    obj.push_back(Pair("peers",             peers));
+    obj.push_back(Pair("timemillis",        GetTimeMillis()));
+    return obj;
+}
+
 Value getnetworkinfo(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 0)
         throw runtime_error(
@@ -613,10 +613,14 @@ Value getaccountinfo(const Array& params, bool fHelp) {
     }
 
     RPCTypeCheck(params, list_of(str_type));
+    auto spSnapshot = GetRPCChainSnapshot();
+    auto spCw       = spSnapshot->NewCacheWrapper();
+    int32_t height  = spSnapshot->Height();
+
     CKeyID keyid;
     CUserID userId;
     string addr = params[0].get_str();
-    if (!GetKeyId(addr, keyid)) {
+    if (!GetKeyId(spCw->accountCache, addr, keyid)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
@@ -625,10 +629,11 @@ Value getaccountinfo(const Array& params, bool fHelp) {
     bool found = false;
 
     CAccount account;
-    if (pCdMan->pAccountCache->GetAccount(userId, account)) {
+    if (spCw->accountCache.GetAccount(userId, account)) {
         if (!account.owner_pubkey.IsValid()) {
             CPubKey pubKey;
             CPubKey minerPubKey;
+            LOCK(pWalletMain->cs_wallet);
             if (pWalletMain->GetPubKey(keyid, pubKey)) {
                 pWalletMain->GetPubKey(keyid, minerPubKey, true);
                 account.owner_pubkey = pubKey;
@@ -638,13 +643,14 @@ Value getaccountinfo(const Array& params, bool fHelp) {
                 }
             }
         }
-        obj = account.ToJsonObj();
+        obj = account.ToJsonObj(spCw->delegateCache, height);
         obj.push_back(Pair("position", "inblock"));
 
         found = true;
     } else {  // unregistered keyid
         CPubKey pubKey;
         CPubKey minerPubKey;
+        LOCK(pWalletMain->cs_wallet);
         if (pWalletMain->GetPubKey(keyid, pubKey)) {
             pWalletMain->GetPubKey(keyid, minerPubKey, true);
             account.owner_pubkey = pubKey;
@@ -652,7 +658,7 @@ Value getaccountinfo(const Array& params, bool fHelp) {
             if (minerPubKey != pubKey) {
                 account.miner_pubkey = minerPubKey;
             }
-            obj = account.ToJsonObj();
+            obj = account.ToJsonObj(spCw->delegateCache, height);
             obj.push_back(Pair("position", "inwallet"));
 
             found = true;
@@ -660,15 +666,14 @@ Value getaccountinfo(const Array& params, bool fHelp) {
     }
 
     if (found) {
-        int32_t height       = chainActive.Height();
         uint64_t slideWindow = 0;
-        pCdMan->pSysParamCache->GetParam(SysParamType::MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT, slideWindow);
+        spCw->sysParamCache.GetParam(SysParamType::MEDIAN_PRICE_SLIDE_WINDOW_BLOCKCOUNT, slideWindow);
         // TODO: multi stable coin
         uint64_t bcoinMedianPrice =
-            pCdMan->pPpCache->GetMedianPrice(height, slideWindow, CoinPricePair(SYMB::WICC, SYMB::USD));
+            spCw->ppCache.GetMedianPrice(height, slideWindow, CoinPricePair(SYMB::WICC, SYMB::USD));
         Array cdps;
         vector<CUserCDP> userCdps;
-        if (pCdMan->pCdpCache->GetCDPList(account.regid, userCdps)) {
+        if (spCw->cdpCache.GetCDPList(account.regid, userCdps)) {
             for (auto& cdp : userCdps) {
                 cdps.push_back(cdp.ToJson(bcoinMedianPrice));
             }
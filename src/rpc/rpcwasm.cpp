@@ -271,8 +271,9 @@ Value gettablewasm( const Array &params, bool fHelp ) {
     RPCTypeCheck(params, list_of(str_type)(str_type));
 
     try{
-        auto database_account  = pCdMan->pAccountCache;
-        auto database_contract = pCdMan->pContractCache;
+        auto spCw              = GetRPCChainSnapshot()->NewCacheWrapper();
+        auto database_account  = &spCw->accountCache;
+        auto database_contract = &spCw->contractCache;
         auto contract_name     = wasm::name(params[0].get_str());
         auto contract_table    = wasm::name(params[1].get_str());
 
@@ -295,6 +296,11 @@ Value gettablewasm( const Array &params, bool fHelp ) {
         JSON_RPC_ASSERT(pContractDataIt, RPC_INVALID_PARAMS,
                         "cannot get table from contract '%s'", contract_name.to_string())
 
+        auto   abis       = wasm::abi_serializer::get_serializer(abi, max_serialization_time);
+        string table_type = abis->get_table_type(contract_table.to_string());
+        JSON_RPC_ASSERT(table_type.size() > 0, RPC_INVALID_PARAMS,
+                        "can not get table %s's type from abi", contract_table.to_string())
+
         bool                hasMore = false;
         json_spirit::Object object_return;
         json_spirit::Array  row_json;
@@ -308,7 +314,7 @@ Value gettablewasm( const Array &params, bool fHelp ) {
 
             //unpack value in bytes to json
             std::vector<char> value_bytes(value.begin(), value.end());
-            json_spirit::Value   value_json  = wasm::abi_serializer::unpack(abi, contract_table.value, value_bytes, max_serialization_time);
+            json_spirit::Value   value_json  = abis->binary_to_variant(table_type, value_bytes, max_serialization_time);
             json_spirit::Object& object_json = value_json.get_obj();
 
             //append key and value
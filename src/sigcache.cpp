@@ -6,45 +6,164 @@
 
 #include "sigcache.h"
 
-void CSignatureCache::ComputeEntry(uint256& entry, const uint256& sigHash,
+#include "commons/random.h"
+#include "crypto/siphash.h"
+
+CSignatureCache::CSignatureCache() : bucketCount(0), hits(0), misses(0), inserts(0), evictions(0) {
+    memset(salt, 0, sizeof(salt));
+}
+
+size_t CSignatureCache::Setup(size_t maxBytes) {
+    uint256 seed0 = GetRandHash();
+    uint256 seed1 = GetRandHash();
+    salt[0] = seed0.GetUint64(0);
+    salt[1] = seed0.GetUint64(1);
+    salt[2] = seed1.GetUint64(0);
+    salt[3] = seed1.GetUint64(1);
+
+    bucketCount = maxBytes / sizeof(Bucket);
+    buckets.reset(bucketCount > 0 ? new Bucket[bucketCount] : nullptr);
+    for (uint64_t i = 0; i < bucketCount; i++) {
+        Bucket& bucket = buckets[i];
+        bucket.sequence.store(0, std::memory_order_relaxed);
+        bucket.cursor.store(0, std::memory_order_relaxed);
+        for (uint32_t k = 0; k < BUCKET_ENTRIES; k++) {
+            bucket.slots[k][0].store(0, std::memory_order_relaxed);
+            bucket.slots[k][1].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    return bucketCount * sizeof(Bucket);
+}
+
+void CSignatureCache::ComputeEntry(Entry& entry, const uint256& sigHash,
                                    const std::vector<unsigned char>& vchSig,
-                                   const CPubKey& pubKey) {
-    CSHA256()
-        .Write(sigHash.begin(), 32)
-        .Write(&pubKey[0], pubKey.size())
-        .Write(&vchSig[0], vchSig.size())
-        .Finalize(entry.begin());
+                                   const CPubKey& pubKey) const {
+    entry.first = CSipHasher(salt[0], salt[1])
+                      .Write(sigHash.begin(), 32)
+                      .Write(pubKey.begin(), pubKey.size())
+                      .Write(vchSig.data(), vchSig.size())
+                      .Finalize();
+    entry.second = CSipHasher(salt[2], salt[3])
+                       .Write(sigHash.begin(), 32)
+                       .Write(pubKey.begin(), pubKey.size())
+                       .Write(vchSig.data(), vchSig.size())
+                       .Finalize();
+    // (0, 0) is reserved for empty slots
+    if (entry.first == 0 && entry.second == 0)
+        entry.second = 1;
+}
+
+CSignatureCache::Bucket& CSignatureCache::GetBucket(uint64_t hash) const {
+    // map the hash onto [0, bucketCount) without a division
+    return buckets[(uint64_t)(((unsigned __int128)hash * bucketCount) >> 64)];
+}
+
+bool CSignatureCache::FindSlot(const Bucket& bucket, const Entry& entry, uint32_t& slot) {
+    for (slot = 0; slot < BUCKET_ENTRIES; slot++) {
+        if (bucket.slots[slot][0].load(std::memory_order_relaxed) == entry.first &&
+            bucket.slots[slot][1].load(std::memory_order_relaxed) == entry.second)
+            return true;
+    }
+    return false;
+}
+
+bool CSignatureCache::Contains(const Bucket& bucket, const Entry& entry) {
+    while (true) {
+        uint32_t sequence = bucket.sequence.load(std::memory_order_acquire);
+        if (sequence & 1)
+            continue;  // a writer is updating this bucket right now
+
+        uint32_t slot;
+        bool found = FindSlot(bucket, entry, slot);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (bucket.sequence.load(std::memory_order_relaxed) == sequence)
+            return found;
+    }
+}
+
+void CSignatureCache::LockBucket(Bucket& bucket) {
+    uint32_t sequence = bucket.sequence.load(std::memory_order_relaxed);
+    while ((sequence & 1) ||
+           !bucket.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+        sequence = bucket.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void CSignatureCache::UnlockBucket(Bucket& bucket) {
+    bucket.sequence.fetch_add(1, std::memory_order_release);
+}
+
+void CSignatureCache::WriteSlot(Bucket& bucket, uint32_t slot, const Entry& entry) {
+    bucket.slots[slot][0].store(entry.first, std::memory_order_relaxed);
+    bucket.slots[slot][1].store(entry.second, std::memory_order_relaxed);
 }
 
 bool CSignatureCache::Get(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
                           const CPubKey& pubKey) {
-    uint256 entry;
+    if (bucketCount == 0)
+        return false;
+
+    Entry entry;
     ComputeEntry(entry, sigHash, vchSig, pubKey);
-    std::unique_lock<std::mutex> lock(mtx);
-    return setValid.count(entry);
+    if (Contains(GetBucket(entry.first), entry) || Contains(GetBucket(entry.second), entry)) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
 void CSignatureCache::Set(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
                           const CPubKey& pubKey) {
-    static int64_t nMaxCacheSize = SysCfg().GetArg("-maxsigcachesize", 50000);
-    if (nMaxCacheSize <= 0) return;
+    if (bucketCount == 0)
+        return;
 
-    uint256 entry;
+    Entry entry;
     ComputeEntry(entry, sigHash, vchSig, pubKey);
+    static const Entry empty(0, 0);
+    uint32_t slot;
 
-    std::unique_lock<std::mutex> lock(mtx);
-
-    while (static_cast<int64_t>(setValid.size()) > nMaxCacheSize) {
-        // Evict a random entry. Random because that helps
-        // foil would-be DoS attackers who might try to pre-generate
-        // and re-use a set of valid signatures just-slightly-greater
-        // than our cache size.
-        UnorderedHashSet::size_type s       = GetRand(setValid.bucket_count());
-        UnorderedHashSet::local_iterator it = setValid.begin(s);
-        if (it != setValid.end(s)) {
-            setValid.erase(*it);
+    // prefer a free slot in either of the two candidate buckets
+    for (Bucket* pBucket : {&GetBucket(entry.first), &GetBucket(entry.second)}) {
+        LockBucket(*pBucket);
+        if (FindSlot(*pBucket, entry, slot)) {
+            UnlockBucket(*pBucket);
+            return;
         }
+        if (FindSlot(*pBucket, empty, slot)) {
+            WriteSlot(*pBucket, slot, entry);
+            UnlockBucket(*pBucket);
+            inserts.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        UnlockBucket(*pBucket);
     }
 
-    setValid.insert(entry);
+    // Both buckets are full, evict round-robin from the first one. The bucket an
+    // entry lands in depends on the secret salt, so would-be DoS attackers cannot
+    // pre-generate signatures which keep pushing each other out of the cache.
+    Bucket& bucket = GetBucket(entry.first);
+    LockBucket(bucket);
+    slot = bucket.cursor.load(std::memory_order_relaxed);
+    bucket.cursor.store((slot + 1) % BUCKET_ENTRIES, std::memory_order_relaxed);
+    WriteSlot(bucket, slot, entry);
+    UnlockBucket(bucket);
+
+    inserts.fetch_add(1, std::memory_order_relaxed);
+    evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+CSignatureCache::Stats CSignatureCache::GetStats() const {
+    Stats stats;
+    stats.hits      = hits.load(std::memory_order_relaxed);
+    stats.misses    = misses.load(std::memory_order_relaxed);
+    stats.inserts   = inserts.load(std::memory_order_relaxed);
+    stats.evictions = evictions.load(std::memory_order_relaxed);
+    stats.entries   = bucketCount * BUCKET_ENTRIES;
+    stats.bytes     = bucketCount * sizeof(Bucket);
+    return stats;
 }
@@ -7,38 +7,88 @@
 #ifndef COIN_SIGCACHE_H
 #define COIN_SIGCACHE_H
 
-#include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "config/chainparams.h"
-#include "crypto/sha256.h"
 #include "entities/key.h"
-#include "commons/random.h"
 #include "commons/uint256.h"
 #include "commons/util/util.h"
 
+/** -maxsigcachesize default (MiB) */
+static const int64_t DEFAULT_MAX_SIG_CACHE_SIZE = 32;
+/** max. -maxsigcachesize (MiB) */
+static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
+
 /**
  * Valid signature cache, to avoid doing expensive ECDSA signature checking
  * twice for every transaction (once when accepted into memory pool, and
  * again when accepted into the block chain)
+ *
+ * The cache is a fixed-size table of cache-line sized buckets. Every entry
+ * may live in one of two buckets, each bucket holds a few entries and is
+ * guarded by a sequence counter: lookups never take a lock (they retry when a
+ * writer touches the same bucket), inserts and evictions are O(1).
  */
 class CSignatureCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t inserts;
+        uint64_t evictions;
+        uint64_t entries;   //!< capacity in entries
+        uint64_t bytes;     //!< memory held by the table
+    };
+
 private:
-    //! Entries are SHA256(signature hash || public key || signature):
-    UnorderedHashSet setValid;
-    std::mutex mtx;
+    static const uint32_t BUCKET_ENTRIES = 3;
+
+    //! Entries are the 128-bit salted SipHash of (signature hash || public key || signature),
+    //! (0, 0) marks an empty slot.
+    typedef std::pair<uint64_t, uint64_t> Entry;
+
+    struct alignas(64) Bucket {
+        std::atomic<uint32_t> sequence;  //!< odd while a writer updates the bucket
+        std::atomic<uint32_t> cursor;    //!< next slot to evict once the bucket is full
+        std::atomic<uint64_t> slots[BUCKET_ENTRIES][2];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    uint64_t bucketCount;
+    uint64_t salt[4];
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> inserts;
+    std::atomic<uint64_t> evictions;
 
 public:
-    CSignatureCache() {}
+    CSignatureCache();
     ~CSignatureCache() {}
+
+    /** Allocate the table, must be called before any other thread uses the cache.
+     *  @return the number of bytes actually used (0 disables the cache) */
+    size_t Setup(size_t maxBytes);
+
     bool Get(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
              const CPubKey& pubKey);
     void Set(const uint256& sigHash, const std::vector<unsigned char>& vchSig,
              const CPubKey& pubKey);
 
+    Stats GetStats() const;
+
 private:
-    void ComputeEntry(uint256& entry, const uint256& sigHash,
-                      const std::vector<unsigned char>& vchSig, const CPubKey& pubKey);
+    void ComputeEntry(Entry& entry, const uint256& sigHash,
+                      const std::vector<unsigned char>& vchSig, const CPubKey& pubKey) const;
+    Bucket& GetBucket(uint64_t hash) const;
+
+    static bool Contains(const Bucket& bucket, const Entry& entry);
+    static void LockBucket(Bucket& bucket);
+    static void UnlockBucket(Bucket& bucket);
+    static bool FindSlot(const Bucket& bucket, const Entry& entry, uint32_t& slot);
+    static void WriteSlot(Bucket& bucket, uint32_t slot, const Entry& entry);
 };
 
-#endif  // COIN_SIGCACHE_H
\ No newline at end of file
+#endif  // COIN_SIGCACHE_H
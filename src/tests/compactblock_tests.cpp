@@ -0,0 +1,183 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/compactblock.h"
+#include "commons/random.h"
+#include "config/version.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+#include "tx/txmempool.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(compactblock_tests)
+
+// a block of a block reward tx followed by count transfer txs
+static CBlock MakeBlock(uint32_t count) {
+    CBlock block;
+    block.SetPrevBlockHash(GetRandHash());
+    block.SetHeight(100);
+    block.SetTime(1500000000);
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(CRegID(1, 1).GetRegIdRaw(), 0, 100));
+    for (uint32_t i = 0; i < count; i++) {
+        block.vptx.push_back(std::make_shared<CCoinTransferTx>(CRegID(1, 2), CRegID(1, 3), 100, SYMB::WICC,
+                                                               COIN + i, SYMB::WICC, 10000, strprintf("tx%u", i)));
+    }
+    block.SetMerkleRootHash(block.BuildMerkleTree());
+    return block;
+}
+
+static void AddToMempool(CTxMemPool &pool, const CBlock &block, uint32_t begin, uint32_t end) {
+    LOCK(pool.cs);
+    for (uint32_t i = begin; i < end; i++)
+        pool.memPoolTxs.emplace(block.vptx[i]->GetHash(), CTxMemPoolEntry(block.vptx[i].get(), 0, 100));
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_serialize) {
+    CBlock block = MakeBlock(10);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+    BOOST_CHECK_EQUAL(cmpctBlock.prefilledTxs.size(), 1U);
+    BOOST_CHECK_EQUAL(cmpctBlock.shortTxIds.size(), 10U);
+    for (uint64_t shortId : cmpctBlock.shortTxIds)
+        BOOST_CHECK_EQUAL(shortId >> (8 * SHORTTXIDS_LENGTH), 0U);
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << cmpctBlock;
+    CBlockHeaderAndShortTxIDs cmpctBlock2;
+    ss >> cmpctBlock2;
+    BOOST_CHECK(ss.empty());
+
+    BOOST_CHECK(cmpctBlock2.header.GetHash() == block.GetHash());
+    BOOST_CHECK(cmpctBlock2.shortTxIds == cmpctBlock.shortTxIds);
+    BOOST_REQUIRE_EQUAL(cmpctBlock2.prefilledTxs.size(), 1U);
+    BOOST_CHECK_EQUAL(cmpctBlock2.prefilledTxs[0].index, 0U);
+    BOOST_CHECK(cmpctBlock2.prefilledTxs[0].tx->GetHash() == block.vptx[0]->GetHash());
+
+    // the receiver derives the same short ids from the header and the nonce
+    for (uint32_t i = 1; i < block.vptx.size(); i++)
+        BOOST_CHECK_EQUAL(cmpctBlock2.GetShortID(block.vptx[i]->GetHash()), cmpctBlock.shortTxIds[i - 1]);
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_bad_shortids_length) {
+    CBlock block = MakeBlock(1);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << block.GetBlockHeader() << (uint64_t)0 << vector<uint8_t>(SHORTTXIDS_LENGTH + 1)
+       << vector<CPrefilledTx>();
+
+    CBlockHeaderAndShortTxIDs cmpctBlock;
+    BOOST_CHECK_THROW(ss >> cmpctBlock, std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_prefilled_indexes) {
+    CBlock block = MakeBlock(5);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+
+    // prefill txs 0 and 3, the index of the latter is relative to the former
+    cmpctBlock.shortTxIds.clear();
+    cmpctBlock.prefilledTxs.clear();
+    cmpctBlock.prefilledTxs.push_back(CPrefilledTx{0, block.vptx[0]});
+    cmpctBlock.prefilledTxs.push_back(CPrefilledTx{2, block.vptx[3]});
+    for (uint32_t i : {1, 2, 4, 5})
+        cmpctBlock.shortTxIds.push_back(cmpctBlock.GetShortID(block.vptx[i]->GetHash()));
+
+    CTxMemPool pool;
+    CPartialBlock partialBlock;
+    BOOST_REQUIRE(partialBlock.InitData(cmpctBlock, pool));
+    BOOST_CHECK(!partialBlock.IsComplete());
+
+    vector<uint32_t> indexes;
+    partialBlock.GetMissingIndexes(indexes);
+    BOOST_CHECK(indexes == vector<uint32_t>({1, 2, 4, 5}));
+
+    vector<std::shared_ptr<CBaseTx> > vMissingTx;
+    for (uint32_t i : indexes)
+        vMissingTx.push_back(block.vptx[i]);
+    CBlock block2;
+    BOOST_REQUIRE(partialBlock.FillBlock(block2, vMissingTx));
+    BOOST_CHECK(block2.GetHash() == block.GetHash());
+    BOOST_CHECK(block2.BuildMerkleTree() == block.GetMerkleRootHash());
+
+    // a prefilled index past the end of the block
+    cmpctBlock.prefilledTxs.push_back(CPrefilledTx{3, block.vptx[1]});
+    CPartialBlock partialBlock2;
+    BOOST_CHECK(!partialBlock2.InitData(cmpctBlock, pool));
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_fill_from_mempool) {
+    CBlock block = MakeBlock(20);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+
+    CTxMemPool pool;
+    AddToMempool(pool, block, 1, block.vptx.size());
+    CPartialBlock partialBlock;
+    BOOST_REQUIRE(partialBlock.InitData(cmpctBlock, pool));
+    BOOST_CHECK(partialBlock.IsComplete());
+
+    CBlock block2;
+    BOOST_REQUIRE(partialBlock.FillBlock(block2, vector<std::shared_ptr<CBaseTx> >()));
+    BOOST_CHECK(block2.GetHash() == block.GetHash());
+    BOOST_CHECK(block2.BuildMerkleTree() == block.GetMerkleRootHash());
+    // the rebuilt block does not share the tx objects with the mempool
+    BOOST_CHECK(block2.vptx[1] != pool.memPoolTxs[block.vptx[1]->GetHash()].GetTransaction());
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_fill_missing) {
+    CBlock block = MakeBlock(20);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+
+    CTxMemPool pool;
+    AddToMempool(pool, block, 1, 15);
+    CPartialBlock partialBlock;
+    BOOST_REQUIRE(partialBlock.InitData(cmpctBlock, pool));
+    BOOST_CHECK(!partialBlock.IsComplete());
+
+    vector<uint32_t> indexes;
+    partialBlock.GetMissingIndexes(indexes);
+    BOOST_CHECK(indexes == vector<uint32_t>({15, 16, 17, 18, 19, 20}));
+
+    vector<std::shared_ptr<CBaseTx> > vMissingTx;
+    for (uint32_t i : indexes)
+        vMissingTx.push_back(block.vptx[i]);
+
+    // too few txs
+    CBlock block2;
+    BOOST_CHECK(!partialBlock.FillBlock(block2,
+        vector<std::shared_ptr<CBaseTx> >(vMissingTx.begin(), vMissingTx.end() - 1)));
+
+    // the right txs in the wrong order don't match the merkle root
+    vector<std::shared_ptr<CBaseTx> > vSwapped(vMissingTx);
+    std::swap(vSwapped[0], vSwapped[1]);
+    BOOST_CHECK(!partialBlock.FillBlock(block2, vSwapped));
+
+    BOOST_REQUIRE(partialBlock.FillBlock(block2, vMissingTx));
+    BOOST_CHECK(block2.GetHash() == block.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(compactblock_shortid_collision) {
+    CBlock block = MakeBlock(5);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+
+    // txs 1 and 2 are announced with the same short id, neither can be taken from the mempool
+    cmpctBlock.shortTxIds[1] = cmpctBlock.shortTxIds[0];
+
+    CTxMemPool pool;
+    AddToMempool(pool, block, 1, block.vptx.size());
+    CPartialBlock partialBlock;
+    BOOST_REQUIRE(partialBlock.InitData(cmpctBlock, pool));
+
+    vector<uint32_t> indexes;
+    partialBlock.GetMissingIndexes(indexes);
+    BOOST_CHECK(indexes == vector<uint32_t>({1, 2}));
+
+    CBlock block2;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {block.vptx[1], block.vptx[2]}));
+    BOOST_CHECK(block2.GetHash() == block.GetHash());
+
+    // a wrong tx sent for a slot, like one picked by a collision, fails the merkle check
+    BOOST_CHECK(!partialBlock.FillBlock(block2, {block.vptx[1], block.vptx[3]}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -60,6 +60,44 @@ BOOST_AUTO_TEST_CASE(dbaccess_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(dbaccess_snapshot_test)
+{
+    bool isWipe = true;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    map<string, string> mapData;
+    mapData["regid-1"] = "keyid-1";
+    mapData["regid-2"] = "keyid-2";
+    pDBAccess->BatchWrite<string, string>(prefix, mapData);
+
+    CDBAccess snapshot(pDBAccess.get());
+
+    // writes after the snapshot is taken are not seen by it, neither by reads nor iterators
+    mapData.clear();
+    mapData["regid-1"] = "keyid-1-new";
+    mapData["regid-2"] = "";
+    mapData["regid-3"] = "keyid-3";
+    pDBAccess->BatchWrite<string, string>(prefix, mapData);
+
+    string value;
+    BOOST_CHECK(snapshot.GetData(prefix, string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(snapshot.GetData(prefix, string("regid-2"), value) && value == "keyid-2");
+    BOOST_CHECK(!snapshot.GetData(prefix, string("regid-3"), value));
+
+    map<string, string> elements;
+    BOOST_CHECK(snapshot.GetAllElements(prefix, elements));
+    BOOST_CHECK(elements.size() == 2 && elements["regid-1"] == "keyid-1");
+
+    BOOST_CHECK(pDBAccess->GetData(prefix, string("regid-1"), value) && value == "keyid-1-new");
+    BOOST_CHECK(!pDBAccess->GetData(prefix, string("regid-2"), value));
+
+    // a cache on the snapshot reads it the same way
+    CCompositeKVCache<prefix, string, string> snapshotCache(&snapshot);
+    BOOST_CHECK(snapshotCache.GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(!snapshotCache.HaveData(string("regid-3")));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -157,6 +195,40 @@ static uint32_t GetCacheSerializeSize(CacheType &cache) {
     return ret;
 }
 
+BOOST_AUTO_TEST_CASE(dbcache_iterator_seek_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    typedef CCompositeKVCache<prefix, string, string> CacheType;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared<CacheType>(pDBAccess.get());
+    pDBCache1->SetData("regid-1", "keyid-1");
+    pDBCache1->SetData("regid-3", "keyid-3");
+    pDBCache1->SetData("regid-5", "keyid-5");
+    pDBCache1->Flush();
+
+    // uncommitted layer on top of the db
+    auto pDBCache2 = make_shared<CacheType>(pDBCache1.get());
+    pDBCache2->SetData("regid-2", "keyid-2");
+    pDBCache2->EraseData("regid-3");
+
+    CDBIterator<CacheType> it(*pDBCache2);
+    string key = "regid-2";
+    BOOST_CHECK(it.SeekLower(&key) && it.GetKey() == "regid-2" && it.GetValue() == "keyid-2");
+    BOOST_CHECK(it.SeekUpper(&key) && it.GetKey() == "regid-5");
+
+    key = "regid-3";
+    BOOST_CHECK(it.SeekLower(&key) && it.GetKey() == "regid-5");
+    BOOST_CHECK(!it.Next() && !it.IsValid());
+
+    key = "regid-0";
+    BOOST_CHECK(it.SeekLower(&key) && it.GetKey() == "regid-1");
+    BOOST_CHECK(it.Next() && it.GetKey() == "regid-2");
+    BOOST_CHECK(it.Next() && it.GetKey() == "regid-5");
+}
+
 BOOST_AUTO_TEST_CASE(dbcache_cache_size_test)
 {
     const bool isWipe = true;
@@ -181,4 +253,69 @@ BOOST_AUTO_TEST_CASE(dbcache_cache_size_test)
     BOOST_CHECK(!pDBCache2->IsCalcSize() && pDBCache2->GetCacheSize() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(dbcache_hot_cache_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache->SetHotCacheSize(1024 * 1024);
+    pDBCache->SetData("regid-1", "keyid-1");
+    pDBCache->Flush();
+
+    // the first db read makes the key a candidate, the second one admits it
+    string value;
+    BOOST_CHECK(pDBCache->GetData("regid-1", value) && value == "keyid-1");
+    BOOST_CHECK(!pDBCache->GetData("regid-9", value));
+    pDBCache->Flush();
+    BOOST_CHECK(pDBCache->GetData("regid-1", value) && value == "keyid-1");
+    BOOST_CHECK(!pDBCache->GetData("regid-9", value));
+    pDBCache->Flush();
+
+    // admitted keys and misses are served from memory, a write behind the cache's back isn't seen
+    map<string, string> mapData = {{"regid-1", "keyid-x"}, {"regid-9", "keyid-9"}};
+    pDBAccess->BatchWrite<string, string>(prefix, mapData);
+    BOOST_CHECK(pDBCache->GetData("regid-1", value) && value == "keyid-1");
+    BOOST_CHECK(!pDBCache->GetData("regid-9", value));
+    pDBCache->Clear();
+
+    // flushes write through
+    pDBCache->SetData("regid-1", "keyid-2");
+    pDBCache->EraseData("regid-9");
+    pDBCache->SetData("regid-9", "keyid-9");
+    pDBCache->Flush();
+    BOOST_CHECK(pDBCache->GetData("regid-1", value) && value == "keyid-2");
+    BOOST_CHECK(pDBCache->GetData("regid-9", value) && value == "keyid-9");
+    pDBCache->Flush();
+
+    pDBCache->EraseData("regid-1");
+    pDBCache->Flush();
+    BOOST_CHECK(!pDBCache->GetData("regid-1", value));
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_hot_cache_drops_stale_reads)
+{
+    CDBHotCache<string, string> hotCache(1024 * 1024);
+    string value;
+
+    // a value read before a flush is not admitted after it
+    uint64_t generation = hotCache.GetGeneration();
+    hotCache.Admit("regid-1", "keyid-1", generation);
+    generation = hotCache.GetGeneration();
+    hotCache.Update({{"regid-1", "keyid-2"}});
+    hotCache.Admit("regid-1", "keyid-1", generation);
+    BOOST_CHECK(!hotCache.Get("regid-1", value));
+
+    // nor does it make the key a candidate
+    uint64_t staleGeneration = generation;
+    generation = hotCache.GetGeneration();
+    hotCache.Admit("regid-2", "keyid-2", staleGeneration);
+    hotCache.Admit("regid-2", "keyid-2", generation);
+    BOOST_CHECK(!hotCache.Get("regid-2", value));
+    hotCache.Admit("regid-2", "keyid-2", generation);
+    BOOST_CHECK(hotCache.Get("regid-2", value) && value == "keyid-2");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
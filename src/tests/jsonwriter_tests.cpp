@@ -0,0 +1,87 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/core/jsonwriter.h"
+#include "commons/json/json_spirit_writer_template.h"
+
+#include <cstdint>
+#include <limits>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace json_spirit;
+
+static string WriteAll(const Value &value) {
+    CJSONWriter writer;
+    writer.Write(value);
+    return writer.GetBuffer();
+}
+
+static Value SampleValue() {
+    Object obj;
+    obj.push_back(Pair("hash", "d640d051704155b1fd3ec8d0331497448c259b0ab0499e109da7ae2bc7423bc2"));
+    obj.push_back(Pair("escaped", "quote\" backslash\\ \b\f\n\r\t del\x7f ctrl\x01 high\xe4\xb8\xad"));
+    obj.push_back(Pair("empty", ""));
+    obj.push_back(Pair("zero", 0));
+    obj.push_back(Pair("negative", -1234567));
+    obj.push_back(Pair("int64_min", numeric_limits<int64_t>::min()));
+    obj.push_back(Pair("int64_max", numeric_limits<int64_t>::max()));
+    obj.push_back(Pair("uint64_max", numeric_limits<uint64_t>::max()));
+    obj.push_back(Pair("real", 1.5));
+    obj.push_back(Pair("negative_real", -0.000000015));
+    obj.push_back(Pair("big_real", 1e20));
+    obj.push_back(Pair("true", true));
+    obj.push_back(Pair("false", false));
+    obj.push_back(Pair("null", Value::null));
+    obj.push_back(Pair("empty_array", Array()));
+    obj.push_back(Pair("empty_object", Object()));
+
+    Array arr;
+    for (int32_t i = 0; i < 100; i++) {
+        Object item;
+        item.push_back(Pair("index", i));
+        item.push_back(Pair("nested", Array{Value(i), Value("x"), Value(Object())}));
+        arr.push_back(item);
+    }
+    obj.push_back(Pair("items", arr));
+    return obj;
+}
+
+BOOST_AUTO_TEST_SUITE(jsonwriter_tests)
+
+BOOST_AUTO_TEST_CASE(jsonwriter_matches_json_spirit) {
+    Value value = SampleValue();
+    BOOST_CHECK_EQUAL(WriteAll(value), write_string(value, false));
+
+    for (const auto &item : value.get_obj())
+        BOOST_CHECK_EQUAL(WriteAll(item.value_), write_string(item.value_, false));
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_flushes_in_chunks) {
+    Value value = SampleValue();
+    string chunks;
+    size_t count = 0;
+    CJSONWriter writer(64, [&](const string &chunk) {
+        BOOST_CHECK(!chunk.empty());
+        chunks += chunk;
+        count++;
+    });
+    writer.WriteRaw("{\"result\":");
+    writer.Write(value);
+    writer.WriteRaw("}\n");
+    BOOST_CHECK(writer.Flushed());
+    writer.Flush();
+    BOOST_CHECK(writer.GetBuffer().empty());
+
+    BOOST_CHECK(count > 1);
+    BOOST_CHECK_EQUAL(chunks, "{\"result\":" + write_string(value, false) + "}\n");
+
+    // nothing is flushed below the flush size
+    CJSONWriter small(1024 * 1024, [&](const string &chunk) { BOOST_ERROR("unexpected flush"); });
+    small.Write(value);
+    BOOST_CHECK(!small.Flushed());
+    BOOST_CHECK_EQUAL(small.GetBuffer(), write_string(value, false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/lrucache.h"
+
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(commons_lrucache_tests)
+
+BOOST_AUTO_TEST_CASE(lrucache_evicts_least_recently_used) {
+    lrucache<int, string> cache(3);
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+    cache.insert(3, "three");
+    BOOST_CHECK_EQUAL(cache.size(), 3U);
+
+    // touch 1, so 2 becomes the least recently used
+    BOOST_CHECK(cache.find(1) != nullptr);
+    cache.insert(4, "four");
+    BOOST_CHECK_EQUAL(cache.size(), 3U);
+    BOOST_CHECK(cache.find(2) == nullptr);
+    BOOST_CHECK_EQUAL(*cache.find(1), "one");
+    BOOST_CHECK_EQUAL(*cache.find(4), "four");
+
+    cache.insert(4, "FOUR");
+    BOOST_CHECK_EQUAL(cache.size(), 3U);
+    BOOST_CHECK_EQUAL(*cache.find(4), "FOUR");
+
+    BOOST_CHECK(cache.erase(3));
+    BOOST_CHECK(!cache.erase(3));
+    BOOST_CHECK_EQUAL(cache.size(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(lrucache_cost_budget) {
+    lrucache<int, int> cache(100);
+    cache.insert(1, 1, 40);
+    cache.insert(2, 2, 40);
+    BOOST_CHECK_EQUAL(cache.cost(), 80U);
+
+    cache.insert(3, 3, 40);
+    BOOST_CHECK_EQUAL(cache.cost(), 80U);
+    BOOST_CHECK(!cache.count(1));
+
+    // never kept, and does not flush the rest
+    cache.insert(4, 4, 101);
+    BOOST_CHECK(!cache.count(4));
+    BOOST_CHECK_EQUAL(cache.size(), 2U);
+
+    cache.max_cost(40);
+    BOOST_CHECK_EQUAL(cache.size(), 1U);
+    BOOST_CHECK(cache.count(3));
+
+    cache.clear();
+    BOOST_CHECK(cache.empty());
+    BOOST_CHECK_EQUAL(cache.cost(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/luavm/luabytecode.h"
+#include "vm/luavm/lua/lua.hpp"
+
+#include <memory>
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+static const unsigned long long FUEL_LIMIT = 1000000;
+
+static const string CONTRACT_A =
+    "local function add(a, b) return a + b end\n"
+    "local t = {}\n"
+    "for i = 1, 10 do t[i] = add(i, 1) end\n"
+    "return t\n";
+
+static const string CONTRACT_B =
+    "local s = \"contract b\"\n"
+    "return #s\n";
+
+/** Load the contract in a fresh metered state, the fuel burned by the load */
+static unsigned long long LoadBurned(const string &code, CLuaBytecodeCache &cache,
+                                     unsigned long long limit = FUEL_LIMIT) {
+    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+    BOOST_REQUIRE(lua_state_ptr);
+    lua_State *L = lua_state_ptr.get();
+    BOOST_REQUIRE(lua_StartBurner(L, nullptr, limit, BURN_VER_R4));
+
+    int ret = LoadLuaContract(L, code, BURN_VER_R4, cache);
+    BOOST_CHECK_EQUAL(ret, LUA_OK);
+    BOOST_CHECK(lua_isfunction(L, -1));
+    return lua_GetBurnedFuel(L);
+}
+
+BOOST_AUTO_TEST_SUITE(luabytecode_tests)
+
+BOOST_AUTO_TEST_CASE(luabytecode_hit_miss_eviction_burn_the_same) {
+    std::shared_ptr<const string> bytecodeA, bytecodeB;
+    string strError;
+    {
+        CLuaBytecodeCache probe(1 << 20);
+        BOOST_REQUIRE(probe.Get(CONTRACT_A, bytecodeA, strError));
+        BOOST_REQUIRE(probe.Get(CONTRACT_B, bytecodeB, strError));
+    }
+    // room for one chunk only
+    CLuaBytecodeCache cache(std::max(bytecodeA->size(), bytecodeB->size()));
+
+    BOOST_CHECK(!cache.Contains(CONTRACT_A));
+    unsigned long long missFuel = LoadBurned(CONTRACT_A, cache);
+    BOOST_CHECK(cache.Contains(CONTRACT_A));
+    BOOST_CHECK(missFuel > 0);
+
+    unsigned long long hitFuel = LoadBurned(CONTRACT_A, cache);
+    BOOST_CHECK_EQUAL(hitFuel, missFuel);
+
+    // evicts CONTRACT_A
+    LoadBurned(CONTRACT_B, cache);
+    BOOST_CHECK(cache.Contains(CONTRACT_B));
+    BOOST_CHECK(!cache.Contains(CONTRACT_A));
+
+    unsigned long long evictedFuel = LoadBurned(CONTRACT_A, cache);
+    BOOST_CHECK_EQUAL(evictedFuel, missFuel);
+    BOOST_CHECK(cache.Contains(CONTRACT_A));
+}
+
+BOOST_AUTO_TEST_CASE(luabytecode_parse_is_burned_by_source_size) {
+    CLuaBytecodeCache cache(1 << 20);
+    unsigned long long parseFuel = lua_CalcFuelBySize(CONTRACT_A.size(), BURN_MEM_UNIT_SIZE, FUEL_DATA32_CodeLoad);
+
+    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+    lua_State *L = lua_state_ptr.get();
+    BOOST_REQUIRE(lua_StartBurner(L, nullptr, FUEL_LIMIT, BURN_VER_R4));
+    BOOST_CHECK_EQUAL(LoadLuaContract(L, CONTRACT_A, BURN_VER_R4, cache), LUA_OK);
+    BOOST_CHECK_EQUAL(lua_GetBurnerState(L)->fuelFunction, parseFuel);
+
+    // burned out before anything is compiled
+    CLuaBytecodeCache emptyCache(1 << 20);
+    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr2(luaL_newstate(), &lua_close);
+    L = lua_state_ptr2.get();
+    BOOST_REQUIRE(lua_StartBurner(L, nullptr, parseFuel - 1, BURN_VER_R4));
+    BOOST_CHECK_EQUAL(LoadLuaContract(L, CONTRACT_A, BURN_VER_R4, emptyCache), LUA_ERR_BURNEDOUT);
+    BOOST_CHECK(!emptyCache.Contains(CONTRACT_A));
+}
+
+BOOST_AUTO_TEST_CASE(luabytecode_syntax_error_is_not_cached) {
+    CLuaBytecodeCache cache(1 << 20);
+    string badCode = "local x = = 1\n";
+
+    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+    lua_State *L = lua_state_ptr.get();
+    BOOST_REQUIRE(lua_StartBurner(L, nullptr, FUEL_LIMIT, BURN_VER_R4));
+    BOOST_CHECK_EQUAL(LoadLuaContract(L, badCode, BURN_VER_R4, cache), LUA_ERRSYNTAX);
+    BOOST_CHECK(lua_isstring(L, -1));
+    BOOST_CHECK(!cache.Contains(badCode));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
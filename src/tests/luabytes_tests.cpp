@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/luavm/luabytes.h"
+#include "commons/serialize.h"
+#include "config/version.h"
+
+#include <memory>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+// the CDataStream based conversions the mylib functions used before luabytes.h
+static uint256 LegacyBytesToHash(const vector<uint8_t> &data) {
+    vector<uint8_t> vHash(data.rbegin(), data.rend());
+    CDataStream ds(vHash, SER_DISK, CLIENT_VERSION);
+    uint256 hash;
+    ds >> hash;
+    return hash;
+}
+
+static vector<uint8_t> LegacyHashToBytes(const uint256 &hash) {
+    CDataStream tep(SER_DISK, CLIENT_VERSION);
+    tep << hash;
+    vector<uint8_t> tep1(tep.begin(), tep.end());
+    return vector<uint8_t>(tep1.rbegin(), tep1.rend());
+}
+
+template <typename T>
+static vector<uint8_t> LegacyIntegerToBytes(T value) {
+    CDataStream tep(SER_DISK, CLIENT_VERSION);
+    tep << value;
+    return vector<uint8_t>(tep.begin(), tep.end());
+}
+
+static uint256 SampleHash() {
+    uint256 hash;
+    for (size_t i = 0; i < hash.size(); i++)
+        hash.begin()[i] = (uint8_t)(i * 37 + 11);
+    return hash;
+}
+
+static vector<uint8_t> PoppedBytes(lua_State *L) {
+    vector<uint8_t> ret;
+    for (int32_t i = 1; i <= lua_gettop(L); i++)
+        ret.push_back((uint8_t)lua_tointeger(L, i));
+    lua_settop(L, 0);
+    return ret;
+}
+
+struct LuaState {
+    std::unique_ptr<lua_State, decltype(&lua_close)> ptr;
+    LuaState() : ptr(luaL_newstate(), &lua_close) {}
+    lua_State *get() { return ptr.get(); }
+};
+
+BOOST_AUTO_TEST_SUITE(luabytes_tests)
+
+BOOST_AUTO_TEST_CASE(luabytes_match_datastream) {
+    LuaState state;
+    lua_State *L = state.get();
+
+    uint256 hash = SampleHash();
+    vector<uint8_t> bytes = LegacyHashToBytes(hash);
+    BOOST_CHECK(PushHashToLua(L, hash) == 32);
+    BOOST_CHECK(PoppedBytes(L) == bytes);
+
+    BOOST_CHECK(BytesToHash(bytes.data()) == LegacyBytesToHash(bytes));
+    BOOST_CHECK(BytesToHash(bytes.data()) == hash);
+
+    for (auto byte : bytes)
+        lua_pushinteger(L, byte);
+    uint8_t buf[LUA_C_BUFFER_SIZE];
+    int32_t len = 0;
+    BOOST_CHECK(GetBytesFromLua(L, buf, len));
+    BOOST_CHECK(vector<uint8_t>(buf, buf + len) == bytes);
+    lua_settop(L, 0);
+
+    BOOST_CHECK(!GetBytesFromLua(L, buf, len));
+    lua_pushstring(L, "not a number");
+    BOOST_CHECK(!GetBytesFromLua(L, buf, len));
+    lua_settop(L, 0);
+
+    PushUint32ToLua(L, 0x12345678);
+    BOOST_CHECK(PoppedBytes(L) == LegacyIntegerToBytes<int32_t>(0x12345678));
+    PushUint64ToLua(L, 0x0123456789abcdefULL);
+    BOOST_CHECK(PoppedBytes(L) == LegacyIntegerToBytes<uint64_t>(0x0123456789abcdefULL));
+    PushUint64ToLua(L, (uint64_t)-2);
+    BOOST_CHECK(PoppedBytes(L) == LegacyIntegerToBytes<int64_t>(-2));
+
+    // results are truncated at LUA_C_BUFFER_SIZE unless told otherwise
+    vector<uint8_t> blob(LUA_C_BUFFER_SIZE + 10, 7);
+    BOOST_CHECK_EQUAL(PushBytesToLua(L, blob.data(), blob.size()), LUA_C_BUFFER_SIZE);
+    lua_settop(L, 0);
+    BOOST_CHECK_EQUAL(PushBytesToLua(L, blob.data(), blob.size(), false), (int32_t)blob.size());
+    lua_settop(L, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
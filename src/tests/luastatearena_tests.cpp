@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "vm/luavm/luastatearena.h"
+#include "vm/luavm/lua/lua.hpp"
+
+#include <cstring>
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+static const string CONTRACT =
+    "local t = {}\n"
+    "for i = 1, 2000 do t[i] = tostring(i) .. \"-\" .. string.rep(\"x\", i % 64) end\n"
+    "local s = table.concat(t, \",\")\n"
+    "return #s\n";
+
+/** Run the contract in a state on the arena, the length it returns */
+static lua_Integer RunOnArena(CLuaStateArena &arena) {
+    lua_State *L = lua_newstate(&CLuaStateArena::Alloc, &arena);
+    BOOST_REQUIRE(L != nullptr);
+    luaL_openlibs(L);
+    BOOST_REQUIRE_EQUAL(luaL_loadbuffer(L, CONTRACT.c_str(), CONTRACT.size(), "line"), LUA_OK);
+    BOOST_REQUIRE_EQUAL(lua_pcall(L, 0, 1, 0), LUA_OK);
+    lua_Integer ret = lua_tointeger(L, -1);
+    lua_close(L);
+    arena.Reset();
+    return ret;
+}
+
+BOOST_AUTO_TEST_SUITE(luastatearena_tests)
+
+BOOST_AUTO_TEST_CASE(luastatearena_reuses_slabs_across_runs) {
+    CLuaStateArena arena;
+    lua_Integer expected = RunOnArena(arena);
+    size_t nSlabs = arena.GetSlabCount();
+    BOOST_CHECK(nSlabs > 0);
+    BOOST_CHECK(nSlabs <= CLuaStateArena::MAX_RETAINED_SLABS);
+    BOOST_CHECK_EQUAL(arena.GetSlabsInUse(), 0U);
+
+    // the same run neither needs new slabs nor behaves differently
+    for (int i = 0; i < 5; i++) {
+        BOOST_CHECK_EQUAL(RunOnArena(arena), expected);
+        BOOST_CHECK_EQUAL(arena.GetSlabCount(), nSlabs);
+        BOOST_CHECK_EQUAL(arena.GetSlabsInUse(), 0U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(luastatearena_recycles_freed_blocks) {
+    CLuaStateArena arena;
+    void *block = CLuaStateArena::Alloc(&arena, nullptr, LUA_TSTRING, 40);
+    BOOST_REQUIRE(block != nullptr);
+    CLuaStateArena::Alloc(&arena, block, 40, 0);
+
+    // same size class
+    void *again = CLuaStateArena::Alloc(&arena, nullptr, LUA_TTABLE, 48);
+    BOOST_CHECK_EQUAL(again, block);
+    // growing within the class keeps the block
+    BOOST_CHECK_EQUAL(CLuaStateArena::Alloc(&arena, again, 48, 33), again);
+    CLuaStateArena::Alloc(&arena, again, 33, 0);
+    arena.Reset();
+}
+
+BOOST_AUTO_TEST_CASE(luastatearena_realloc_keeps_contents) {
+    CLuaStateArena arena;
+    char *block = static_cast<char *>(CLuaStateArena::Alloc(&arena, nullptr, 0, 24));
+    BOOST_REQUIRE(block != nullptr);
+    memcpy(block, "0123456789abcdefghijklm", 24);
+
+    // small to small of another class, to large, shrinking back to small
+    const size_t sizes[] = {200, 4096, 1000, 64, 24};
+    size_t osize = 24;
+    for (size_t nsize : sizes) {
+        block = static_cast<char *>(CLuaStateArena::Alloc(&arena, block, osize, nsize));
+        BOOST_REQUIRE(block != nullptr);
+        BOOST_CHECK_EQUAL(string(block), "0123456789abcdefghijklm");
+        osize = nsize;
+    }
+    CLuaStateArena::Alloc(&arena, block, osize, 0);
+    arena.Reset();
+    BOOST_CHECK_EQUAL(arena.GetSlabsInUse(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
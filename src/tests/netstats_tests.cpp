@@ -0,0 +1,47 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/netstats.h"
+#include "p2p/protocol.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(netstats_tests)
+
+BOOST_AUTO_TEST_CASE(netstats_msg_types) {
+    size_t nOther = GetNetMsgTypes().size();
+    BOOST_CHECK(GetNetMsgTypeIndex(NetMsgType::BLOCK) < nOther);
+    BOOST_CHECK_EQUAL(GetNetMsgTypeName(GetNetMsgTypeIndex(NetMsgType::BLOCK)), NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(GetNetMsgTypeIndex("nosuchcmd"), nOther);
+    BOOST_CHECK_EQUAL(GetNetMsgTypeName(nOther), "*other*");
+
+    CNetMsgStats stats;
+    BOOST_CHECK_EQUAL(stats.size(), nOther + 1);
+    stats.Received(nOther, 100, 7);
+    stats.Received(nOther, 50, 3);
+    stats.Sent(0, 24);
+    BOOST_CHECK_EQUAL(stats[nOther].nMsgsRecv, 2U);
+    BOOST_CHECK_EQUAL(stats[nOther].nBytesRecv, 150U);
+    BOOST_CHECK_EQUAL(stats[nOther].nProcessTime, 10U);
+    BOOST_CHECK_EQUAL(stats[0].nMsgsSent, 1U);
+    BOOST_CHECK_EQUAL(stats[0].nBytesSent, 24U);
+}
+
+BOOST_AUTO_TEST_CASE(netstats_histogram) {
+    CStatsHistogram histogram;
+    histogram.Add(0);
+    histogram.Add(1);
+    histogram.Add(3);
+    histogram.Add(4);
+    histogram.Add(UINT64_MAX);
+
+    BOOST_CHECK_EQUAL(histogram.Count(), 5U);
+    BOOST_CHECK_EQUAL(histogram.Bucket(0), 1U);  // below 1
+    BOOST_CHECK_EQUAL(histogram.Bucket(1), 1U);  // below 2
+    BOOST_CHECK_EQUAL(histogram.Bucket(2), 1U);  // below 4
+    BOOST_CHECK_EQUAL(histogram.Bucket(3), 1U);  // below 8
+    BOOST_CHECK_EQUAL(histogram.Bucket(STATS_HISTOGRAM_BUCKETS - 1), 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/core/rpccache.h"
+
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace json_spirit;
+
+static Array MakeParams(const Value &first, const Value &second) {
+    Array params;
+    params.push_back(first);
+    params.push_back(second);
+    return params;
+}
+
+static shared_ptr<const string> MakeJSON(const string &text) { return make_shared<const string>(text); }
+
+BOOST_AUTO_TEST_SUITE(rpc_rpccache_tests)
+
+BOOST_AUTO_TEST_CASE(rpccache_drops_tip_entries_on_tip_change) {
+    CRPCResponseCache cache(1 << 20);
+    uint256 tip1 = uint256S("01"), tip2 = uint256S("02");
+    Array params = MakeParams(Value(10), Value(true));
+
+    CRPCCacheKey key;
+    // nothing is cached before the tip is known
+    BOOST_CHECK(!cache.GetKey("getblock", params, RPC_CACHE_TIP, tip1, key));
+
+    cache.SetTip(tip1);
+    // nor while the chain state the queries read lags behind it
+    BOOST_CHECK(!cache.GetKey("getblock", params, RPC_CACHE_TIP, tip2, key));
+    BOOST_CHECK(!cache.GetKey("getblock", params, RPC_CACHE_NONE, tip1, key));
+    BOOST_CHECK(cache.GetKey("getblock", params, RPC_CACHE_TIP, tip1, key));
+    BOOST_CHECK(!key.fImmutable);
+
+    shared_ptr<const string> spResult;
+    BOOST_CHECK(!cache.Get(key, spResult));
+    cache.Put(key, MakeJSON("\"block at 10\""));
+    BOOST_CHECK(cache.Get(key, spResult));
+    BOOST_CHECK_EQUAL(*spResult, "\"block at 10\"");
+
+    // other params don't match
+    CRPCCacheKey otherKey;
+    BOOST_CHECK(cache.GetKey("getblock", MakeParams(Value(10), Value(false)), RPC_CACHE_TIP, tip1, otherKey));
+    BOOST_CHECK(!cache.Get(otherKey, spResult));
+
+    cache.SetTip(tip2);
+    BOOST_CHECK(!cache.Get(key, spResult));
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+
+    // a result computed at the previous tip is not kept
+    cache.Put(key, MakeJSON("\"block at 10\""));
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(rpccache_keeps_raw_data_across_tips) {
+    CRPCResponseCache cache(1 << 20);
+    uint256 tip1 = uint256S("01"), tip2 = uint256S("02");
+    cache.SetTip(tip1);
+
+    CRPCCacheKey rawKey, verboseKey;
+    BOOST_CHECK(cache.GetKey("getblock", MakeParams(Value("ab01"), Value(false)), RPC_CACHE_RAWDATA, tip1, rawKey));
+    BOOST_CHECK(rawKey.fImmutable);
+    BOOST_CHECK(cache.GetKey("getblock", MakeParams(Value("ab01"), Value(true)), RPC_CACHE_RAWDATA, tip1, verboseKey));
+    BOOST_CHECK(!verboseKey.fImmutable);
+
+    cache.Put(rawKey, MakeJSON("\"00aa\""));
+    cache.Put(verboseKey, MakeJSON("{\"hash\":\"ab01\"}"));
+    cache.SetTip(tip2);
+
+    shared_ptr<const string> spResult;
+    BOOST_CHECK(cache.Get(rawKey, spResult));
+    BOOST_CHECK_EQUAL(*spResult, "\"00aa\"");
+    BOOST_CHECK(!cache.Get(verboseKey, spResult));
+
+    // raw data is cached even while the chain state lags behind the tip
+    CRPCCacheKey laggingKey;
+    BOOST_CHECK(cache.GetKey("getblock", MakeParams(Value("ab01"), Value(false)), RPC_CACHE_RAWDATA, tip1, laggingKey));
+    BOOST_CHECK(cache.Get(laggingKey, spResult));
+}
+
+BOOST_AUTO_TEST_CASE(rpccache_is_bounded) {
+    // each part of the cache gets half of the budget, charged by the size of the json text
+    CRPCResponseCache cache(2000);
+    uint256 tip = uint256S("01");
+    cache.SetTip(tip);
+
+    CRPCCacheKey bigKey, smallKey;
+    BOOST_CHECK(cache.GetKey("getscoininfo", Array(), RPC_CACHE_TIP, tip, bigKey));
+    cache.Put(bigKey, MakeJSON(string(1000, 'x')));
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+
+    BOOST_CHECK(cache.GetKey("getblockcount", Array(), RPC_CACHE_TIP, tip, smallKey));
+    cache.Put(smallKey, MakeJSON("100"));
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+
+    CRPCResponseCache disabled(0);
+    disabled.SetTip(tip);
+    BOOST_CHECK(!disabled.GetKey("getblockcount", Array(), RPC_CACHE_TIP, tip, smallKey));
+}
+
+BOOST_AUTO_TEST_CASE(rpccache_skip_is_per_call) {
+    BOOST_CHECK(!TakeRPCResponseCacheSkipped());
+    SkipRPCResponseCache();
+    BOOST_CHECK(TakeRPCResponseCacheSkipped());
+    // taking it resets it for the next call
+    BOOST_CHECK(!TakeRPCResponseCacheSkipped());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
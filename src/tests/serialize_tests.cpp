@@ -158,6 +158,23 @@ BOOST_AUTO_TEST_CASE(insert_delete)
     CSerializeData d;
     ss.GetAndClear(d);
     BOOST_CHECK_EQUAL(ss.size(), 0);
+    BOOST_CHECK_EQUAL(d.size(), 4);
+    BOOST_CHECK_EQUAL(d[3], (char)0xff);
+
+    // appends when the target isn't empty, skipping what was read already
+    ss << (char)7 << (char)8;
+    char ch;
+    ss >> ch;
+    ss.GetAndClear(d);
+    BOOST_CHECK_EQUAL(ss.size(), 0);
+    BOOST_CHECK_EQUAL(d.size(), 5);
+    BOOST_CHECK_EQUAL(d[4], 8);
+
+    // Swap exchanges the whole buffer
+    ss.Swap(d);
+    BOOST_CHECK(d.empty());
+    BOOST_CHECK_EQUAL(ss.size(), 5);
+    BOOST_CHECK_EQUAL(ss[0], 0);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
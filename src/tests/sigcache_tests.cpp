@@ -0,0 +1,85 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sigcache.h"
+#include "commons/random.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sigcache_tests)
+
+static CPubKey RandPubKey() {
+    vector<uint8_t> vch(33);
+    vch[0] = 0x02;
+    uint256 rand = GetRandHash();
+    memcpy(&vch[1], rand.begin(), 32);
+    return CPubKey(vch);
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_get_set) {
+    CSignatureCache cache;
+    BOOST_CHECK(cache.Setup(1 << 20) > 0);
+
+    uint256 sigHash = GetRandHash();
+    uint256 rand    = GetRandHash();
+    vector<uint8_t> sig(rand.begin(), rand.end());
+    CPubKey pubKey = RandPubKey();
+
+    BOOST_CHECK(!cache.Get(sigHash, sig, pubKey));
+    cache.Set(sigHash, sig, pubKey);
+    BOOST_CHECK(cache.Get(sigHash, sig, pubKey));
+
+    vector<uint8_t> otherSig(sig);
+    otherSig[0] ^= 1;
+    BOOST_CHECK(!cache.Get(sigHash, otherSig, pubKey));
+    BOOST_CHECK(!cache.Get(GetRandHash(), sig, pubKey));
+    BOOST_CHECK(!cache.Get(sigHash, sig, RandPubKey()));
+
+    CSignatureCache::Stats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 4U);
+    BOOST_CHECK_EQUAL(stats.inserts, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_disabled) {
+    CSignatureCache cache;
+    BOOST_CHECK_EQUAL(cache.Setup(0), 0U);
+
+    uint256 sigHash = GetRandHash();
+    vector<uint8_t> sig(sigHash.begin(), sigHash.end());
+    CPubKey pubKey = RandPubKey();
+    cache.Set(sigHash, sig, pubKey);
+    BOOST_CHECK(!cache.Get(sigHash, sig, pubKey));
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_bounded) {
+    CSignatureCache cache;
+    size_t bytes = cache.Setup(64 * 1024);
+    BOOST_CHECK(bytes > 0 && bytes <= 64 * 1024);
+
+    uint64_t capacity = cache.GetStats().entries;
+    CPubKey pubKey    = RandPubKey();
+    vector<uint8_t> sig(64, 0x30);
+    vector<uint256> hashes;
+    for (uint64_t i = 0; i < capacity * 4; i++) {
+        hashes.push_back(GetRandHash());
+        cache.Set(hashes.back(), sig, pubKey);
+    }
+
+    uint64_t found = 0;
+    for (const auto &hash : hashes)
+        found += cache.Get(hash, sig, pubKey);
+
+    CSignatureCache::Stats stats = cache.GetStats();
+    BOOST_CHECK(found <= capacity);
+    BOOST_CHECK(found > capacity / 2);
+    BOOST_CHECK_EQUAL(stats.bytes, bytes);
+    BOOST_CHECK(stats.evictions >= capacity * 3);
+    // the most recent insert always survives
+    BOOST_CHECK(cache.Get(hashes.back(), sig, pubKey));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
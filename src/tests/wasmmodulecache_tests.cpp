@@ -0,0 +1,85 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "wasm/wasm_interface.hpp"
+#include "wasm/wasm_config.hpp"
+#include "crypto/hash.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(wasmmodulecache_tests)
+
+// (module (func (export "apply") (param i64 i64 i64)))
+static const vector<uint8_t> kApplyModule = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x07, 0x01, 0x60, 0x03, 0x7e, 0x7e, 0x7e, 0x00,
+    0x03, 0x02, 0x01, 0x00,
+    0x07, 0x09, 0x01, 0x05, 'a', 'p', 'p', 'l', 'y', 0x00, 0x00,
+    0x0a, 0x04, 0x01, 0x02, 0x00, 0x0b};
+
+// the same module with a nop in apply, so it has another code hash
+static const vector<uint8_t> kApplyNopModule = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x07, 0x01, 0x60, 0x03, 0x7e, 0x7e, 0x7e, 0x00,
+    0x03, 0x02, 0x01, 0x00,
+    0x07, 0x09, 0x01, 0x05, 'a', 'p', 'p', 'l', 'y', 0x00, 0x00,
+    0x0a, 0x05, 0x01, 0x03, 0x00, 0x01, 0x0b};
+
+class CTestWasmContext : public wasm::wasm_context_interface {
+public:
+    vm::wasm_allocator *get_wasm_allocator() override { return &allocator; }
+
+private:
+    vm::wasm_allocator allocator;
+};
+
+BOOST_AUTO_TEST_CASE(wasm_module_memory_size) {
+    // modules are charged what they hold, not the address space their allocator reserves
+    wasm::wasm_vm_runtime<vm::jit> runtime;
+    auto module = runtime.instantiate_module((const char *)kApplyModule.data(), kApplyModule.size());
+    BOOST_CHECK_GT(module->memory_size(), 0U);
+    BOOST_CHECK_LT(module->memory_size(), wasm::default_module_cache_size << 20);
+}
+
+BOOST_AUTO_TEST_CASE(wasm_execute_hits_module_cache) {
+    wasm::wasm_interface wasmif;
+    wasmif.initialize(wasm::vm_type::eos_vm_jit);
+
+    uint256 codeHash = Hash(kApplyModule.begin(), kApplyModule.end());
+    int codeLoads    = 0;
+    auto getCode     = [&]() {
+        codeLoads++;
+        return kApplyModule;
+    };
+
+    CTestWasmContext context;
+    wasmif.execute(codeHash, getCode, &context);
+    BOOST_CHECK_EQUAL(codeLoads, 1);
+
+    // the second run is served by the module instantiated by the first one
+    wasmif.execute(codeHash, getCode, &context);
+    BOOST_CHECK_EQUAL(codeLoads, 1);
+}
+
+BOOST_AUTO_TEST_CASE(wasm_compile_async_fills_module_cache) {
+    wasm::wasm_interface wasmif;
+    wasmif.initialize(wasm::vm_type::eos_vm_jit);
+
+    uint256 codeHash = Hash(kApplyNopModule.begin(), kApplyNopModule.end());
+    BOOST_REQUIRE(wasmif.compile_async(codeHash, kApplyNopModule));
+    wasmif.compile_pending();
+
+    int codeLoads = 0;
+    CTestWasmContext context;
+    wasmif.execute(codeHash, [&]() {
+        codeLoads++;
+        return kApplyNopModule;
+    }, &context);
+    // the module compiled in the background is served from the cache
+    BOOST_CHECK_EQUAL(codeLoads, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,10 +8,24 @@
 #include "main.h"
 #include "persistence/txdb.h"
 #include "tx/tx.h"
+#include "tx/txserializer.h"
 #include "miner/miner.h"
 
+#include <atomic>
+
+#include <boost/filesystem.hpp>
+
 using namespace std;
 
+/** Version of the mempool.dat file layout */
+static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+/** Number of transactions accepted per cs_main acquisition when reloading mempool.dat */
+static const uint32_t MEMPOOL_LOAD_BATCH_SIZE = 100;
+
+// Set once mempool.dat has been reloaded (or found missing), so a periodic dump
+// never overwrites the previous dump with a partially reloaded memory pool.
+static std::atomic<bool> fMemPoolLoaded(false);
+
 CTxMemPoolEntry::CTxMemPoolEntry() {
     nTxSize   = 0;
     dPriority = 0.0;
@@ -155,4 +169,207 @@ std::shared_ptr<CBaseTx> CTxMemPool::Lookup(const uint256 txid) const {
     if (i == memPoolTxs.end())
         return std::shared_ptr<CBaseTx>();
     return i->second.GetTransaction();
-}
\ No newline at end of file
+}
+//
+// CMemPoolDB
+//
+
+CMemPoolDB::CMemPoolDB() { pathMemPool = GetDataDir() / "mempool.dat"; }
+
+bool CMemPoolDB::Write(const CTxMemPool &pool) {
+    vector<CTxMemPoolEntry> entries;
+    {
+        LOCK(pool.cs);
+        entries.reserve(pool.memPoolTxs.size());
+        for (const auto &item : pool.memPoolTxs)
+            entries.push_back(item.second);
+    }
+
+    // serialize entries, checksum data up to that point, then append csum
+    CDataStream ssMemPool(SER_DISK, CLIENT_VERSION);
+    ssMemPool << FLATDATA(SysCfg().MessageStart());
+    ssMemPool << VARINT(MEMPOOL_DUMP_VERSION);
+    ssMemPool << VARINT((uint64_t)entries.size());
+    for (const auto &entry : entries) {
+        ssMemPool << entry.GetTransaction();
+        ssMemPool << entry.GetTime();
+        ssMemPool << entry.GetHeight();
+    }
+    uint256 hash = Hash(ssMemPool.begin(), ssMemPool.end());
+    ssMemPool << hash;
+
+    boost::filesystem::path pathTmp = GetDataDir() / "mempool.dat.new";
+    FILE *file                      = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout               = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!fileout)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << ssMemPool;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout);
+    fileout.fclose();
+
+    // replace existing mempool.dat, if any, with new mempool.dat.new
+    if (!RenameOver(pathTmp, pathMemPool))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    return true;
+}
+
+bool CMemPoolDB::Read(vector<CTxMemPoolEntry> &entries) {
+    FILE *file       = fopen(pathMemPool.string().c_str(), "rb");
+    CAutoFile filein = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathMemPool.string());
+
+    // use file size to size memory buffer
+    int64_t dataSize = boost::filesystem::file_size(pathMemPool) - sizeof(uint256);
+    if (dataSize < 0)
+        dataSize = 0;
+    vector<uint8_t> vchData;
+    vchData.resize(dataSize);
+    uint256 hashIn;
+
+    try {
+        filein.read((char *)&vchData[0], dataSize);
+        filein >> hashIn;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    CDataStream ssMemPool(vchData, SER_DISK, CLIENT_VERSION);
+    if (hashIn != Hash(ssMemPool.begin(), ssMemPool.end()))
+        return ERRORMSG("%s : Checksum mismatch, data corrupted", __func__);
+
+    uint8_t pchMsgTmp[4];
+    try {
+        ssMemPool >> FLATDATA(pchMsgTmp);
+        if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp)))
+            return ERRORMSG("%s : Invalid network magic number", __func__);
+
+        uint64_t version = 0;
+        ssMemPool >> VARINT(version);
+        if (version != MEMPOOL_DUMP_VERSION)
+            return ERRORMSG("%s : Unsupported mempool dump version %llu", __func__, version);
+
+        uint64_t count = 0;
+        ssMemPool >> VARINT(count);
+        entries.clear();
+        entries.reserve(count);
+        while (count-- > 0) {
+            std::shared_ptr<CBaseTx> pBaseTx;
+            int64_t time;
+            uint32_t height;
+            ssMemPool >> pBaseTx;
+            ssMemPool >> time;
+            ssMemPool >> height;
+            entries.emplace_back(pBaseTx.get(), time, height);
+        }
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    return true;
+}
+
+void DumpMempool() {
+    if (!fMemPoolLoaded)
+        return;
+
+    int64_t nStart = GetTimeMillis();
+
+    CMemPoolDB mdb;
+    if (!mdb.Write(mempool))
+        return;
+
+    LogPrint(BCLog::INFO, "Flushed %d transactions to mempool.dat  %dms\n", mempool.Size(), GetTimeMillis() - nStart);
+}
+
+// Warm the signature cache for the reloaded transactions on all cores, so that the
+// following AcceptToMemoryPool() calls under cs_main only hit the cache.
+static void PreVerifySignatures(const vector<CTxMemPoolEntry> &entries) {
+    vector<SignatureCheck> checks;
+    checks.reserve(entries.size());
+    {
+        LOCK(cs_main);
+        for (const auto &entry : entries) {
+            const auto &pBaseTx = entry.GetTransaction();
+            CPubKey pubKey;
+            if (pBaseTx->txUid.is<CPubKey>()) {
+                pubKey = pBaseTx->txUid.get<CPubKey>();
+            } else {
+                CAccount account;
+                if (!mempool.cw->accountCache.GetAccount(pBaseTx->txUid, account))
+                    continue;
+                pubKey = account.owner_pubkey;
+            }
+            if (!pubKey.IsFullyValid() || pBaseTx->signature.empty())
+                continue;
+
+            checks.emplace_back(pBaseTx->GetHash(), &pBaseTx->signature, pubKey);
+        }
+    }
+
+    // failures are reported later on by CheckTx()
+    vector<bool> results;
+    VerifySignatures(checks, results);
+}
+
+void ThreadLoadMempool() {
+    RenameThread("coin-loadmempool");
+
+    // the chain must not be rewritten underneath the reloaded transactions
+    while (SysCfg().IsReindex() || SysCfg().IsImporting())
+        MilliSleep(1000);
+
+    int64_t nStart = GetTimeMillis();
+
+    vector<CTxMemPoolEntry> entries;
+    CMemPoolDB mdb;
+    if (!boost::filesystem::exists(GetDataDir() / "mempool.dat") || !mdb.Read(entries)) {
+        LogPrint(BCLog::INFO, "Invalid or missing mempool.dat; starting with an empty memory pool\n");
+        fMemPoolLoaded = true;
+        return;
+    }
+
+    // drop transactions which can no longer be packed into a block
+    int32_t validHeight = SysCfg().GetTxCacheHeight();
+    {
+        LOCK(cs_main);
+        int32_t height = chainActive.Height();
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [&](const CTxMemPoolEntry &entry) {
+                                         return !entry.GetTransaction()->IsValidHeight(height, validHeight);
+                                     }),
+                      entries.end());
+    }
+
+    PreVerifySignatures(entries);
+
+    uint32_t accepted = 0;
+    uint32_t failed   = 0;
+    for (size_t i = 0; i < entries.size(); i += MEMPOOL_LOAD_BATCH_SIZE) {
+        boost::this_thread::interruption_point();
+
+        LOCK(cs_main);
+        size_t end = std::min(entries.size(), i + MEMPOOL_LOAD_BATCH_SIZE);
+        for (size_t k = i; k < end; k++) {
+            const CTxMemPoolEntry &entry = entries[k];
+            CValidationState state;
+            if (AcceptToMemoryPool(mempool, state, entry.GetTransaction().get(), false, false, entry.GetTime(),
+                                   entry.GetHeight()))
+                ++accepted;
+            else
+                ++failed;
+        }
+    }
+
+    fMemPoolLoaded = true;
+
+    LogPrint(BCLog::INFO, "Loaded %u transactions from mempool.dat, %u failed or expired (%dms)\n", accepted,
+             failed, GetTimeMillis() - nStart);
+}
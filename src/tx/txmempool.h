@@ -15,6 +15,8 @@
 #include <map>
 #include <memory>
 
+#include <boost/filesystem/path.hpp>
+
 using namespace std;
 
 class CValidationState;
@@ -87,5 +89,21 @@ private:
     bool fSanityCheck; // Normally false, true if -checkmempool or -regtest
 };
 
+/** Access to the memory pool dump file (mempool.dat) */
+class CMemPoolDB {
+private:
+    boost::filesystem::path pathMemPool;
+
+public:
+    CMemPoolDB();
+    bool Write(const CTxMemPool &pool);
+    bool Read(vector<CTxMemPoolEntry> &entries);
+};
+
+/** Dump the memory pool to mempool.dat, no-op until the previous dump was reloaded */
+void DumpMempool();
+/** Reload mempool.dat into the memory pool, run in a background thread at startup */
+void ThreadLoadMempool();
+
 
 #endif /* COIN_TXMEMPOOL_H */
@@ -442,3 +442,35 @@ void CWasmContractTx::set_signature(const wasm::signature_pair& signature) {
     set_signature(signature.account, signature.signature);
 }
 
+void ThreadCompileWasmContracts() {
+
+    RenameThread("coin-wasmcompile");
+
+    wasm::wasm_interface wasmif;
+    wasmif.initialize(wasm::vm_type::eos_vm_jit);
+
+    map<CRegIDKey, CUniversalContract> contracts;
+    {
+        LOCK(cs_main);
+        pCdMan->pContractCache->GetContracts(contracts);
+    }
+
+    uint32_t count = 0;
+    for (const auto &item : contracts) {
+        const CUniversalContract &contract = item.second;
+        if (contract.vm_type != VMType::WASM_VM)
+            continue;
+
+        // the queue is bounded, compile some of it before queueing more
+        uint256 codeHash = Hash(contract.code.begin(), contract.code.end());
+        while (!wasmif.compile_async(codeHash, vector<uint8_t>(contract.code.begin(), contract.code.end())))
+            wasmif.compile_pending();
+        count++;
+    }
+    contracts.clear();
+    LogPrint(BCLog::WASM, "queued %u deployed wasm contracts for compilation\n", count);
+
+    while (true) {
+        wasmif.compile_pending();
+    }
+}
@@ -85,4 +85,7 @@ public:
 
 };
 
+/** Compile the deployed wasm contracts at startup, then the ones deployed afterwards */
+void ThreadCompileWasmContracts();
+
 #endif //TX_WASM_CONTRACT_TX_H
\ No newline at end of file
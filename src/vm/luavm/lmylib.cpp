@@ -8,64 +8,23 @@
 
 #include "lmylib.h"
 #include "lua/lua.hpp"
+#include "luabytes.h"
 #include "luavmrunenv.h"
 #include "commons/SafeInt3.hpp"
 #include "tx/contracttx.h"
 #include "tx/cointransfertx.h"
 
-#define LUA_C_BUFFER_SIZE  500  //传递值，最大字节防止栈溢出
-
 ///////////////////////////////////////////////////////////////////////////////
 // local static functions
 
 /*
  *  //3.往函数私有栈里存运算后的结果*/
 static inline int32_t RetRstToLua(lua_State *L, const vector<uint8_t> &resultData, bool needToTruncate = true) {
-    int32_t len = resultData.size();
-    // truncate data by default
-    if (needToTruncate) {
-        len = len > LUA_C_BUFFER_SIZE ? LUA_C_BUFFER_SIZE : len;
-    }
-
-    if (len > 0) {
-        // check stack to avoid stack overflow
-        if (lua_checkstack(L, len)) {
-            // LogPrint(BCLog::LUAVM, "RetRstToLua value:%s\n", HexStr(resultData).c_str());
-            for (int32_t i = 0; i < len; i++) {
-                lua_pushinteger(L, (lua_Integer)resultData[i]);
-            }
-            return len;
-        } else {
-            LogPrint(BCLog::LUAVM, "%s\n", "RetRstToLua stack overflow");
-        }
-    } else {
-        LogPrint(BCLog::LUAVM, "RetRstToLua err len = %d\n", len);
-    }
-    return 0;
+    return PushBytesToLua(L, resultData.data(), resultData.size(), needToTruncate);
 }
 
 static inline int32_t RetRstToLua(lua_State *L, const string &resultData, bool needToTruncate = true) {
-    int32_t len = resultData.size();
-    // truncate data by default
-    if (needToTruncate) {
-        len = len > LUA_C_BUFFER_SIZE ? LUA_C_BUFFER_SIZE : len;
-    }
-
-    if (len > 0) {
-        // check stack to avoid stack overflow
-        if (lua_checkstack(L, len)) {
-            // LogPrint(BCLog::LUAVM, "RetRstToLua value:%s\n", HexStr(resultData).c_str());
-            for (int32_t i = 0; i < len; i++) {
-                lua_pushinteger(L, (lua_Integer)uint8_t(resultData[i]));
-            }
-            return len;
-        } else {
-            LogPrint(BCLog::LUAVM, "%s\n", "RetRstToLua stack overflow");
-        }
-    } else {
-        LogPrint(BCLog::LUAVM, "RetRstToLua err len = %d\n", len);
-    }
-    return 0;
+    return PushBytesToLua(L, (const uint8_t *)resultData.data(), resultData.size(), needToTruncate);
 }
 
 /*
@@ -127,24 +86,12 @@ static bool GetKeyId(const CAccountDBCache &accountView, vector<uint8_t> &ret, C
 
 static bool GetArray(lua_State *L, vector<std::shared_ptr<std::vector<uint8_t>>> &ret) {
     //从栈里取变长的数组
-    int32_t totallen = lua_gettop(L);
-    if ((totallen <= 0) || (totallen > LUA_C_BUFFER_SIZE)) {
-        LogPrint(BCLog::LUAVM, "totallen error\n");
+    uint8_t buf[LUA_C_BUFFER_SIZE];
+    int32_t len = 0;
+    if (!GetBytesFromLua(L, buf, len))
         return false;
-    }
 
-    vector<uint8_t> vBuf;
-    vBuf.clear();
-    for (int32_t i = 0; i < totallen; i++) {
-        if (!lua_isnumber(L, i + 1))  // if(!lua_isnumber(L,-1 - i))
-        {
-            LogPrint(BCLog::LUAVM, "%s\n", "data is not number");
-            return false;
-        }
-        vBuf.insert(vBuf.end(), lua_tonumber(L, i + 1));
-    }
-    ret.insert(ret.end(), std::make_shared<vector<uint8_t>>(vBuf.begin(), vBuf.end()));
-    // LogPrint(BCLog::LUAVM, "GetData:%s, len:%d\n", HexStr(vBuf).c_str(), vBuf.size());
+    ret.insert(ret.end(), std::make_shared<vector<uint8_t>>(buf, buf + len));
     return true;
 }
 
@@ -172,10 +119,8 @@ static bool GetDataString(lua_State *L, vector<std::shared_ptr<std::vector<uint8
     const char *pStr = nullptr;
     pStr             = lua_tostring(L, -1 - 0);
     if (pStr && (strlen(pStr) <= LUA_C_BUFFER_SIZE)) {
-        for (size_t i = 0; i < strlen(pStr); i++) {
-            vBuf.insert(vBuf.end(), pStr[i]);
-        }
-        ret.insert(ret.end(), std::make_shared<vector<uint8_t>>(vBuf.begin(), vBuf.end()));
+        vBuf.assign(pStr, pStr + strlen(pStr));
+        ret.insert(ret.end(), std::make_shared<vector<uint8_t>>(std::move(vBuf)));
         // LogPrint(BCLog::LUAVM, "GetDataString:%s\n", pStr);
         return true;
     } else {
@@ -184,6 +129,33 @@ static bool GetDataString(lua_State *L, vector<std::shared_ptr<std::vector<uint8
     }
 }
 
+/** Read the string key on top of the stack, the zero-copy variant of GetDataString. */
+static bool GetDataKey(lua_State *L, string &key) {
+    if (!lua_isstring(L, -1 - 0)) {
+        LogPrint(BCLog::LUAVM, "%s\n", "data is not string");
+        return false;
+    }
+    const char *pStr = lua_tostring(L, -1 - 0);
+    size_t len       = pStr ? strlen(pStr) : 0;
+    if (pStr && (len <= LUA_C_BUFFER_SIZE)) {
+        key.assign(pStr, len);
+        return true;
+    } else {
+        LogPrint(BCLog::LUAVM, "%s\n", "lua_tostring get fail");
+        return false;
+    }
+}
+
+/** Read a 32 byte hash passed as byte arguments. */
+static bool GetDataHash(lua_State *L, uint256 &hash) {
+    uint8_t buf[LUA_C_BUFFER_SIZE];
+    int32_t len = 0;
+    if (!GetBytesFromLua(L, buf, len) || len != 32)
+        return false;
+    hash = BytesToHash(buf);
+    return true;
+}
+
 // get bool field value of table
 static bool GetBoolInTable(lua_State *L, const char *pKey, bool &value) {
     // the top of stack must be a table
@@ -854,8 +826,8 @@ int32_t ExVerifySignatureFunc(lua_State *L) {
 }
 
 int32_t ExGetTxContractFunc(lua_State *L) {
-    vector<std::shared_ptr<vector<uint8_t>>> retdata;
-    if (!GetArray(L, retdata) || retdata.size() != 1 || retdata.at(0).get()->size() != 32) {
+    uint256 hash;
+    if (!GetDataHash(L, hash)) {
         return RetFalse("ExGetTxContractFunc, para error");
     }
 
@@ -864,11 +836,6 @@ int32_t ExGetTxContractFunc(lua_State *L) {
         return RetFalse("ExGetTxContractFunc, pVmRunEnv is nullptr");
     }
 
-    vector<uint8_t> vHash(retdata.at(0).get()->rbegin(), retdata.at(0).get()->rend());
-    CDataStream ds(vHash, SER_DISK, CLIENT_VERSION);
-    uint256 hash;
-    ds >> hash;
-
     LogPrint(BCLog::LUAVM, "ExGetTxContractFunc, hash: %s\n", hash.GetHex().c_str());
 
     std::shared_ptr<CBaseTx> pBaseTx;
@@ -928,8 +895,8 @@ int32_t ExLogPrintFunc(lua_State *L) {
  * 1.第一个是 hash
  */
 int32_t ExGetTxRegIDFunc(lua_State *L) {
-    vector<std::shared_ptr<vector<uint8_t>>> retdata;
-    if (!GetArray(L, retdata) || retdata.size() != 1 || retdata.at(0).get()->size() != 32) {
+    uint256 hash;
+    if (!GetDataHash(L, hash)) {
         return RetFalse("ExGetTxRegIDFunc, para error");
     }
 
@@ -938,12 +905,6 @@ int32_t ExGetTxRegIDFunc(lua_State *L) {
         return RetFalse("ExGetTxRegIDFunc, pVmRunEnv is nullptr");
     }
 
-    vector<uint8_t> vHash(retdata.at(0).get()->rbegin(), retdata.at(0).get()->rend());
-
-    CDataStream ds(vHash, SER_DISK, CLIENT_VERSION);
-    uint256 hash;
-    ds >> hash;
-
     LogPrint(BCLog::LUAVM,"ExGetTxRegIDFunc, hash: %s\n", hash.GetHex().c_str());
 
     LUA_BurnFuncCall(L, FUEL_CALL_GetTxRegID, BURN_VER_R2);
@@ -974,20 +935,15 @@ int32_t ExGetTxRegIDFunc(lua_State *L) {
 
 int32_t ExByteToIntegerFunc(lua_State *L) {
     //把字节流组合成integer
-    vector<std::shared_ptr<vector<uint8_t>>> retdata;
-    if (!GetArray(L, retdata) || retdata.size() != 1 ||
-        ((retdata.at(0).get()->size() != 4) && (retdata.at(0).get()->size() != 8))) {
+    uint8_t buf[LUA_C_BUFFER_SIZE];
+    int32_t size = 0;
+    if (!GetBytesFromLua(L, buf, size) || (size != 4 && size != 8)) {
         return RetFalse("ExByteToIntegerFunc para err1");
     }
 
-    //将数据反向
-    vector<uint8_t> vValue(retdata.at(0).get()->begin(), retdata.at(0).get()->end());
-    CDataStream tep1(vValue, SER_DISK, CLIENT_VERSION);
-
     LUA_BurnFuncCall(L, FUEL_CALL_ByteToInteger, BURN_VER_R2);
-    if (retdata.at(0).get()->size() == 4) {
-        uint32_t height;
-        tep1 >> height;
+    if (size == 4) {
+        uint32_t height = ReadLE32(buf);
 
         // LogPrint(BCLog::LUAVM, "%d\n", height);
         if (lua_checkstack(L, sizeof(lua_Integer))) {
@@ -997,8 +953,7 @@ int32_t ExByteToIntegerFunc(lua_State *L) {
             return RetFalse("ExByteToIntegerFunc stack overflow");
         }
     } else {
-        int64_t llValue = 0;
-        tep1 >> llValue;
+        int64_t llValue = (int64_t)ReadLE64(buf);
         // LogPrint(BCLog::LUAVM, "%lld\n", llValue);
         if (lua_checkstack(L, sizeof(lua_Integer))) {
             lua_pushinteger(L, (lua_Integer)llValue);
@@ -1016,10 +971,7 @@ int32_t ExIntegerToByte4Func(lua_State *L) {
         return RetFalse("ExIntegerToByte4Func para err1");
     }
     LUA_BurnFuncCall(L, FUEL_CALL_IntegerToByte4, BURN_VER_R2);
-    CDataStream tep(SER_DISK, CLIENT_VERSION);
-    tep << height;
-    vector<uint8_t> TMP(tep.begin(), tep.end());
-    return RetRstToLua(L, TMP);
+    return PushUint32ToLua(L, (uint32_t)height);
 }
 
 int32_t ExIntegerToByte8Func(lua_State *L) {
@@ -1034,10 +986,7 @@ int32_t ExIntegerToByte8Func(lua_State *L) {
     }
 
     LUA_BurnFuncCall(L, FUEL_CALL_IntegerToByte8, BURN_VER_R2);
-    CDataStream tep(SER_DISK, CLIENT_VERSION);
-    tep << llValue;
-    vector<uint8_t> TMP(tep.begin(), tep.end());
-    return RetRstToLua(L, TMP);
+    return PushUint64ToLua(L, (uint64_t)llValue);
 }
 /**
  *uint16_t GetAccountPublickey(const void* const accountId,void * const pubkey,const uint16_t maxlength)
@@ -1108,10 +1057,7 @@ int32_t ExQueryAccountBalanceFunc(lua_State *L) {
         len = 0;
     } else {
         uint64_t nbalance = account.GetToken(SYMB::WICC).free_amount;
-        CDataStream tep(SER_DISK, CLIENT_VERSION);
-        tep << nbalance;
-        vector<uint8_t> TMP(tep.begin(), tep.end());
-        len = RetRstToLua(L, TMP);
+        len = PushUint64ToLua(L, nbalance);
     }
     return len;
 }
@@ -1122,21 +1068,11 @@ int32_t ExQueryAccountBalanceFunc(lua_State *L) {
  * 1.第一个入参: hash,32个字节
  */
 int32_t ExGetTxConfirmHeightFunc(lua_State *L) {
-    vector<std::shared_ptr<vector<uint8_t>>> retdata;
-
-    if (!GetArray(L, retdata) || retdata.size() != 1 || retdata.at(0).get()->size() != 32) {
+    uint256 hash1;
+    if (!GetDataHash(L, hash1)) {
         return RetFalse("ExGetTxConfirmHeightFunc para err1");
     }
 
-    // uint256 hash1(*retdata.at(0));
-    // LogPrint(BCLog::LUAVM,"ExGetTxContractsFunc1:%s",hash1.GetHex().c_str());
-
-    // reverse hash value
-    vector<uint8_t> vec_hash(retdata.at(0).get()->rbegin(), retdata.at(0).get()->rend());
-    CDataStream tep1(vec_hash, SER_DISK, CLIENT_VERSION);
-    uint256 hash1;
-    tep1 >> hash1;
-
     CLuaVMRunEnv *pVmRunEnv = GetVmRunEnv(L);
     if (nullptr == pVmRunEnv) {
         return RetFalse("pVmRunEnv is nullptr");
@@ -1188,12 +1124,7 @@ int32_t ExGetBlockHashFunc(lua_State *L) {
     uint256 blockHash   = pIndex->GetBlockHash();
 
     //  LogPrint(BCLog::LUAVM,"ExGetBlockHashFunc:%s",HexStr(blockHash).c_str());
-    CDataStream tep(SER_DISK, CLIENT_VERSION);
-    tep << blockHash;
-    vector<uint8_t> TMP(tep.begin(), tep.end());
-    // reverse hash value
-    vector<uint8_t> TMP2(TMP.rbegin(), TMP.rend());
-    return RetRstToLua(L, TMP2);
+    return PushHashToLua(L, blockHash);
 }
 
 int32_t ExGetCurRunEnvHeightFunc(lua_State *L) {
@@ -1318,13 +1249,11 @@ int32_t ExWriteDataDBFunc(lua_State *L) {
  * 1.第一个是 key值
  */
 int32_t ExDeleteDataDBFunc(lua_State *L) {
-    vector<std::shared_ptr < vector<uint8_t> > > retdata;
-
-    if (!GetDataString(L, retdata) || retdata.size() != 1) {
+    string key;
+    if (!GetDataKey(L, key)) {
         LogPrint(BCLog::LUAVM, "ExDeleteDataDBFunc key err1");
         return RetFalse(string(__FUNCTION__) + "para  err !");
     }
-    string key = string((*retdata.at(0)).begin(), (*retdata.at(0)).end());
 
     CLuaVMRunEnv* pVmRunEnv = GetVmRunEnv(L);
     if (nullptr == pVmRunEnv) {
@@ -1340,7 +1269,7 @@ int32_t ExDeleteDataDBFunc(lua_State *L) {
     scriptDB->GetContractData(contractRegId, key, oldValue);
 
     if (!scriptDB->EraseContractData(contractRegId, key)) {
-        LogPrint(BCLog::LUAVM, "ExDeleteDataDBFunc EraseContractData railed, key:%s!\n", HexStr(*retdata.at(0)));
+        LogPrint(BCLog::LUAVM, "ExDeleteDataDBFunc EraseContractData railed, key:%s!\n", HexStr(key));
         lua_BurnStoreUnchanged(L, key.size(), oldValue.size(), BURN_VER_R2);
         flag = false;
     } else {
@@ -1356,14 +1285,11 @@ int32_t ExDeleteDataDBFunc(lua_State *L) {
  * 1.第一个是 key值
  */
 int32_t ExReadDataDBFunc(lua_State *L) {
-    vector<std::shared_ptr < vector<uint8_t> > > retdata;
-
-    if (!GetDataString(L,retdata) ||retdata.size() != 1) {
+    string key;
+    if (!GetDataKey(L, key)) {
         return RetFalse("ExReadDataDBFunc key err1");
     }
 
-    string key((*retdata.at(0)).begin(), (*retdata.at(0)).end());
-
     CLuaVMRunEnv* pVmRunEnv = GetVmRunEnv(L);
     if (nullptr == pVmRunEnv) {
         return RetFalse("pVmRunEnv is nullptr");
@@ -1379,7 +1305,7 @@ int32_t ExReadDataDBFunc(lua_State *L) {
         lua_BurnStoreUnchanged(L, key.size(), 0, BURN_VER_R2);
     } else {
         lua_BurnStoreGet(L, key.size(), value.size(), BURN_VER_R2);
-        len = RetRstToLua(L, vector<uint8_t>(value.begin(), value.end()));
+        len = RetRstToLua(L, value);
     }
     return len;
 }
@@ -1391,12 +1317,7 @@ int32_t ExGetCurTxHash(lua_State *L) {
         return RetFalse("pVmRunEnv is nullptr");
 
     LUA_BurnFuncCall(L, FUEL_CALL_GetCurTxHash, BURN_VER_R2);
-    uint256 hash = pVmRunEnv->GetCurTxHash();
-    CDataStream tep(SER_DISK, CLIENT_VERSION);
-    tep << hash;
-    vector<uint8_t> tep1(tep.begin(),tep.end());
-    vector<uint8_t> tep2(tep1.rbegin(),tep1.rend());
-    return RetRstToLua(L,tep2);
+    return PushHashToLua(L, pVmRunEnv->GetCurTxHash());
 }
 
 /**
@@ -1586,7 +1507,7 @@ int32_t ExGetContractDataFunc(lua_State *L) {
         lua_BurnStoreUnchanged(L, key.size(), 0, BURN_VER_R2);
     } else {
         lua_BurnStoreGet(L, key.size(), value.size(), BURN_VER_R2);
-        len = RetRstToLua(L, vector<uint8_t>(value.begin(), value.end()));
+        len = RetRstToLua(L, value);
     }
     /*
      * 每个函数里的Lua栈是私有的,当把返回值压入Lua栈以后，该栈会自动被清空*/
@@ -1638,19 +1559,13 @@ int32_t ExGetCurTxPayAmountFunc(lua_State *L) {
         return RetFalse("pVmRunEnv is nullptr");
 
     LUA_BurnFuncCall(L, FUEL_CALL_GetCurTxPayAmount, BURN_VER_R2);
-    uint64_t lvalue = pVmRunEnv->GetValue();
-
-    CDataStream tep(SER_DISK, CLIENT_VERSION);
-    tep << lvalue;
-    vector<uint8_t> tep1(tep.begin(), tep.end());
-    int32_t len = RetRstToLua(L, tep1);
+    int32_t len = PushUint64ToLua(L, pVmRunEnv->GetValue());
     /*
      * 每个函数里的Lua栈是私有的,当把返回值压入Lua栈以后，该栈会自动被清空*/
     return len;  // number of results 告诉Lua返回了几个返回值
 }
 
 int32_t ExGetUserAppAccValueFunc(lua_State *L) {
-    vector<std::shared_ptr < vector<uint8_t> > > retdata;
     if (!lua_istable(L, -1)) {
         LogPrint(BCLog::LUAVM, "is not table\n");
         return 0;
@@ -1658,7 +1573,6 @@ int32_t ExGetUserAppAccValueFunc(lua_State *L) {
     double doubleValue = 0;
     uint32_t idlen = 0;
     vector<uint8_t> accountId;
-    memset(&accountId, 0, sizeof(accountId));
     if (!(getNumberInTable(L, "idLen", doubleValue))) {
         LogPrint(BCLog::LUAVM, "get idlen failed\n");
         return 0;
@@ -1685,11 +1599,7 @@ int32_t ExGetUserAppAccValueFunc(lua_State *L) {
     LUA_BurnAccount(L, FUEL_ACCOUNT_GET_VALUE, BURN_VER_R2);
     if (pVmRunEnv->GetAppUserAccount(accountId, appAccount)) {
         valueData = appAccount->GetBcoins();
-
-        CDataStream tep(SER_DISK, CLIENT_VERSION);
-        tep << valueData;
-        vector<uint8_t> TMP(tep.begin(), tep.end());
-        len = RetRstToLua(L, TMP);
+        len       = PushUint64ToLua(L, valueData);
     }
     return len;
 }
@@ -15,6 +15,9 @@ typedef int lua_burner_version;
 /* burn lua base resource, include instruction, memory, store */
 #define BURN_VER_R2                (10002)
 
+/* load contracts from compiled bytecode, the parse is burned by the size of the source */
+#define BURN_VER_R4                (10004)
+
 /* enable all version on */
 #define BURN_VER_NEWEST            BURN_VER_R2
 
@@ -58,6 +61,8 @@ typedef int lua_burner_version;
 
 #define FUEL_MEM_ADDED          3 // fuel for burning memory  per new 32 bytes
 
+#define FUEL_DATA32_CodeLoad    3 // fuel for parsing the contract per 32 bytes of source, from BURN_VER_R4
+
 #define FUEL_CALL_Int64Mul              5
 #define FUEL_CALL_Int64Add              3
 #define FUEL_CALL_Int64Sub              3
@@ -0,0 +1,102 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "luabytecode.h"
+#include "lua/lua.hpp"
+
+#include "commons/util/util.h"
+#include "config/chainparams.h"
+#include "crypto/hash.h"
+#include "logging.h"
+
+using namespace std;
+
+static int WriteBytecode(lua_State *L, const void *p, size_t sz, void *ud) {
+    static_cast<string *>(ud)->append(static_cast<const char *>(p), sz);
+    return 0;
+}
+
+/**
+ * Compile the contract source in a scratch state. The state is not burned, so the
+ * bytecode and its loading cost only depend on the source.
+ */
+static bool CompileBytecode(const string &code, string &bytecode, string &strError) {
+    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+    if (!lua_state_ptr) {
+        strError = "luaL_newstate() failed";
+        return false;
+    }
+    lua_State *lua_state = lua_state_ptr.get();
+
+    int luaStatus = luaL_loadbuffer(lua_state, code.c_str(), code.size(), "line");
+    if (luaStatus != LUA_OK) {
+        const char *errStr = lua_tostring(lua_state, -1);
+        strError = errStr ? errStr : "unknown";
+        return false;
+    }
+    // keep the debug info, error messages must not depend on the cache
+    return lua_dump(lua_state, WriteBytecode, &bytecode, 0) == 0;
+}
+
+bool CLuaBytecodeCache::Get(const string &code, std::shared_ptr<const string> &bytecode, string &strError) {
+    uint256 codeHash = Hash(code.begin(), code.end());
+    {
+        LOCK(cs);
+        std::shared_ptr<const string> *pBytecode = cache.find(codeHash);
+        if (pBytecode != nullptr) {
+            bytecode = *pBytecode;
+            return true;
+        }
+    }
+
+    auto pCompiled = std::make_shared<string>();
+    if (!CompileBytecode(code, *pCompiled, strError))
+        return false;
+
+    LogPrint(BCLog::LUAVM, "compiled lua contract, codeHash=%s, codeSize=%u, bytecodeSize=%u\n",
+             codeHash.ToString(), code.size(), pCompiled->size());
+    bytecode = pCompiled;
+
+    LOCK(cs);
+    cache.insert(codeHash, bytecode, bytecode->size());
+    return true;
+}
+
+bool CLuaBytecodeCache::Contains(const string &code) const {
+    uint256 codeHash = Hash(code.begin(), code.end());
+    LOCK(cs);
+    return cache.count(codeHash);
+}
+
+CLuaBytecodeCache &GetLuaBytecodeCache() {
+    static CLuaBytecodeCache bytecodeCache(
+        std::max<int64_t>(SysCfg().GetArg("-luabytecodecachesize", DEFAULT_LUA_BYTECODE_CACHE_SIZE), 1) << 20);
+    return bytecodeCache;
+}
+
+int LoadLuaContract(lua_State *L, const string &code, int burnVersion, CLuaBytecodeCache &cache) {
+    if (burnVersion < BURN_VER_R4)
+        return luaL_loadbuffer(L, code.c_str(), code.size(), "line");
+
+    // burned before the work is done, it must not fail halfway outside of a protected call
+    lua_burner_state *pBurner = lua_GetBurnerState(L);
+    if (pBurner != nullptr) {
+        unsigned long long fuel = lua_CalcFuelBySize(code.size(), BURN_MEM_UNIT_SIZE, FUEL_DATA32_CodeLoad);
+        pBurner->fuel += fuel;
+        pBurner->fuelFunction += fuel;
+        if (lua_IsBurnedOut(L)) {
+            pBurner->error = 1;
+            lua_pushstring(L, "Burned-out LoadLuaContract");
+            return LUA_ERR_BURNEDOUT;
+        }
+    }
+
+    std::shared_ptr<const string> bytecode;
+    string strError;
+    if (!cache.Get(code, bytecode, strError)) {
+        lua_pushstring(L, strError.c_str());
+        return LUA_ERRSYNTAX;
+    }
+    return luaL_loadbufferx(L, bytecode->data(), bytecode->size(), "line", "b");
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef LUA_BYTECODE_H
+#define LUA_BYTECODE_H
+
+#include "commons/lrucache.h"
+#include "commons/uint256.h"
+#include "sync.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct lua_State;
+
+/** -luabytecodecachesize default (MiB) */
+static const int64_t DEFAULT_LUA_BYTECODE_CACHE_SIZE = 16;
+
+/**
+ * Compiled chunks of lua contracts by the hash of their source, so a contract is not parsed again
+ * on every invocation. Contracts sharing code under different regids share one chunk.
+ * The chunks are not persisted, lundump trusts its input.
+ */
+class CLuaBytecodeCache {
+public:
+    explicit CLuaBytecodeCache(size_t nMaxBytes) : cache(std::max<size_t>(nMaxBytes, 1)) {}
+
+    /** The chunk of code, compiled on a miss, or false with the parser error */
+    bool Get(const std::string &code, std::shared_ptr<const std::string> &bytecode, std::string &strError);
+    bool Contains(const std::string &code) const;
+
+private:
+    mutable CCriticalSection cs;
+    lrucache<uint256, std::shared_ptr<const std::string>> cache;
+};
+
+CLuaBytecodeCache &GetLuaBytecodeCache();
+
+/**
+ * Load the contract as a function on top of the stack of the metered state L, or push the error
+ * message. From BURN_VER_R4 on the contract is compiled in a scratch state, its parse is burned by
+ * the size of the source and the metered state always loads the compiled chunk, so a hit and a
+ * miss of the cache burn exactly the same fuel.
+ */
+int LoadLuaContract(lua_State *L, const std::string &code, int burnVersion, CLuaBytecodeCache &cache);
+
+#endif  // LUA_BYTECODE_H
@@ -0,0 +1,99 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef VM_LUA_LUABYTES_H
+#define VM_LUA_LUABYTES_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lua/lua.hpp"
+#include "commons/uint256.h"
+#include "crypto/common.h"
+#include "logging.h"
+
+/**
+ * Marshalling between the lua stack and the host side of the mylib functions.
+ *
+ * Byte arrays cross the boundary as one lua number per byte (that is the contract
+ * api and can't change), but the host side works on caller supplied buffers, so a
+ * call converts hashes and integers without any CDataStream or heap vector.
+ */
+
+#define LUA_C_BUFFER_SIZE  500  //传递值，最大字节防止栈溢出
+
+/** Read all values on the stack as bytes into buf, which holds LUA_C_BUFFER_SIZE bytes. */
+static inline bool GetBytesFromLua(lua_State *L, uint8_t *buf, int32_t &len) {
+    len = lua_gettop(L);
+    if ((len <= 0) || (len > LUA_C_BUFFER_SIZE)) {
+        LogPrint(BCLog::LUAVM, "totallen error\n");
+        return false;
+    }
+
+    for (int32_t i = 0; i < len; i++) {
+        if (!lua_isnumber(L, i + 1)) {
+            LogPrint(BCLog::LUAVM, "%s\n", "data is not number");
+            return false;
+        }
+        buf[i] = lua_tonumber(L, i + 1);
+    }
+    return true;
+}
+
+/** Hashes are passed to lua byte reversed, i.e. in the order of their hex string. */
+static inline uint256 BytesToHash(const uint8_t *data) {
+    uint256 hash;
+    uint8_t *pHash = hash.begin();
+    for (size_t i = 0; i < hash.size(); i++)
+        pHash[i] = data[hash.size() - 1 - i];
+    return hash;
+}
+
+static inline int32_t PushBytesToLua(lua_State *L, const uint8_t *data, size_t size, bool needToTruncate = true) {
+    int32_t len = size;
+    // truncate data by default
+    if (needToTruncate) {
+        len = len > LUA_C_BUFFER_SIZE ? LUA_C_BUFFER_SIZE : len;
+    }
+
+    if (len > 0) {
+        // check stack to avoid stack overflow
+        if (lua_checkstack(L, len)) {
+            for (int32_t i = 0; i < len; i++) {
+                lua_pushinteger(L, (lua_Integer)data[i]);
+            }
+            return len;
+        } else {
+            LogPrint(BCLog::LUAVM, "%s\n", "RetRstToLua stack overflow");
+        }
+    } else {
+        LogPrint(BCLog::LUAVM, "RetRstToLua err len = %d\n", len);
+    }
+    return 0;
+}
+
+static inline int32_t PushHashToLua(lua_State *L, const uint256 &hash) {
+    uint8_t data[32];
+    const uint8_t *pHash = hash.begin();
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = pHash[sizeof(data) - 1 - i];
+    return PushBytesToLua(L, data, sizeof(data));
+}
+
+/** Integers are passed as their little endian serialization. */
+static inline int32_t PushUint32ToLua(lua_State *L, uint32_t value) {
+    uint8_t data[4];
+    WriteLE32(data, value);
+    return PushBytesToLua(L, data, sizeof(data));
+}
+
+static inline int32_t PushUint64ToLua(lua_State *L, uint64_t value) {
+    uint8_t data[8];
+    WriteLE64(data, value);
+    return PushBytesToLua(L, data, sizeof(data));
+}
+
+#endif  // VM_LUA_LUABYTES_H
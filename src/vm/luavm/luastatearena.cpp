@@ -0,0 +1,111 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "luastatearena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+CLuaStateArena::CLuaStateArena() : fInUse(false), nSlabsInUse(0), nSlabOffset(SLAB_SIZE) {
+    memset(freeLists, 0, sizeof(freeLists));
+}
+
+CLuaStateArena::~CLuaStateArena() {
+    for (char *slab : slabs)
+        free(slab);
+    for (void *block : keptHeapBlocks)
+        free(block);
+}
+
+void *CLuaStateArena::Alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    return static_cast<CLuaStateArena *>(ud)->Realloc(ptr, osize, nsize);
+}
+
+void CLuaStateArena::Reset() {
+    memset(freeLists, 0, sizeof(freeLists));
+    nSlabsInUse = 0;
+    nSlabOffset = SLAB_SIZE;
+    while (slabs.size() > MAX_RETAINED_SLABS) {
+        free(slabs.back());
+        slabs.pop_back();
+    }
+    for (void *block : keptHeapBlocks)
+        free(block);
+    keptHeapBlocks.clear();
+}
+
+void *CLuaStateArena::AllocSmall(size_t size) {
+    size_t cls = SizeClass(size);
+    if (freeLists[cls] != nullptr) {
+        FreeBlock *block = freeLists[cls];
+        freeLists[cls]   = block->next;
+        return block;
+    }
+
+    size_t blockSize = (cls + 1) * SIZE_CLASS;
+    if (nSlabOffset + blockSize > SLAB_SIZE) {
+        if (nSlabsInUse == slabs.size()) {
+            char *slab = static_cast<char *>(malloc(SLAB_SIZE));
+            if (slab == nullptr)
+                return nullptr;
+            slabs.push_back(slab);
+        }
+        nSlabsInUse++;
+        nSlabOffset = 0;
+    }
+    void *block = slabs[nSlabsInUse - 1] + nSlabOffset;
+    nSlabOffset += blockSize;
+    return block;
+}
+
+void CLuaStateArena::Free(void *ptr, size_t size) {
+    if (ptr == nullptr)
+        return;
+    if (size > MAX_SMALL_SIZE) {
+        free(ptr);
+        return;
+    }
+    FreeBlock *block    = static_cast<FreeBlock *>(ptr);
+    size_t cls          = SizeClass(size);
+    block->next         = freeLists[cls];
+    freeLists[cls]      = block;
+}
+
+void *CLuaStateArena::Realloc(void *ptr, size_t osize, size_t nsize) {
+    if (ptr == nullptr)
+        osize = 0;  // osize tells the object type of a new block
+    if (nsize == 0) {
+        Free(ptr, osize);
+        return nullptr;
+    }
+
+    bool fSmall = nsize <= MAX_SMALL_SIZE;
+    if (ptr != nullptr) {
+        if (osize > MAX_SMALL_SIZE && !fSmall) {
+            void *newPtr = realloc(ptr, nsize);
+            // lua requires that shrinking a block never fails
+            return (newPtr == nullptr && nsize <= osize) ? ptr : newPtr;
+        }
+        if (osize <= MAX_SMALL_SIZE && fSmall && SizeClass(osize) == SizeClass(nsize))
+            return ptr;
+    }
+
+    void *newPtr = fSmall ? AllocSmall(nsize) : malloc(nsize);
+    if (newPtr == nullptr) {
+        if (ptr == nullptr || nsize > osize)
+            return nullptr;
+
+        // shrinking must not fail, keep the block. It's big enough for the class of nsize,
+        // a heap block is recycled through the free lists from now on and freed by Reset
+        if (osize > MAX_SMALL_SIZE)
+            keptHeapBlocks.push_back(ptr);
+        return ptr;
+    }
+    if (ptr != nullptr) {
+        memcpy(newPtr, ptr, std::min(osize, nsize));
+        Free(ptr, osize);
+    }
+    return newPtr;
+}
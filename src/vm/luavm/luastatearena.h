@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef LUA_STATE_ARENA_H
+#define LUA_STATE_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Per-thread memory for contract states. Opening the libs and running a contract
+ * allocates and frees lots of small objects; they are served from size-class free
+ * lists in slabs which are kept for the next contract run by the same thread.
+ * Memory fuel only depends on the requested sizes, so it is not affected.
+ */
+class CLuaStateArena {
+public:
+    static const size_t SLAB_SIZE          = 64 * 1024;
+    static const size_t SIZE_CLASS         = 16;
+    static const size_t MAX_SMALL_SIZE     = 512;
+    static const size_t MAX_RETAINED_SLABS = 64;  // 4 MiB per thread
+
+    bool fInUse;
+
+    CLuaStateArena();
+    ~CLuaStateArena();
+
+    /** the lua_Alloc of the states on the arena, ud is the arena */
+    static void *Alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+    /** rewind once every block of the closed state has been freed */
+    void Reset();
+
+    size_t GetSlabCount() const { return slabs.size(); }
+    size_t GetSlabsInUse() const { return nSlabsInUse; }
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    std::vector<char *> slabs;
+    size_t nSlabsInUse;
+    size_t nSlabOffset;
+    FreeBlock *freeLists[MAX_SMALL_SIZE / SIZE_CLASS];
+    // heap blocks kept for a small size when shrinking them failed, freed by Reset
+    std::vector<void *> keptHeapBlocks;
+
+    static size_t SizeClass(size_t size) { return (size - 1) / SIZE_CLASS; }
+
+    void *AllocSmall(size_t size);
+    void Free(void *ptr, size_t size);
+    void *Realloc(void *ptr, size_t osize, size_t nsize);
+};
+
+#endif  // LUA_STATE_ARENA_H
@@ -4,6 +4,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "luavm.h"
+#include "luabytecode.h"
+#include "luastatearena.h"
 #include "lua/lua.hpp"
 
 #include <assert.h>
@@ -194,6 +196,41 @@ tuple<bool, string> CLuaVM::CheckScriptSyntax(const char *filePath) {
     return std::make_tuple(true, string("OK"));
 }
 
+static thread_local CLuaStateArena luaStateArena;
+
+static int LuaPanic(lua_State *L) {
+    const char *errStr = lua_tostring(L, -1);
+    LogPrint(BCLog::LUAVM, "PANIC: unprotected error in call to Lua API (%s)\n", errStr ? errStr : "unknown");
+    return 0;  // return to Lua to abort
+}
+
+static void CloseLuaState(lua_State *L) {
+    void *ud = nullptr;
+    bool fArena = lua_getallocf(L, &ud) == &CLuaStateArena::Alloc;
+    lua_close(L);
+    if (fArena) {
+        static_cast<CLuaStateArena *>(ud)->Reset();
+        static_cast<CLuaStateArena *>(ud)->fInUse = false;
+    }
+}
+
+typedef std::unique_ptr<lua_State, decltype(&CloseLuaState)> CLuaStatePtr;
+
+/** Create a state on the thread's arena, a nested state falls back to the heap. */
+static CLuaStatePtr NewLuaState() {
+    if (luaStateArena.fInUse)
+        return CLuaStatePtr(luaL_newstate(), &CloseLuaState);
+
+    lua_State *L = lua_newstate(&CLuaStateArena::Alloc, &luaStateArena);
+    if (L == nullptr) {
+        luaStateArena.Reset();
+        return CLuaStatePtr(nullptr, &CloseLuaState);
+    }
+    luaStateArena.fInUse = true;
+    lua_atpanic(L, &LuaPanic);
+    return CLuaStatePtr(L, &CloseLuaState);
+}
+
 static void ReportBurnState(lua_State *L, CLuaVMRunEnv *pVmRunEnv) {
 
     lua_burner_state *burnerState = lua_GetBurnerState(L);
@@ -245,7 +282,7 @@ tuple<uint64_t, string> CLuaVM::Run(uint64_t fuelLimit, CLuaVMRunEnv *pVmRunEnv)
     }
 
     // 1.创建Lua运行环境
-    std::unique_ptr<lua_State, decltype(&lua_close)> lua_state_ptr(luaL_newstate(), &lua_close);
+    CLuaStatePtr lua_state_ptr = NewLuaState();
     if (!lua_state_ptr) {
         LogPrint(BCLog::LUAVM, "CLuaVM::Run luaL_newstate() failed\n");
         return std::make_tuple(-1, string("CLuaVM::Run luaL_newstate() failed\n"));
@@ -287,7 +324,7 @@ tuple<uint64_t, string> CLuaVM::Run(uint64_t fuelLimit, CLuaVMRunEnv *pVmRunEnv)
 
     // 5. Load the contract script
     std::string strError;
-    int luaStatus = luaL_loadbuffer(lua_state, code.c_str(), code.size(), "line");
+    int luaStatus = LoadLuaContract(lua_state, code, pVmRunEnv->GetBurnVersion(), GetLuaBytecodeCache());
     if (luaStatus == LUA_OK) {
         luaStatus = lua_pcallk(lua_state, 0, 0, 0, 0, NULL, BURN_VER_STEP_V1);
         if (luaStatus != LUA_OK) {
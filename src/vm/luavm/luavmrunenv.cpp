@@ -410,6 +410,9 @@ int32_t CLuaVMRunEnv::GetConfirmHeight() { return p_context->height; }
 
 int32_t CLuaVMRunEnv::GetBurnVersion() {
     // the burn version belong to the Feature Fork Version
+    if (p_context->height >= (int32_t)SysCfg().GetLuaBytecodeForkHeight())
+        return BURN_VER_R4;
+
     return GetFeatureForkVersion(p_context->height);
 }
 
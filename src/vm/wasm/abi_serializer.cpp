@@ -13,6 +13,10 @@
 #include <boost/lexical_cast.hpp>
 
 #include "commons/json/json_spirit_writer.h"
+#include "commons/lrucache.h"
+#include "crypto/hash.h"
+
+#include <mutex>
 
 using namespace boost;
 using namespace wasm;
@@ -71,6 +75,29 @@ namespace wasm {
         set_abi(abi, max_serialization_time);
     }
 
+    // parsed abis keyed by the hash of their bytes, a contract update changes the key
+    static lrucache<uint256, std::shared_ptr<const abi_serializer>> abi_serializer_cache(max_abi_cache_bytes);
+    static std::mutex                                                abi_serializer_cache_mutex;
+
+    std::shared_ptr<const abi_serializer>
+    abi_serializer::get_serializer( const std::vector<char> &abi, microseconds max_serialization_time ) {
+
+        uint256 abi_hash = Hash(abi.begin(), abi.end());
+        {
+            std::lock_guard<std::mutex> lock(abi_serializer_cache_mutex);
+            auto p = abi_serializer_cache.find(abi_hash);
+            if (p != nullptr)
+                return *p;
+        }
+
+        wasm::abi_def def  = wasm::unpack<wasm::abi_def>(abi);
+        auto          abis = std::make_shared<const abi_serializer>(def, max_serialization_time);
+
+        std::lock_guard<std::mutex> lock(abi_serializer_cache_mutex);
+        abi_serializer_cache.insert(abi_hash, abis, abi.size());
+        return abis;
+    }
+
     void abi_serializer::add_specialized_unpack_pack( const string &name,
                                                       std::pair <abi_serializer::unpack_function, abi_serializer::pack_function> unpack_pack ) {
         built_in_types[name] = std::move(unpack_pack);
@@ -544,7 +571,7 @@ namespace wasm {
         }
 
         // //check struct in recursion
-        auto r = make_shared<dag>(
+        auto r = std::make_shared<dag>(
                 wasm::dag{"root", nullptr, vector < shared_ptr < dag >> {}, vector < shared_ptr < dag >> {}});
         r->root = r;
         for (const auto &s : structs) {
@@ -69,24 +69,27 @@ namespace wasm {
         json_spirit::Value get_field_variant( const type_name &s, const json_spirit::Value &v, field_name field, bool is_optional ) const;
         json_spirit::Value get_field_variant( const type_name &s, const json_spirit::Value &v, uint32_t index ) const;
 
+        // parsed and validated serializer of raw abi bytes, shared through a cache keyed by the abi hash
+        static std::shared_ptr<const abi_serializer>
+        get_serializer( const std::vector<char> &abi, microseconds max_serialization_time );
+
         static std::vector<char>
         pack( const std::vector<char> &abi, const string &action, const string &params, microseconds max_serialization_time ) {
 
             vector<char> data;
             try {
 
-                wasm::abi_def def = wasm::unpack<wasm::abi_def>(abi);
-                wasm::abi_serializer abis(def, max_serialization_time);
+                auto abis = get_serializer(abi, max_serialization_time);
 
                 json_spirit::Value data_v;
                 json_spirit::read_string(params, data_v);
 
-                string action_type = abis.get_action_type(action);
+                string action_type = abis->get_action_type(action);
                 if(action_type == string()){
                     action_type = action;
                 }
-                //data = abis.variant_to_binary(action, data_v, max_serialization_time);
-                data = abis.variant_to_binary(action_type, data_v, max_serialization_time);
+                //data = abis->variant_to_binary(action, data_v, max_serialization_time);
+                data = abis->variant_to_binary(action_type, data_v, max_serialization_time);
 
             }
             WASM_CAPTURE_AND_RETHROW("abi_serializer pack error in params %s", params)
@@ -100,15 +103,14 @@ namespace wasm {
 
             json_spirit::Value data_v;
             try {
-                wasm::abi_def def = wasm::unpack<wasm::abi_def>(abi);
-                wasm::abi_serializer abis(def, max_serialization_time);
+                auto abis = get_serializer(abi, max_serialization_time);
 
-                string action_type = abis.get_action_type(action);
+                string action_type = abis->get_action_type(action);
                 if(action_type == string()){
                     action_type = action;
                 }
-                //data_v = abis.binary_to_variant(action, data, max_serialization_time);
-                data_v = abis.binary_to_variant(action_type, data, max_serialization_time);
+                //data_v = abis->binary_to_variant(action, data, max_serialization_time);
+                data_v = abis->binary_to_variant(action_type, data, max_serialization_time);
 
             }
             WASM_CAPTURE_AND_RETHROW("abi_serializer unpack error in params %s", action)
@@ -123,15 +125,14 @@ namespace wasm {
             type_name name;
             try {
 
-                wasm::abi_def def = wasm::unpack<wasm::abi_def>(abi);
-                wasm::abi_serializer abis(def, max_serialization_time);
+                auto abis = get_serializer(abi, max_serialization_time);
 
                 string t = wasm::name(table).to_string();
-                name = abis.get_table_type(t);
+                name = abis->get_table_type(t);
 
                 WASM_ASSERT(name.size() > 0, abi_parse_exception, "can not get table %s's type from abi", t.data());
 
-                data_v = abis.binary_to_variant(name, data, max_serialization_time);
+                data_v = abis->binary_to_variant(name, data, max_serialization_time);
             }
             WASM_CAPTURE_AND_RETHROW("abi_serializer unpack error in table %s", name)
 
@@ -21,6 +21,10 @@ namespace wasm {
     const static uint16_t max_wasm_api_data_bytes      = 4096;
     const static uint16_t max_inline_transactions_size = 1024;
     const static uint16_t max_signatures_size          = 16;
+    const static uint16_t max_db_iterators_size        = 64;
+    const static uint64_t default_module_cache_size    = 64;//in megabytes
+    const static uint64_t max_compile_queue_size       = 64;//modules waiting to be compiled in the background
+    const static uint64_t max_abi_cache_bytes          = 16*1024*1024;//raw abi bytes of the parsed abis kept in memory
 
     const static uint64_t wasmio       = N(wasmio);
     const static uint64_t wasmio_bank  = N(wasmio.bank);
@@ -99,6 +99,41 @@ namespace wasm {
         inline_transactions.push_back(t);
     }
 
+    // nested inline transactions hold one allocator per depth
+    static const size_t max_pooled_wasm_allocators = max_inline_transaction_depth + 1;
+
+    struct wasm_allocator_pool {
+        std::vector<vm::wasm_allocator*> allocators;
+
+        ~wasm_allocator_pool() {
+            for (auto alloc : allocators) {
+                alloc->free();
+                delete alloc;
+            }
+        }
+    };
+
+    static thread_local wasm_allocator_pool wasm_allocators;
+
+    vm::wasm_allocator* acquire_wasm_allocator() {
+        if (wasm_allocators.allocators.empty())
+            return new vm::wasm_allocator();
+
+        auto alloc = wasm_allocators.allocators.back();
+        wasm_allocators.allocators.pop_back();
+        return alloc;
+    }
+
+    void release_wasm_allocator(vm::wasm_allocator* alloc) {
+        if (wasm_allocators.allocators.size() < max_pooled_wasm_allocators) {
+            wasm_allocators.allocators.push_back(alloc);
+            return;
+        }
+
+        alloc->free();
+        delete alloc;
+    }
+
     std::vector <uint8_t> wasm_context::get_code(uint64_t account) {
 
         vector <uint8_t> code;
@@ -111,6 +146,13 @@ namespace wasm {
         return code;
     }
 
+    bool wasm_context::get_code_hash(uint64_t account, uint256 &code_hash) {
+
+        CAccount contract_account;
+        return database.accountCache.GetAccount(CNickID(account), contract_account)
+            && database.contractCache.GetContractCodeHash(contract_account.regid, code_hash);
+    }
+
     // std::string wasm_context::get_abi(uint64_t account) {
     //     CUniversalContract contract;
     //     CAccount contract_account ;
@@ -166,15 +208,16 @@ namespace wasm {
         trace.receiver = _receiver;
 
         auto native    = find_native_handle(_receiver, trx.action);
+        _db_iterators.clear();
 
         try {
             if (native) {
                 (*native)(*this);
             } else {
 
-                vector <uint8_t> code = get_code(_receiver);
-                if (code.size() > 0) {
-                    wasmif.execute(code, this);
+                uint256 code_hash;
+                if (get_code_hash(_receiver, code_hash)) {
+                    wasmif.execute(code_hash, [&]() { return get_code(_receiver); }, this);
                 }
             }
         } catch (wasm::exception &e) {
@@ -279,6 +322,68 @@ namespace wasm {
         return active_producers;
     }
 
+    int32_t wasm_context::find_data(uint64_t contract, string k, bool upper) {
+
+        CAccount contract_account;
+        wasm::name contract_name = wasm::name(contract);
+        WASM_ASSERT(database.accountCache.GetAccount(CNickID(contract_name.to_string()), contract_account),
+                    account_operation_exception,
+                    "wasm_context.find_data, contract account does not exist, contract = %s",
+                    contract_name.to_string().c_str())
+
+        // reuse the handles of closed iterators
+        auto it = std::find(_db_iterators.begin(), _db_iterators.end(), nullptr);
+        WASM_ASSERT(it != _db_iterators.end() || _db_iterators.size() < max_db_iterators_size,
+                    wasm_assert_exception,
+                    "wasm_context.find_data, too many open iterators, max = %d", max_db_iterators_size)
+
+        // iterate the data of the contract only, all its keys start with the packed contract name
+        std::vector<char> prefix = wasm::pack(contract);
+        auto pIterator = database.contractCache.CreateContractDataIterator(contract_account.regid,
+                                                                           string(prefix.data(), prefix.size()));
+        WASM_ASSERT(pIterator, wasm_assert_exception, "wasm_context.find_data, can not create iterator")
+
+        bool found = upper ? pIterator->SeekUpper(&k) : pIterator->SeekLower(&k);
+        if (!found || !pIterator->IsValid())
+            return -1;
+
+        if (it == _db_iterators.end())
+            it = _db_iterators.insert(_db_iterators.end(), pIterator);
+        else
+            *it = pIterator;
+        return it - _db_iterators.begin();
+    }
+
+    int32_t wasm_context::next_data(int32_t iterator) {
+
+        WASM_ASSERT(iterator >= 0 && iterator < (int32_t)_db_iterators.size() && _db_iterators[iterator],
+                    wasm_assert_exception, "wasm_context.next_data, invalid iterator %d", iterator)
+
+        auto &pIterator = _db_iterators[iterator];
+        if (!pIterator->Next() || !pIterator->IsValid()) {
+            pIterator = nullptr;
+            return -1;
+        }
+        return iterator;
+    }
+
+    bool wasm_context::get_iterator(int32_t iterator, string &k, string &v) {
+
+        WASM_ASSERT(iterator >= 0 && iterator < (int32_t)_db_iterators.size() && _db_iterators[iterator],
+                    wasm_assert_exception, "wasm_context.get_iterator, invalid iterator %d", iterator)
+
+        auto &pIterator = _db_iterators[iterator];
+        k = pIterator->GetContractKey();
+        v = pIterator->GetValue();
+        return true;
+    }
+
+    void wasm_context::close_iterator(int32_t iterator) {
+
+        if (iterator >= 0 && iterator < (int32_t)_db_iterators.size())
+            _db_iterators[iterator] = nullptr;
+    }
+
     void wasm_context::update_storage_usage(uint64_t account, int64_t size_in_bytes){
 
         int64_t disk_usage  = size_in_bytes * store_fuel_fee_per_byte;
@@ -23,17 +23,24 @@ namespace wasm {
     typedef CNickID nick_name;
     class wasm_context;
 
+    // Linear memories are reserved once per thread and reused by later contexts: reserving one
+    // maps (and freeing it unmaps) several GB of guard-paged address space, which costs more than
+    // most contract calls. The backend zeroes the pages a module used when it is initialized.
+    vm::wasm_allocator* acquire_wasm_allocator();
+    void                release_wasm_allocator(vm::wasm_allocator* alloc);
+
     class wasm_context : public wasm_context_interface {
 
     public:
         wasm_context(CWasmContractTx &ctrl, inline_transaction &t, CCacheWrapper &cw,
                      vector <CReceipt> &receipts_in, bool mining, uint32_t depth = 0)
-                : trx(t), control_trx(ctrl), database(cw), receipts(receipts_in), recurse_depth(depth) {
+                : trx(t), control_trx(ctrl), database(cw), receipts(receipts_in), recurse_depth(depth),
+                  wasm_alloc(acquire_wasm_allocator()) {
             reset_console();
         };
 
         ~wasm_context() {
-            wasm_alloc.free();
+            release_wasm_allocator(wasm_alloc);
         };
 
     public:
@@ -42,6 +49,7 @@ namespace wasm {
         void                  execute_one(inline_transaction_trace &trace);
         bool                  has_permission_from_inline_transaction(const permission &p);
         std::vector <uint8_t> get_code(uint64_t account);
+        bool                  get_code_hash(uint64_t account, uint256 &code_hash);
 // Console methods:
     public:
         void                      reset_console();
@@ -101,6 +109,11 @@ namespace wasm {
             return database.contractCache.EraseContractData(contract_account.regid, k);
         }
 
+        int32_t find_data     (uint64_t contract, string k, bool upper);
+        int32_t next_data     (int32_t iterator);
+        bool    get_iterator  (int32_t iterator, string &k, string &v);
+        void    close_iterator(int32_t iterator);
+
         bool contracts_console() {
             return SysCfg().GetBoolArg("-contracts_console", false) && control_trx.transaction_status == wasm::transaction_status_type::validating;
         }
@@ -109,8 +122,8 @@ namespace wasm {
             _pending_console_output << val;
         }
 
-        vm::wasm_allocator*       get_wasm_allocator() { return &wasm_alloc; }
-        bool                      is_memory_in_wasm_allocator( const char* p ) { return wasm_alloc.is_in_range(p); }
+        vm::wasm_allocator*       get_wasm_allocator() { return wasm_alloc; }
+        bool                      is_memory_in_wasm_allocator( const char* p ) { return wasm_alloc->is_in_range(p); }
 
         std::chrono::milliseconds get_max_transaction_duration() { return control_trx.get_max_transaction_duration(); }
         void                      update_storage_usage(uint64_t account, int64_t size_in_bytes);
@@ -127,10 +140,12 @@ namespace wasm {
         vector<inline_transaction> inline_transactions;
 
         wasm::wasm_interface       wasmif;
-        vm::wasm_allocator         wasm_alloc;
+        vm::wasm_allocator*        wasm_alloc;  // borrowed from the per-thread pool
         uint64_t                   _receiver;
 
     private:
         std::ostringstream         _pending_console_output;
+        // open contract data iterators of the current action, indexed by handle
+        vector<shared_ptr<CDBContractDataIterator>> _db_iterators;
     };
 }
@@ -34,6 +34,11 @@ namespace wasm {
         virtual bool set_data  ( uint64_t contract, string k, string v ) { return 0; }
         virtual bool get_data  ( uint64_t contract, string k, string &v ) { return 0; }
         virtual bool erase_data( uint64_t contract, string k ) { return 0; }
+        // ordered access to contract data, iterators are handles valid until the end of the action
+        virtual int32_t find_data    ( uint64_t contract, string k, bool upper ) { return -1; }
+        virtual int32_t next_data    ( int32_t iterator ) { return -1; }
+        virtual bool    get_iterator ( int32_t iterator, string &k, string &v ) { return false; }
+        virtual void    close_iterator( int32_t iterator ) {}
 
         virtual bool is_account       ( uint64_t account ) { return true; }
         virtual void require_auth     ( uint64_t account ) {}
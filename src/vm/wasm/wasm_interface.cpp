@@ -14,6 +14,12 @@
 #include "wasm/wasm_variant.hpp"
 
 #include "crypto/hash.h"
+#include "commons/lrucache.h"
+#include "config/chainparams.h"
+
+#include <deque>
+#include <mutex>
+#include <boost/thread.hpp>
 
 using namespace eosio;
 using namespace eosio::vm;
@@ -22,9 +28,19 @@ namespace wasm {
     using code_version       = uint256;
     using backend_validate_t = backend<wasm::wasm_context_interface, vm::interpreter>;
     using rhf_t              = eosio::vm::registered_host_functions<wasm_context_interface>;
-    std::map <code_version, std::shared_ptr<wasm_instantiated_module_interface>> wasm_instantiation_cache;
     std::shared_ptr <wasm_runtime_interface>                                     runtime_interface;
 
+    // instantiated modules keyed by the hash of their code, bounded by the memory the modules hold
+    lrucache <code_version, std::shared_ptr<wasm_instantiated_module_interface>> wasm_instantiation_cache(
+            default_module_cache_size << 20);
+    std::mutex                                                                  wasm_instantiation_cache_mutex;
+    std::once_flag                                                              wasm_runtime_inited;
+
+    // modules waiting to be compiled ahead of their first invocation
+    std::deque <std::pair<code_version, vector <uint8_t>>>                      wasm_compile_queue;
+    boost::mutex                                                                wasm_compile_queue_mutex;
+    boost::condition_variable                                                   wasm_compile_queue_cond;
+
     wasm_interface::wasm_interface() {}
     wasm_interface::~wasm_interface() {}
 
@@ -32,26 +48,44 @@ namespace wasm {
         runtime_interface->immediately_exit_currently_running_module();
     }
 
-    std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const vector <uint8_t> &code) {
+    std::shared_ptr <wasm_instantiated_module_interface> find_instantiated_backend(const code_version &code_id) {
+        std::lock_guard<std::mutex> lock(wasm_instantiation_cache_mutex);
+        auto p = wasm_instantiation_cache.find(code_id);
+        return p != nullptr ? *p : nullptr;
+    }
 
-        try {
-            auto code_id = Hash(code.begin(), code.end());
-            auto it = wasm_instantiation_cache.find(code_id);
-            if (it == wasm_instantiation_cache.end()) {
-                wasm_instantiation_cache[code_id] = runtime_interface->instantiate_module((const char*)code.data(), code.size());
-                return wasm_instantiation_cache[code_id];
-            }
-            return it->second;
-        } catch (...) {
-            throw;
-        }
+    std::shared_ptr <wasm_instantiated_module_interface> instantiate_backend(const code_version &code_id,
+                                                                             const vector <uint8_t> &code) {
+        auto module = runtime_interface->instantiate_module((const char*)code.data(), code.size());
+        std::lock_guard<std::mutex> lock(wasm_instantiation_cache_mutex);
+        wasm_instantiation_cache.insert(code_id, module, module->memory_size() + code.size());
+        return module;
+    }
 
+    std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const code_version &code_id,
+                                                                                  const std::function<vector <uint8_t>()> &get_code) {
+        auto module = find_instantiated_backend(code_id);
+        if (module)
+            return module;
+
+        vector <uint8_t> code = get_code();
+        if (code.size() == 0)
+            return nullptr;
+
+        return instantiate_backend(code_id, code);
     }
 
     void wasm_interface::execute(const vector <uint8_t> &code, wasm_context_interface *pWasmContext) {
+        execute(Hash(code.begin(), code.end()), [&]() { return code; }, pWasmContext);
+    }
+
+    void wasm_interface::execute(const uint256 &code_hash, const std::function<vector <uint8_t>()> &get_code,
+                                 wasm_context_interface *pWasmContext) {
         pWasmContext->pause_billing_timer();
-        std::shared_ptr <wasm_instantiated_module_interface> pInstantiated_module = get_instantiated_backend(code);
+        std::shared_ptr <wasm_instantiated_module_interface> pInstantiated_module = get_instantiated_backend(code_hash, get_code);
         pWasmContext->resume_billing_timer();
+        if (!pInstantiated_module)
+            return;
 
         //system_clock::time_point start = system_clock::now();
         pInstantiated_module->apply(pWasmContext);
@@ -78,12 +112,65 @@ namespace wasm {
 
     void wasm_interface::initialize(vm_type vm) {
 
-        if (vm == wasm::vm_type::eos_vm)
-            runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
-        else if (vm == wasm::vm_type::eos_vm_jit)
-            runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::jit>>();
-        else
-            runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
+        std::call_once(wasm_runtime_inited, [vm]() {
+            int64_t module_cache_size = SysCfg().GetArg("-wasmmodulecachesize", default_module_cache_size);
+            {
+                std::lock_guard<std::mutex> lock(wasm_instantiation_cache_mutex);
+                wasm_instantiation_cache.max_cost(std::max<int64_t>(module_cache_size, 1) << 20);
+            }
+
+            if (vm == wasm::vm_type::eos_vm)
+                runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
+            else if (vm == wasm::vm_type::eos_vm_jit)
+                runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::jit>>();
+            else
+                runtime_interface = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
+        });
+
+    }
+
+    bool wasm_interface::compile_async(const uint256 &code_hash, const vector <uint8_t> &code) {
+
+        if (code.size() == 0 || find_instantiated_backend(code_hash))
+            return true;
+
+        // code already queued is not queued twice
+        boost::unique_lock<boost::mutex> lock(wasm_compile_queue_mutex);
+        for (auto &item : wasm_compile_queue) {
+            if (item.first == code_hash)
+                return true;
+        }
+        if (wasm_compile_queue.size() >= max_compile_queue_size)
+            return false;
+
+        wasm_compile_queue.emplace_back(code_hash, code);
+        wasm_compile_queue_cond.notify_one();
+        return true;
+
+    }
+
+    void wasm_interface::compile_pending() {
+
+        std::pair<code_version, vector <uint8_t>> item;
+        {
+            boost::unique_lock<boost::mutex> lock(wasm_compile_queue_mutex);
+            while (wasm_compile_queue.empty())
+                wasm_compile_queue_cond.wait(lock); // interruption point
+            item = std::move(wasm_compile_queue.front());
+            wasm_compile_queue.pop_front();
+        }
+
+        if (find_instantiated_backend(item.first))
+            return;
+
+        try {
+            instantiate_backend(item.first, item.second);
+        } catch (wasm::exception &e) {
+            // invalid code fails again, and is reported, when the contract is invoked
+            LogPrint(BCLog::WASM, "compile module %s failed: %s\n", item.first.GetHex(), e.detail());
+        } catch (std::exception &e) {
+            LogPrint(BCLog::WASM, "compile module %s failed: %s\n", item.first.GetHex(), e.what());
+        }
 
     }
 
@@ -284,6 +371,61 @@ namespace wasm {
             return 1;
         }
 
+        int32_t db_lowerbound( const void *key, uint32_t key_len ) {
+            return db_find(key, key_len, false);
+        }
+
+        int32_t db_upperbound( const void *key, uint32_t key_len ) {
+            return db_find(key, key_len, true);
+        }
+
+        // returns -1 and releases the iterator once it passes the last key of the contract
+        int32_t db_next( int32_t iterator ) {
+            return pWasmContext->next_data(iterator);
+        }
+
+        int32_t db_iterator_key( int32_t iterator, void *key, uint32_t key_len ) {
+            string k, v;
+            pWasmContext->get_iterator(iterator, k, v);
+            return copy_to_wasm(k.substr(sizeof(uint64_t)), key, key_len); // strip the contract prefix
+        }
+
+        int32_t db_iterator_value( int32_t iterator, void *val, uint32_t val_len ) {
+            string k, v;
+            pWasmContext->get_iterator(iterator, k, v);
+            return copy_to_wasm(v, val, val_len);
+        }
+
+        void db_iterator_close( int32_t iterator ) {
+            pWasmContext->close_iterator(iterator);
+        }
+
+        int32_t db_find( const void *key, uint32_t key_len, bool upper ) {
+            WASM_ASSERT(pWasmContext->is_memory_in_wasm_allocator(reinterpret_cast<const char*>(key) + key_len), 
+                        wasm_memory_exception, "access violation")
+            WASM_ASSERT(key_len < max_wasm_api_data_bytes, 
+                        api_data_size_too_big_exception,
+                        "key size must be < %ld, but get %ld",
+                        max_wasm_api_data_bytes, key_len)
+
+            string k        = string((const char *) key, key_len);
+            auto   contract = pWasmContext->receiver();
+            AddPrefix(contract, k);
+
+            return pWasmContext->find_data(contract, k, upper);
+        }
+
+        // same contract as db_get: returns the full size, copies as much as fits
+        int32_t copy_to_wasm( const string &data, void *dest, uint32_t dest_len ) {
+            if (dest_len == 0) return data.size();
+
+            WASM_ASSERT(pWasmContext->is_memory_in_wasm_allocator(reinterpret_cast<const char*>(dest) + dest_len), 
+                        wasm_memory_exception, "access violation")
+
+            auto size = dest_len > data.size() ? data.size() : dest_len;
+            std::memcpy(dest, data.data(), size);
+            return size;
+        }
 
         //memory
         void *memcpy( void *dest, const void *src, int len ) {
@@ -832,6 +974,12 @@ namespace wasm {
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_remove, db_remove)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_get,    db_get)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_update, db_update)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_lowerbound,     db_lowerbound)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_upperbound,     db_upperbound)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_next,           db_next)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_iterator_key,   db_iterator_key)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_iterator_value, db_iterator_value)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_iterator_close, db_iterator_close)
 
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, memcpy,  memcpy)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, memmove, memmove)
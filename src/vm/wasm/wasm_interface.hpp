@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <map>
+#include <functional>
+#include "commons/uint256.h"
 #include "wasm/wasm_context_interface.hpp"
 #include "wasm/wasm_runtime.hpp"
 
@@ -22,7 +24,15 @@ namespace wasm {
     public:
         void initialize(vm_type vm);
         void execute(const vector <uint8_t>& code, wasm_context_interface *pWasmContext);
+        // get_code is only called when the module of code_hash is not instantiated yet
+        void execute(const uint256& code_hash, const std::function<vector <uint8_t>()>& get_code,
+                     wasm_context_interface *pWasmContext);
         void validate(const vector <uint8_t>& code);
+        // queue code to be compiled in the background, so its first invocation does not pay for it.
+        // Returns false if the queue is full, the code is compiled on its first invocation then
+        bool compile_async(const uint256& code_hash, const vector <uint8_t>& code);
+        // compile one queued module, blocks until there is one
+        void compile_pending();
         void exit();
 
     };
@@ -11,6 +11,7 @@
 #include "wasm/wasm_native_contract_abi.hpp"
 #include "wasm/abi_def.hpp"
 #include "wasm/abi_serializer.hpp"
+#include "crypto/hash.h"
 
 using namespace std;
 using namespace wasm;
@@ -56,6 +57,9 @@ namespace wasm {
         WASM_ASSERT(database_contract.SaveContract(contract.regid, contract_store), 
                     account_operation_exception,
                     "wasmio_native_setcode.setcode, Save account error")
+
+        // compile ahead of the first invocation, outside of any transaction's billing window
+        context.wasmif.compile_async(Hash(code.begin(), code.end()), vector<uint8_t>(code.begin(), code.end()));
     }
     
     void wasmio_bank_native_transfer(wasm_context &context) {
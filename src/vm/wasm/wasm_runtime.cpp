@@ -24,7 +24,8 @@ namespace wasm {
 
         wasm_vm_instantiated_module(wasm_vm_runtime <Impl> *runtime, std::shared_ptr <backend_t> mod) :
                 _runtime(runtime),
-                _instantiated_module(std::move(mod)) {}
+                _instantiated_module(std::move(mod)),
+                _memory_size(module_memory_size(_instantiated_module->get_module().allocator)) {}
 
         void apply(wasm::wasm_context_interface *pContext) override {
 
@@ -64,9 +65,20 @@ namespace wasm {
             _runtime->_bkend = nullptr;
         }
 
+        size_t memory_size() const override {
+            return _memory_size;
+        }
+
     private:
+        // bytes the parsed module holds in its allocator, plus the native code the jit copied out of it.
+        // _capacity is the address space reserved for the allocator, not memory in use
+        static size_t module_memory_size(const growable_allocator &allocator) {
+            return allocator._offset + (allocator.is_jit ? allocator._code_size : 0);
+        }
+
         wasm_vm_runtime <Impl> *    _runtime;
         std::shared_ptr <backend_t> _instantiated_module;
+        size_t                      _memory_size;
     };
 
     template<typename Impl>
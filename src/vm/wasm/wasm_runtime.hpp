@@ -8,6 +8,7 @@ namespace wasm {
     class wasm_instantiated_module_interface {
        public:
           virtual void apply(wasm_context_interface* context) = 0;
+          virtual size_t memory_size() const = 0;   //bytes held by the parsed (and compiled) module
           virtual ~wasm_instantiated_module_interface();
     };
 